@@ -0,0 +1,325 @@
+// Renders synthetic scenes through the 3D and 2D renderers without a display
+// and reports where the time went. Run it from a directory that contains the
+// game's shaders/ folder, e.g.:
+//
+//     LIBGL_ALWAYS_SOFTWARE=1 gfx_benchmark --frames 500 --scene all
+#include <libtrx/game/shell.h>
+#include <libtrx/gfx/context.h>
+#include <libtrx/gfx/gl/state.h>
+#include <libtrx/log.h>
+#include <libtrx/memory.h>
+#include <libtrx/utils.h>
+
+#include <SDL2/SDL_timer.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define M_TEXTURE_SIZE 256
+#define M_STRIP_LENGTH 32
+
+typedef enum {
+    M_SCENE_3D = 1 << 0,
+    M_SCENE_2D = 1 << 1,
+    M_SCENE_ALL = M_SCENE_3D | M_SCENE_2D,
+} M_SCENE;
+
+typedef struct {
+    int32_t frames;
+    int32_t width;
+    int32_t height;
+    int32_t strips;
+    M_SCENE scene;
+    bool cull;
+} M_OPTIONS;
+
+typedef struct {
+    double total_ms;
+    double min_ms;
+    double max_ms;
+} M_TIMINGS;
+
+static uint32_t m_Seed = 1;
+
+static uint32_t M_Random(void);
+static float M_RandomFloat(float min, float max);
+static bool M_ParseArgs(int argc, char **argv, M_OPTIONS *options);
+static int M_RegisterTexture(GFX_3D_RENDERER *renderer);
+static void M_Render3D(
+    GFX_3D_RENDERER *renderer, const M_OPTIONS *options, int texture_num);
+static void M_Render2D(
+    GFX_2D_RENDERER *renderer, GFX_2D_SURFACE *surface, int32_t frame);
+static void M_Report(
+    const M_OPTIONS *options, const M_TIMINGS *timings,
+    const GFX_3D_RENDERER *renderer_3d, const GFX_2D_RENDERER *renderer_2d);
+
+void Shell_ExitSystem(const char *const message)
+{
+    fprintf(stderr, "%s\n", message);
+    exit(EXIT_FAILURE);
+}
+
+void Shell_ExitSystemFmt(const char *const fmt, ...)
+{
+    va_list va;
+    va_start(va, fmt);
+    vfprintf(stderr, fmt, va);
+    va_end(va);
+    fprintf(stderr, "\n");
+    exit(EXIT_FAILURE);
+}
+
+static uint32_t M_Random(void)
+{
+    // a fixed LCG keeps the scenes identical between runs and machines
+    m_Seed = m_Seed * 1103515245 + 12345;
+    return (m_Seed >> 16) & 0x7FFF;
+}
+
+static float M_RandomFloat(const float min, const float max)
+{
+    return min + (max - min) * (M_Random() / (float)0x7FFF);
+}
+
+static bool M_ParseArgs(
+    const int argc, char **const argv, M_OPTIONS *const options)
+{
+    for (int i = 1; i < argc; i++) {
+        const char *const arg = argv[i];
+        if (!strcmp(arg, "--cull")) {
+            options->cull = true;
+            continue;
+        }
+
+        const char *const value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (value == NULL) {
+            return false;
+        }
+
+        if (!strcmp(arg, "--frames")) {
+            options->frames = atoi(value);
+        } else if (!strcmp(arg, "--size")) {
+            if (sscanf(value, "%dx%d", &options->width, &options->height)
+                != 2) {
+                return false;
+            }
+        } else if (!strcmp(arg, "--strips")) {
+            options->strips = atoi(value);
+        } else if (!strcmp(arg, "--scene")) {
+            if (!strcmp(value, "3d")) {
+                options->scene = M_SCENE_3D;
+            } else if (!strcmp(value, "2d")) {
+                options->scene = M_SCENE_2D;
+            } else if (!strcmp(value, "all")) {
+                options->scene = M_SCENE_ALL;
+            } else {
+                return false;
+            }
+        } else {
+            return false;
+        }
+        i++;
+    }
+
+    return options->frames > 0 && options->width > 0 && options->height > 0
+        && options->strips >= 0;
+}
+
+static int M_RegisterTexture(GFX_3D_RENDERER *const renderer)
+{
+    uint8_t *data = Memory_Alloc(M_TEXTURE_SIZE * M_TEXTURE_SIZE * 4);
+    for (int32_t y = 0; y < M_TEXTURE_SIZE; y++) {
+        for (int32_t x = 0; x < M_TEXTURE_SIZE; x++) {
+            uint8_t *const pixel = &data[(y * M_TEXTURE_SIZE + x) * 4];
+            const uint8_t shade = ((x / 16) ^ (y / 16)) & 1 ? 0xFF : 0x40;
+            pixel[0] = shade;
+            pixel[1] = shade;
+            pixel[2] = shade;
+            pixel[3] = 0xFF;
+        }
+    }
+    const int texture_num = GFX_3D_Renderer_RegisterTexturePage(
+        renderer, data, M_TEXTURE_SIZE, M_TEXTURE_SIZE);
+    Memory_FreePointer(&data);
+    return texture_num;
+}
+
+static void M_Render3D(
+    GFX_3D_RENDERER *const renderer, const M_OPTIONS *const options,
+    const int texture_num)
+{
+    GFX_3D_VERTEX vertices[M_STRIP_LENGTH];
+
+    GFX_3D_Renderer_RenderBegin(renderer);
+    GFX_3D_Renderer_SetCulling(
+        renderer, options->cull,
+        options->cull ? GFX_3D_CULL_FACE_CW : GFX_3D_CULL_FACE_NONE);
+    GFX_3D_Renderer_SetTexturingEnabled(renderer, true);
+    GFX_3D_Renderer_SelectTexture(renderer, texture_num);
+
+    for (int32_t i = 0; i < options->strips; i++) {
+        // switch state every now and then like a real room would
+        if (i % 64 == 0) {
+            GFX_3D_Renderer_SetBlendingMode(
+                renderer,
+                (i / 64) % 2 ? GFX_BLEND_MODE_NORMAL : GFX_BLEND_MODE_OFF);
+        }
+
+        // some strips land off screen so that culling has work to do
+        const float x = M_RandomFloat(-0.25f * options->width, options->width);
+        const float y =
+            M_RandomFloat(-0.25f * options->height, options->height);
+        const float z = M_RandomFloat(1.0f, 1000.0f);
+        for (int32_t j = 0; j < M_STRIP_LENGTH; j++) {
+            GFX_3D_VERTEX *const vertex = &vertices[j];
+            vertex->x = x + (j / 2) * 8.0f;
+            vertex->y = y + (j % 2) * 8.0f;
+            vertex->z = z;
+            vertex->s = (j / 2) / (float)M_STRIP_LENGTH;
+            vertex->t = j % 2;
+            vertex->w = 1.0f;
+            vertex->r = M_RandomFloat(0.5f, 1.0f);
+            vertex->g = M_RandomFloat(0.5f, 1.0f);
+            vertex->b = M_RandomFloat(0.5f, 1.0f);
+            vertex->a = 0.8f;
+        }
+        GFX_3D_Renderer_RenderPrimStrip(renderer, vertices, M_STRIP_LENGTH);
+    }
+
+    GFX_3D_Renderer_RenderEnd(renderer);
+}
+
+static void M_Render2D(
+    GFX_2D_RENDERER *const renderer, GFX_2D_SURFACE *const surface,
+    const int32_t frame)
+{
+    // a HUD sized box that moves every frame, the common case for overlays
+    const GFX_2D_RECT rect = {
+        .x = (frame * 7) % MAX(1, surface->desc.width - 256),
+        .y = (frame * 3) % MAX(1, surface->desc.height - 64),
+        .width = 256,
+        .height = 64,
+    };
+
+    GFX_2D_SURFACE_DESC desc;
+    if (GFX_2D_Surface_LockRect(surface, &rect, &desc)) {
+        const int32_t bpp = desc.bit_count / 8;
+        for (int32_t y = rect.y; y < MIN(rect.y + rect.height, desc.height);
+             y++) {
+            uint8_t *const row = (uint8_t *)desc.pixels + y * desc.pitch;
+            memset(
+                &row[rect.x * bpp], frame & 0xFF,
+                MIN(rect.width, desc.width - rect.x) * bpp);
+        }
+        GFX_2D_Surface_Unlock(surface);
+    }
+
+    GFX_2D_Renderer_UploadSurface(renderer, surface);
+    GFX_2D_Renderer_Render(renderer);
+}
+
+static void M_Report(
+    const M_OPTIONS *const options, const M_TIMINGS *const timings,
+    const GFX_3D_RENDERER *const renderer_3d,
+    const GFX_2D_RENDERER *const renderer_2d)
+{
+    const GFX_GL_STATE_STATS *const state_stats = GFX_GL_State_GetStats();
+    const uint64_t draw_calls = renderer_3d->vertex_stream.stats.draw_calls
+        + renderer_2d->stats.draw_calls;
+    const uint64_t uploaded_bytes =
+        renderer_3d->vertex_stream.stats.uploaded_bytes
+        + renderer_2d->stats.uploaded_bytes;
+
+    printf(
+        "frames:          %d (%dx%d)\n", options->frames, options->width,
+        options->height);
+    printf("cpu time:        %.2f ms total\n", timings->total_ms);
+    printf(
+        "frame time:      %.3f ms avg, %.3f ms min, %.3f ms max\n",
+        timings->total_ms / options->frames, timings->min_ms, timings->max_ms);
+    printf(
+        "draw calls:      %llu (%.1f per frame)\n",
+        (unsigned long long)draw_calls, draw_calls / (double)options->frames);
+    printf(
+        "vertices:        %llu\n",
+        (unsigned long long)renderer_3d->vertex_stream.stats.vertices);
+    printf(
+        "triangles:       %llu kept, %llu culled\n",
+        (unsigned long long)renderer_3d->vertex_stream.stats.triangles_kept,
+        (unsigned long long)renderer_3d->vertex_stream.stats.triangles_culled);
+    printf(
+        "bytes uploaded:  %llu (%.1f KiB per frame)\n",
+        (unsigned long long)uploaded_bytes,
+        uploaded_bytes / 1024.0 / options->frames);
+    printf(
+        "gl state calls:  %llu issued, %llu elided\n",
+        (unsigned long long)state_stats->issued,
+        (unsigned long long)state_stats->elided);
+}
+
+int main(int argc, char **argv)
+{
+    M_OPTIONS options = {
+        .frames = 300,
+        .width = 1280,
+        .height = 720,
+        .strips = 2000,
+        .scene = M_SCENE_ALL,
+    };
+    if (!M_ParseArgs(argc, argv, &options)) {
+        fprintf(
+            stderr,
+            "usage: %s [--frames N] [--size WxH] [--strips N] "
+            "[--scene 3d|2d|all] [--cull]\n",
+            argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Log_Init(NULL);
+    if (!GFX_Context_AttachHeadless(options.width, options.height)) {
+        return EXIT_FAILURE;
+    }
+    GFX_Context_SetVSync(false);
+    GFX_Context_SetDisplaySize(options.width, options.height);
+    GFX_Context_SetRenderingMode(GFX_RM_FRAMEBUFFER);
+
+    GFX_3D_RENDERER *const renderer_3d = GFX_Context_GetRenderer3D();
+    GFX_2D_RENDERER *const renderer_2d = GFX_Context_GetRenderer2D();
+    const int texture_num = M_RegisterTexture(renderer_3d);
+    const GFX_2D_SURFACE_DESC surface_desc = { 0 };
+    GFX_2D_SURFACE *const surface = GFX_2D_Surface_Create(&surface_desc);
+
+    // the first frame pays for shader and buffer setup
+    GFX_Context_SwapBuffers();
+    GFX_GL_State_ResetStats();
+
+    M_TIMINGS timings = { .min_ms = 1e9 };
+    const double freq = SDL_GetPerformanceFrequency();
+    for (int32_t frame = 0; frame < options.frames; frame++) {
+        const uint64_t start = SDL_GetPerformanceCounter();
+
+        GFX_Context_Clear();
+        if (options.scene & M_SCENE_3D) {
+            M_Render3D(renderer_3d, &options, texture_num);
+        }
+        if (options.scene & M_SCENE_2D) {
+            M_Render2D(renderer_2d, surface, frame);
+        }
+        GFX_Context_SwapBuffers();
+
+        const double ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / freq;
+        timings.total_ms += ms;
+        timings.min_ms = MIN(timings.min_ms, ms);
+        timings.max_ms = MAX(timings.max_ms, ms);
+    }
+
+    M_Report(&options, &timings, renderer_3d, renderer_2d);
+
+    GFX_2D_Surface_Free(surface);
+    GFX_3D_Renderer_UnregisterTexturePage(renderer_3d, texture_num);
+    GFX_Context_Detach();
+    Log_Shutdown();
+    return EXIT_SUCCESS;
+}
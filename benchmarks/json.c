@@ -0,0 +1,597 @@
+// Measures the JSON code on synthetic documents shaped like the config and
+// gameflow files, e.g.:
+//
+//     json_benchmark --keys 500 --items 5000 --rounds 200
+#include <libtrx/bson.h>
+#include <libtrx/bson_view.h>
+#include <libtrx/json.h>
+#include <libtrx/json_reader.h>
+#include <libtrx/json_writer.h>
+#include <libtrx/memory.h>
+#include <libtrx/utils.h>
+
+#include <SDL2/SDL_timer.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    int32_t keys;
+    int32_t items;
+    int32_t rounds;
+} M_OPTIONS;
+
+static bool M_ParseArgs(int argc, char **argv, M_OPTIONS *options);
+static double M_GetMilliseconds(uint64_t start);
+static char *M_GenerateObject(int32_t keys, size_t *out_size);
+static char *M_GenerateArray(int32_t items, size_t *out_size);
+static char *M_GenerateGameflow(int32_t levels, size_t *out_size);
+static JSON_VALUE *M_FindLinear(const JSON_OBJECT *obj, const char *key);
+static JSON_VALUE *M_GetLinear(const JSON_ARRAY *arr, size_t idx);
+static void M_BenchmarkLookups(const M_OPTIONS *options);
+static void M_BenchmarkArrays(const M_OPTIONS *options);
+static JSON_OBJECT *M_BuildSave(JSON_ARENA *arena, int32_t items);
+static void M_BenchmarkBuilder(const M_OPTIONS *options);
+static void M_StreamSave(JSON_WRITER *writer, int32_t items);
+static void M_BenchmarkWriter(const M_OPTIONS *options);
+static int64_t M_SumReader(JSON_READER *reader);
+static void M_BenchmarkReader(const M_OPTIONS *options);
+static void M_BenchmarkView(const M_OPTIONS *options);
+static void M_MeasureThroughput(
+    const char *name, const char *data, size_t size, size_t flags,
+    int32_t rounds);
+static void M_BenchmarkThroughput(const M_OPTIONS *options);
+
+void Shell_ExitSystem(const char *const message)
+{
+    fprintf(stderr, "%s\n", message);
+    exit(EXIT_FAILURE);
+}
+
+void Shell_ExitSystemFmt(const char *const fmt, ...)
+{
+    va_list va;
+    va_start(va, fmt);
+    vfprintf(stderr, fmt, va);
+    va_end(va);
+    fprintf(stderr, "\n");
+    exit(EXIT_FAILURE);
+}
+
+static bool M_ParseArgs(
+    const int argc, char **const argv, M_OPTIONS *const options)
+{
+    for (int i = 1; i < argc; i++) {
+        const char *const arg = argv[i];
+        const char *const value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (value == NULL) {
+            return false;
+        }
+
+        if (!strcmp(arg, "--keys")) {
+            options->keys = atoi(value);
+        } else if (!strcmp(arg, "--items")) {
+            options->items = atoi(value);
+        } else if (!strcmp(arg, "--rounds")) {
+            options->rounds = atoi(value);
+        } else {
+            return false;
+        }
+        i++;
+    }
+
+    return options->keys > 0 && options->items > 0 && options->rounds > 0;
+}
+
+static double M_GetMilliseconds(const uint64_t start)
+{
+    return (SDL_GetPerformanceCounter() - start) * 1000.0
+        / SDL_GetPerformanceFrequency();
+}
+
+static char *M_GenerateObject(const int32_t keys, size_t *const out_size)
+{
+    // a flat object with a mix of value types, like a config file
+    const size_t capacity = 64 + keys * 64;
+    char *const data = Memory_Alloc(capacity);
+    size_t size = 0;
+    size += snprintf(&data[size], capacity - size, "{\n");
+    for (int32_t i = 0; i < keys; i++) {
+        const char *const separator = i + 1 < keys ? "," : "";
+        switch (i % 4) {
+        case 0:
+            size += snprintf(
+                &data[size], capacity - size, "  \"option_%d\": %d%s\n", i,
+                i * 7, separator);
+            break;
+        case 1:
+            size += snprintf(
+                &data[size], capacity - size, "  \"option_%d\": %d.25%s\n", i,
+                i, separator);
+            break;
+        case 2:
+            size += snprintf(
+                &data[size], capacity - size, "  \"option_%d\": %s%s\n", i,
+                i % 8 == 2 ? "true" : "false", separator);
+            break;
+        default:
+            size += snprintf(
+                &data[size], capacity - size, "  \"option_%d\": \"v%d\"%s\n",
+                i, i, separator);
+            break;
+        }
+    }
+    size += snprintf(&data[size], capacity - size, "}\n");
+    *out_size = size;
+    return data;
+}
+
+static char *M_GenerateArray(const int32_t items, size_t *const out_size)
+{
+    // a list of small objects, like the items of a save game
+    const size_t capacity = 64 + items * 48;
+    char *const data = Memory_Alloc(capacity);
+    size_t size = 0;
+    size += snprintf(&data[size], capacity - size, "[");
+    for (int32_t i = 0; i < items; i++) {
+        size += snprintf(
+            &data[size], capacity - size, "%s{\"id\": %d, \"count\": %d}",
+            i ? "," : "", i, i % 10);
+    }
+    size += snprintf(&data[size], capacity - size, "]");
+    *out_size = size;
+    return data;
+}
+
+static char *M_GenerateGameflow(const int32_t levels, size_t *const out_size)
+{
+    // indented JSON5 with comments and long strings, like a gameflow file
+    const size_t capacity = 256 + levels * 1024;
+    char *const data = Memory_Alloc(capacity);
+    size_t size = 0;
+    size += snprintf(
+        &data[size], capacity - size,
+        "{\n    // levels in the order they are played\n"
+        "    \"levels\": [\n");
+    for (int32_t i = 0; i < levels; i++) {
+        size += snprintf(
+            &data[size], capacity - size,
+            "        {\n"
+            "            \"title\": \"Level %d - The Lost Valley\",\n"
+            "            \"file\": \"data/level%d.phd\",\n"
+            "            \"type\": \"normal\",\n"
+            "            \"music_track\": %d,\n"
+            "            \"water_color\": [0.45, 1.0, 1.0],\n"
+            "            \"injections\": [\n"
+            "                \"data/injections/level%d_fixes.bin\",\n"
+            "                \"data/injections/level%d_textures.bin\"\n"
+            "            ],\n"
+            "            \"sequence\": [\n"
+            "                {\"type\": \"loading_screen\", "
+            "\"picture_path\": \"data/images/level%d.webp\", "
+            "\"display_time\": 5},\n"
+            "                {\"type\": \"start_game\"},\n"
+            "                {\"type\": \"loop_game\"},\n"
+            "                {\"type\": \"level_stats\", "
+            "\"level_id\": %d},\n"
+            "                {\"type\": \"exit_to_level\", "
+            "\"level_id\": %d}\n"
+            "            ],\n"
+            "            \"strings\": {\n"
+            "                \"key_1\": \"Some ancient key, worn smooth "
+            "by centuries of use\",\n"
+            "                \"pickup_1\": \"A crystal that glows with a "
+            "faint \\\"inner\\\" light\"\n"
+            "            }\n"
+            "        }%s\n",
+            i, i, 57 + i, i, i, i, i, i + 1, i + 1 < levels ? "," : "");
+    }
+    size += snprintf(&data[size], capacity - size, "    ]\n}\n");
+    *out_size = size;
+    return data;
+}
+
+static JSON_VALUE *M_FindLinear(const JSON_OBJECT *const obj, const char *key)
+{
+    // what JSON_ObjectGetValue did before objects were indexed
+    for (JSON_OBJECT_ELEMENT *elem = obj->start; elem; elem = elem->next) {
+        if (!strcmp(elem->name->string, key)) {
+            return elem->value;
+        }
+    }
+    return NULL;
+}
+
+static JSON_VALUE *M_GetLinear(const JSON_ARRAY *const arr, const size_t idx)
+{
+    // what JSON_ArrayGetValue did before arrays kept an element vector
+    JSON_ARRAY_ELEMENT *elem = arr->start;
+    for (size_t i = 0; i < idx; i++) {
+        elem = elem->next;
+    }
+    return elem->value;
+}
+
+static void M_BenchmarkLookups(const M_OPTIONS *const options)
+{
+    size_t size;
+    char *data = M_GenerateObject(options->keys, &size);
+    char key[32];
+
+    uint64_t start = SDL_GetPerformanceCounter();
+    for (int32_t round = 0; round < options->rounds; round++) {
+        JSON_VALUE *const root = JSON_Parse(data, size);
+        JSON_ValueFree(root);
+    }
+    const double parse_ms = M_GetMilliseconds(start);
+
+    JSON_VALUE *const root = JSON_Parse(data, size);
+    JSON_OBJECT *const obj = JSON_ValueAsObject(root);
+
+    // look every key up once per round, as loading the options does
+    int32_t found = 0;
+    start = SDL_GetPerformanceCounter();
+    for (int32_t round = 0; round < options->rounds; round++) {
+        for (int32_t i = 0; i < options->keys; i++) {
+            snprintf(key, sizeof(key), "option_%d", i);
+            found += M_FindLinear(obj, key) != NULL;
+        }
+    }
+    const double linear_ms = M_GetMilliseconds(start);
+
+    start = SDL_GetPerformanceCounter();
+    for (int32_t round = 0; round < options->rounds; round++) {
+        for (int32_t i = 0; i < options->keys; i++) {
+            snprintf(key, sizeof(key), "option_%d", i);
+            found += JSON_ObjectGetValue(obj, key) != NULL;
+        }
+    }
+    const double indexed_ms = M_GetMilliseconds(start);
+
+    JSON_ValueFree(root);
+    Memory_FreePointer(&data);
+
+    printf("document:        %d keys, %zu bytes\n", options->keys, size);
+    printf(
+        "parse:           %.3f ms per document\n", parse_ms / options->rounds);
+    printf(
+        "linear lookups:  %.3f ms per document\n",
+        linear_ms / options->rounds);
+    printf(
+        "indexed lookups: %.3f ms per document (%.1fx)\n",
+        indexed_ms / options->rounds, linear_ms / MAX(indexed_ms, 1e-9));
+    const int32_t missed = options->keys * options->rounds * 2 - found;
+    if (missed != 0) {
+        printf("warning: %d lookups failed\n", missed);
+    }
+}
+
+static void M_BenchmarkArrays(const M_OPTIONS *const options)
+{
+    size_t size;
+    char *data = M_GenerateArray(options->items, &size);
+    JSON_VALUE *const root = JSON_Parse(data, size);
+    JSON_ARRAY *const arr = JSON_ValueAsArray(root);
+
+    // a single round is enough to show the quadratic walk
+    int64_t sum = 0;
+    uint64_t start = SDL_GetPerformanceCounter();
+    for (int32_t i = 0; i < options->items; i++) {
+        sum += JSON_ObjectGetInt(
+            JSON_ValueAsObject(M_GetLinear(arr, i)), "count", 0);
+    }
+    const double linear_ms = M_GetMilliseconds(start);
+
+    start = SDL_GetPerformanceCounter();
+    for (int32_t round = 0; round < options->rounds; round++) {
+        for (int32_t i = 0; i < options->items; i++) {
+            sum += JSON_ObjectGetInt(JSON_ArrayGetObject(arr, i), "count", 0);
+        }
+    }
+    const double indexed_ms = M_GetMilliseconds(start) / options->rounds;
+
+    JSON_ValueFree(root);
+    Memory_FreePointer(&data);
+
+    printf("array:           %d items, %zu bytes\n", options->items, size);
+    printf("linear access:   %.3f ms per array\n", linear_ms);
+    printf(
+        "indexed access:  %.3f ms per array (%.1fx)\n", indexed_ms,
+        linear_ms / MAX(indexed_ms, 1e-9));
+    if (sum < 0) {
+        printf("warning: unexpected checksum\n");
+    }
+}
+
+static JSON_OBJECT *M_BuildSave(JSON_ARENA *const arena, const int32_t items)
+{
+    // roughly what a save game looks like: a list of items with a position,
+    // a few flags and a nested array each
+    JSON_OBJECT *const root = JSON_ObjectNewInArena(arena);
+    JSON_ObjectAppendInt(root, "version", 4);
+    JSON_ObjectAppendString(root, "level_title", "City of Vilcabamba");
+    JSON_ARRAY *const arr = JSON_ArrayNewInArena(arena);
+    for (int32_t i = 0; i < items; i++) {
+        JSON_OBJECT *const item = JSON_ObjectNewInArena(arena);
+        JSON_ObjectAppendInt(item, "object_id", i % 200);
+        JSON_ObjectAppendInt(item, "x", i * 1024);
+        JSON_ObjectAppendInt(item, "y", -i * 256);
+        JSON_ObjectAppendInt(item, "z", i * 512);
+        JSON_ObjectAppendInt(item, "room_num", i % 80);
+        JSON_ObjectAppendDouble(item, "speed", i * 0.5);
+        JSON_ObjectAppendBool(item, "active", i % 2);
+        JSON_ObjectAppendString(item, "name", "item");
+        JSON_ARRAY *const flags = JSON_ArrayNewInArena(arena);
+        for (int32_t j = 0; j < 4; j++) {
+            JSON_ArrayAppendInt(flags, i + j);
+        }
+        JSON_ObjectAppendArray(item, "flags", flags);
+        JSON_ArrayAppendObject(arr, item);
+    }
+    JSON_ObjectAppendArray(root, "items", arr);
+    return root;
+}
+
+static void M_BenchmarkBuilder(const M_OPTIONS *const options)
+{
+    uint64_t start = SDL_GetPerformanceCounter();
+    for (int32_t round = 0; round < options->rounds; round++) {
+        JSON_OBJECT *const root = M_BuildSave(NULL, options->items);
+        JSON_ObjectFree(root);
+    }
+    const double heap_ms = M_GetMilliseconds(start) / options->rounds;
+
+    JSON_ARENA_STATS stats = { 0 };
+    start = SDL_GetPerformanceCounter();
+    for (int32_t round = 0; round < options->rounds; round++) {
+        JSON_ARENA *const arena = JSON_ArenaNew();
+        M_BuildSave(arena, options->items);
+        stats = JSON_ArenaGetStats(arena);
+        JSON_ArenaFree(arena);
+    }
+    const double arena_ms = M_GetMilliseconds(start) / options->rounds;
+
+    printf("save tree:       %d items\n", options->items);
+    printf(
+        "heap builder:    %.3f ms per tree, %zu allocations\n", heap_ms,
+        stats.allocations);
+    printf(
+        "arena builder:   %.3f ms per tree, %zu blocks, %zu KB (%.1fx)\n",
+        arena_ms, stats.blocks, stats.reserved / 1024,
+        heap_ms / MAX(arena_ms, 1e-9));
+}
+
+static void M_StreamSave(JSON_WRITER *const writer, const int32_t items)
+{
+    // the same document as M_BuildSave
+    JSON_WriterBeginObject(writer);
+    JSON_WriterKey(writer, "version");
+    JSON_WriterInt(writer, 4);
+    JSON_WriterKey(writer, "level_title");
+    JSON_WriterString(writer, "City of Vilcabamba");
+    JSON_WriterKey(writer, "items");
+    JSON_WriterBeginArray(writer);
+    for (int32_t i = 0; i < items; i++) {
+        JSON_WriterBeginObject(writer);
+        JSON_WriterKey(writer, "object_id");
+        JSON_WriterInt(writer, i % 200);
+        JSON_WriterKey(writer, "x");
+        JSON_WriterInt(writer, i * 1024);
+        JSON_WriterKey(writer, "y");
+        JSON_WriterInt(writer, -i * 256);
+        JSON_WriterKey(writer, "z");
+        JSON_WriterInt(writer, i * 512);
+        JSON_WriterKey(writer, "room_num");
+        JSON_WriterInt(writer, i % 80);
+        JSON_WriterKey(writer, "speed");
+        JSON_WriterDouble(writer, i * 0.5);
+        JSON_WriterKey(writer, "active");
+        JSON_WriterBool(writer, i % 2);
+        JSON_WriterKey(writer, "name");
+        JSON_WriterString(writer, "item");
+        JSON_WriterKey(writer, "flags");
+        JSON_WriterBeginArray(writer);
+        for (int32_t j = 0; j < 4; j++) {
+            JSON_WriterInt(writer, i + j);
+        }
+        JSON_WriterEndArray(writer);
+        JSON_WriterEndObject(writer);
+    }
+    JSON_WriterEndArray(writer);
+    JSON_WriterEndObject(writer);
+}
+
+static void M_BenchmarkWriter(const M_OPTIONS *const options)
+{
+    size_t dom_size = 0;
+    uint64_t start = SDL_GetPerformanceCounter();
+    for (int32_t round = 0; round < options->rounds; round++) {
+        JSON_VALUE *const root =
+            JSON_ValueFromObject(M_BuildSave(NULL, options->items));
+        void *data = BSON_Write(root, &dom_size);
+        JSON_ValueFree(root);
+        Memory_FreePointer(&data);
+    }
+    const double dom_ms = M_GetMilliseconds(start) / options->rounds;
+
+    size_t stream_size = 0;
+    start = SDL_GetPerformanceCounter();
+    for (int32_t round = 0; round < options->rounds; round++) {
+        JSON_WRITER *const writer = JSON_WriterNew(JSON_WRITER_FORMAT_BSON);
+        M_StreamSave(writer, options->items);
+        void *data = JSON_WriterFinish(writer, &stream_size);
+        Memory_FreePointer(&data);
+    }
+    const double stream_ms = M_GetMilliseconds(start) / options->rounds;
+
+    printf("dom to bson:     %.3f ms per save, %zu bytes\n", dom_ms, dom_size);
+    printf(
+        "streamed bson:   %.3f ms per save, %zu bytes (%.1fx)\n", stream_ms,
+        stream_size, dom_ms / MAX(stream_ms, 1e-9));
+}
+
+static int64_t M_SumReader(JSON_READER *const reader)
+{
+    int64_t sum = 0;
+    bool is_count = false;
+    JSON_TOKEN token;
+    while ((token = JSON_ReaderNext(reader)) > JSON_TOKEN_ERROR) {
+        if (token == JSON_TOKEN_KEY) {
+            is_count = !strcmp(JSON_ReaderGetString(reader, "", NULL), "count");
+        } else if (token == JSON_TOKEN_NUMBER && is_count) {
+            sum += JSON_ReaderGetInt(reader, 0);
+        }
+    }
+    return token == JSON_TOKEN_NONE ? sum : -1;
+}
+
+static void M_BenchmarkReader(const M_OPTIONS *const options)
+{
+    size_t size;
+    char *data = M_GenerateArray(options->items, &size);
+
+    int64_t dom_sum = 0;
+    uint64_t start = SDL_GetPerformanceCounter();
+    for (int32_t round = 0; round < options->rounds; round++) {
+        JSON_VALUE *const root = JSON_Parse(data, size);
+        JSON_ARRAY *const arr = JSON_ValueAsArray(root);
+        for (size_t i = 0; i < arr->length; i++) {
+            dom_sum +=
+                JSON_ObjectGetInt(JSON_ArrayGetObject(arr, i), "count", 0);
+        }
+        JSON_ValueFree(root);
+    }
+    const double dom_ms = M_GetMilliseconds(start) / options->rounds;
+
+    int64_t reader_sum = 0;
+    start = SDL_GetPerformanceCounter();
+    for (int32_t round = 0; round < options->rounds; round++) {
+        JSON_READER *const reader =
+            JSON_ReaderNew(data, size, JSON_PARSE_FLAGS_DEFAULT);
+        reader_sum += M_SumReader(reader);
+        JSON_ReaderFree(reader);
+    }
+    const double reader_ms = M_GetMilliseconds(start) / options->rounds;
+
+    Memory_FreePointer(&data);
+
+    printf("dom parse+walk:  %.3f ms per array\n", dom_ms);
+    printf(
+        "pull parser:     %.3f ms per array (%.1fx)\n", reader_ms,
+        dom_ms / MAX(reader_ms, 1e-9));
+    if (dom_sum != reader_sum) {
+        printf("warning: checksums differ\n");
+    }
+}
+
+static void M_BenchmarkView(const M_OPTIONS *const options)
+{
+    // reading the header of a save, as for the save slot list
+    JSON_VALUE *const root =
+        JSON_ValueFromObject(M_BuildSave(NULL, options->items));
+    size_t size;
+    char *data = BSON_Write(root, &size);
+    JSON_ValueFree(root);
+
+    int64_t dom_sum = 0;
+    uint64_t start = SDL_GetPerformanceCounter();
+    for (int32_t round = 0; round < options->rounds; round++) {
+        JSON_VALUE *const save = BSON_Parse(data, size);
+        JSON_OBJECT *const save_obj = JSON_ValueAsObject(save);
+        dom_sum += JSON_ObjectGetInt(save_obj, "version", 0);
+        dom_sum += strlen(JSON_ObjectGetString(save_obj, "level_title", ""));
+        JSON_ValueFree(save);
+    }
+    const double dom_ms = M_GetMilliseconds(start) / options->rounds;
+
+    int64_t view_sum = 0;
+    start = SDL_GetPerformanceCounter();
+    for (int32_t round = 0; round < options->rounds; round++) {
+        BSON_VIEW view;
+        BSON_ViewInit(&view, data, size);
+        view_sum += BSON_ViewGetInt(&view, "version", 0);
+        view_sum += strlen(BSON_ViewGetString(&view, "level_title", ""));
+    }
+    const double view_ms = M_GetMilliseconds(start) / options->rounds;
+
+    Memory_FreePointer(&data);
+
+    printf("bson header:     %.3f ms per save, %zu bytes\n", dom_ms, size);
+    printf(
+        "bson view:       %.6f ms per save (%.1fx)\n", view_ms,
+        dom_ms / MAX(view_ms, 1e-9));
+    if (dom_sum != view_sum) {
+        printf("warning: checksums differ\n");
+    }
+}
+
+static void M_MeasureThroughput(
+    const char *const name, const char *const data, const size_t size,
+    const size_t flags, const int32_t rounds)
+{
+    const uint64_t start = SDL_GetPerformanceCounter();
+    for (int32_t round = 0; round < rounds; round++) {
+        JSON_VALUE *const root =
+            JSON_ParseEx(data, size, flags, NULL, NULL, NULL);
+        if (root == NULL) {
+            printf("warning: failed to parse the %s document\n", name);
+            return;
+        }
+        JSON_ValueFree(root);
+    }
+    const double ms = M_GetMilliseconds(start);
+    printf(
+        "%-16s %.1f MB/s (%zu bytes)\n", name,
+        size * (double)rounds / (1024.0 * 1024.0) / (MAX(ms, 1e-9) / 1000.0),
+        size);
+}
+
+static void M_BenchmarkThroughput(const M_OPTIONS *const options)
+{
+    // a gameflow file has a few dozen levels, so scale it down
+    const int32_t levels = MAX(options->items / 100, 1);
+    size_t size;
+    char *data = M_GenerateGameflow(levels, &size);
+    M_MeasureThroughput(
+        "gameflow parse:", data, size, JSON_PARSE_FLAGS_ALLOW_JSON5,
+        options->rounds);
+    Memory_FreePointer(&data);
+
+    data = M_GenerateArray(options->items, &size);
+    M_MeasureThroughput(
+        "save parse:", data, size, JSON_PARSE_FLAGS_DEFAULT, options->rounds);
+    Memory_FreePointer(&data);
+
+    data = M_GenerateObject(options->keys, &size);
+    M_MeasureThroughput(
+        "config parse:", data, size, JSON_PARSE_FLAGS_ALLOW_JSON5,
+        options->rounds);
+    Memory_FreePointer(&data);
+}
+
+int main(int argc, char **argv)
+{
+    M_OPTIONS options = {
+        .keys = 500,
+        .items = 5000,
+        .rounds = 200,
+    };
+    if (!M_ParseArgs(argc, argv, &options)) {
+        fprintf(
+            stderr, "usage: %s [--keys N] [--items N] [--rounds N]\n",
+            argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    M_BenchmarkLookups(&options);
+    M_BenchmarkArrays(&options);
+    M_BenchmarkBuilder(&options);
+    M_BenchmarkWriter(&options);
+    M_BenchmarkReader(&options);
+    M_BenchmarkView(&options);
+    M_BenchmarkThroughput(&options);
+    return EXIT_SUCCESS;
+}
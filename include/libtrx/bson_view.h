@@ -0,0 +1,67 @@
+#pragma once
+
+#include "json.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Read-only view of a BSON document that navigates the binary data in place,
+// using the embedded lengths to step over values. Nothing is validated up
+// front and nothing is allocated: every call checks only the bytes it walks
+// over, and malformed data reads as missing. The source must stay valid
+// while the view is in use.
+typedef struct {
+    const char *src;
+    size_t size;
+} BSON_VIEW;
+
+typedef struct {
+    const char *key;
+    JSON_TYPE type;
+    // the raw value: string characters without the null terminator, or
+    // a whole embedded document
+    const char *data;
+    size_t size;
+
+    // internal
+    uint8_t marker;
+    size_t next_offset;
+} BSON_VIEW_ELEMENT;
+
+// Returns false if the buffer does not start with a complete document.
+bool BSON_ViewInit(BSON_VIEW *view, const void *src, size_t src_size);
+
+// Iterates over the elements in order, starting from a zero-initialized
+// element. Returns false at the end of the document or on malformed data.
+bool BSON_ViewNext(const BSON_VIEW *view, BSON_VIEW_ELEMENT *element);
+bool BSON_ViewFind(
+    const BSON_VIEW *view, const char *key, BSON_VIEW_ELEMENT *element);
+// Array elements are found by walking, so iterate over long arrays with
+// BSON_ViewNext instead.
+bool BSON_ViewAt(const BSON_VIEW *view, size_t idx, BSON_VIEW_ELEMENT *element);
+size_t BSON_ViewCount(const BSON_VIEW *view);
+
+// The getters return the default value d unless the element has a matching
+// type.
+int BSON_ViewElementGetBool(const BSON_VIEW_ELEMENT *element, int d);
+int BSON_ViewElementGetInt(const BSON_VIEW_ELEMENT *element, int d);
+int64_t BSON_ViewElementGetInt64(const BSON_VIEW_ELEMENT *element, int64_t d);
+double BSON_ViewElementGetDouble(const BSON_VIEW_ELEMENT *element, double d);
+const char *BSON_ViewElementGetString(
+    const BSON_VIEW_ELEMENT *element, const char *d);
+bool BSON_ViewElementGetObject(
+    const BSON_VIEW_ELEMENT *element, BSON_VIEW *out_view);
+bool BSON_ViewElementGetArray(
+    const BSON_VIEW_ELEMENT *element, BSON_VIEW *out_view);
+
+int BSON_ViewGetBool(const BSON_VIEW *view, const char *key, int d);
+int BSON_ViewGetInt(const BSON_VIEW *view, const char *key, int d);
+int64_t BSON_ViewGetInt64(const BSON_VIEW *view, const char *key, int64_t d);
+double BSON_ViewGetDouble(const BSON_VIEW *view, const char *key, double d);
+const char *BSON_ViewGetString(
+    const BSON_VIEW *view, const char *key, const char *d);
+bool BSON_ViewGetObject(
+    const BSON_VIEW *view, const char *key, BSON_VIEW *out_view);
+bool BSON_ViewGetArray(
+    const BSON_VIEW *view, const char *key, BSON_VIEW *out_view);
@@ -13,6 +13,18 @@ void Config_Shutdown(void);
 bool Config_Read(void);
 bool Config_Write(void);
 
+// Records that the settings changed, for example after a toggle in the UI,
+// without writing them right away. The caller sanitizes and applies the
+// changes itself. Once the settings stay unchanged for a moment,
+// Config_Update dumps them and a background thread writes the file if its
+// contents differ; the write event fires on a later Config_Update.
+//
+// Config_Update must run every frame; Console_Draw calls it. A clean
+// Config_Shutdown saves whatever is still pending.
+void Config_MarkDirty(void);
+bool Config_IsDirty(void);
+void Config_Update(void);
+
 int32_t Config_SubscribeChanges(EVENT_LISTENER listener, void *user_data);
 void Config_UnsubscribeChanges(int32_t listener_id);
 
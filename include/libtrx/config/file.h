@@ -2,18 +2,41 @@
 
 #include "../enum_str.h"
 #include "../json.h"
+#include "../json_reader.h"
+#include "../json_writer.h"
 #include "./option.h"
 
 #include <stdbool.h>
 #include <stdint.h>
 
 bool ConfigFile_Read(const char *path, void (*load)(JSON_OBJECT *root_obj));
+// Same as ConfigFile_Read, but the loader pulls the values straight from
+// a reader instead of a parsed DOM.
+bool ConfigFile_ReadStream(
+    const char *path, void (*load)(JSON_READER *reader));
 bool ConfigFile_Write(const char *path, void (*dump)(JSON_OBJECT *root_obj));
+// Same as ConfigFile_Write, but the options are streamed into the root
+// object without building a DOM first.
+bool ConfigFile_WriteStream(
+    const char *path, void (*dump)(JSON_WRITER *writer));
+// The two halves of ConfigFile_Write. ConfigFile_Dump reads the settings
+// into a detached tree; ConfigFile_WriteDump serializes and frees it, and
+// touches no game state, so it can run on any thread. Both writers skip
+// writing if the file already holds the same data.
+JSON_VALUE *ConfigFile_Dump(void (*dump)(JSON_OBJECT *root_obj));
+bool ConfigFile_WriteDump(const char *path, JSON_VALUE *root);
+bool ConfigFile_WriteData(const char *path, const char *data);
 
 void ConfigFile_LoadOptions(
     JSON_OBJECT *root_obj, const CONFIG_OPTION *options);
+// Reads the root object from the reader. Keys without a matching option are
+// skipped; if the input is malformed, all options revert to their defaults.
+void ConfigFile_LoadOptionsStream(
+    JSON_READER *reader, const CONFIG_OPTION *options);
 void ConfigFile_DumpOptions(
     JSON_OBJECT *root_obj, const CONFIG_OPTION *options);
+void ConfigFile_StreamOptions(
+    JSON_WRITER *writer, const CONFIG_OPTION *options);
 
 int ConfigFile_ReadEnum(
     JSON_OBJECT *obj, const char *name, int default_value,
@@ -21,3 +44,6 @@ int ConfigFile_ReadEnum(
 void ConfigFile_WriteEnum(
     JSON_OBJECT *obj, const char *name, int value,
     const ENUM_STRING_MAP *enum_map);
+void ConfigFile_StreamEnum(
+    JSON_WRITER *writer, const char *name, int value,
+    const ENUM_STRING_MAP *enum_map);
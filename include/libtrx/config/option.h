@@ -15,3 +15,14 @@ typedef struct {
     const void *default_value;
     const void *param;
 } CONFIG_OPTION;
+
+// Finds an option by its key in constant time, ignoring any dotted prefix
+// of the option name and treating '-' and '_' alike. The index is built on
+// the first lookup into an option map and kept until ConfigOption_Shutdown.
+// Several options can share a key; this returns the first of them in the map
+// and ConfigOption_FindNext the ones after it.
+const CONFIG_OPTION *ConfigOption_Find(
+    const CONFIG_OPTION *options, const char *key);
+const CONFIG_OPTION *ConfigOption_FindNext(
+    const CONFIG_OPTION *options, const CONFIG_OPTION *option);
+void ConfigOption_Shutdown(void);
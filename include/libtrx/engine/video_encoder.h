@@ -0,0 +1,20 @@
+#pragma once
+
+#include "image.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct VIDEO_ENCODER VIDEO_ENCODER;
+
+// Opens a video file for writing. The container is guessed from the path's
+// extension and falls back to Matroska; the codec is the container's default
+// if an encoder for it is available, or MPEG-4 otherwise.
+VIDEO_ENCODER *VideoEncoder_Open(
+    const char *path, int32_t width, int32_t height, int32_t fps);
+
+// Appends a frame. Images of a different size than the video are scaled.
+bool VideoEncoder_WriteFrame(VIDEO_ENCODER *encoder, const IMAGE *image);
+
+// Flushes the encoder, finalizes the file and frees the encoder.
+void VideoEncoder_Close(VIDEO_ENCODER *encoder);
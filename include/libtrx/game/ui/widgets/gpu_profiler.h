@@ -0,0 +1,6 @@
+#pragma once
+
+#include "./base.h"
+
+// Overlay showing the latest GPU timings while the profiler is enabled.
+UI_WIDGET *UI_GpuProfiler_Create(void);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../config.h"
 #include "../gl/buffer.h"
 #include "../gl/program.h"
 #include "../gl/sampler.h"
@@ -11,18 +12,38 @@
 #include <stdint.h>
 
 typedef struct {
+    const GFX_CONFIG *config;
     uint32_t width;
     uint32_t height;
+    // the surface whose pixels the texture holds, NULL after a raw upload
+    const GFX_2D_SURFACE *surface;
+    GFX_GL_BUFFER upload_buffer;
     GFX_GL_VERTEX_ARRAY surface_format;
     GFX_GL_BUFFER surface_buffer;
     GFX_GL_TEXTURE surface_texture;
     GFX_GL_SAMPLER sampler;
     GFX_GL_PROGRAM program;
+
+    // running totals, never reset by the renderer itself
+    struct {
+        uint64_t draw_calls;
+        uint64_t uploaded_bytes;
+    } stats;
 } GFX_2D_RENDERER;
 
-void GFX_2D_Renderer_Init(GFX_2D_RENDERER *renderer);
+void GFX_2D_Renderer_Init(GFX_2D_RENDERER *renderer, const GFX_CONFIG *config);
 void GFX_2D_Renderer_Close(GFX_2D_RENDERER *renderer);
 
 void GFX_2D_Renderer_Upload(
     GFX_2D_RENDERER *renderer, GFX_2D_SURFACE_DESC *desc, const uint8_t *data);
+// Uploads only the given region of data, which must be laid out as described
+// by desc. Passing NULL uploads everything. A size change always re-creates
+// the texture from the full image.
+void GFX_2D_Renderer_UploadRect(
+    GFX_2D_RENDERER *renderer, GFX_2D_SURFACE_DESC *desc, const uint8_t *data,
+    const GFX_2D_RECT *rect);
+// Uploads the dirty region of the surface, if any, and marks it clean. The
+// whole surface is uploaded if the texture last held something else.
+void GFX_2D_Renderer_UploadSurface(
+    GFX_2D_RENDERER *renderer, GFX_2D_SURFACE *surface);
 void GFX_2D_Renderer_Render(GFX_2D_RENDERER *renderer);
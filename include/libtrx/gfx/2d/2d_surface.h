@@ -16,11 +16,21 @@ typedef struct {
     GLenum tex_type;
 } GFX_2D_SURFACE_DESC;
 
+typedef struct {
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+} GFX_2D_RECT;
+
 typedef struct {
     uint8_t *buffer;
     GFX_2D_SURFACE_DESC desc;
     bool is_locked;
     bool is_dirty;
+    // bounding box of all regions changed since the last upload; only
+    // meaningful while is_dirty is set
+    GFX_2D_RECT dirty_rect;
 } GFX_2D_SURFACE;
 
 GFX_2D_SURFACE *GFX_2D_Surface_Create(const GFX_2D_SURFACE_DESC *desc);
@@ -33,6 +43,17 @@ void GFX_2D_Surface_Close(GFX_2D_SURFACE *surface);
 
 bool GFX_2D_Surface_Clear(GFX_2D_SURFACE *surface);
 
+// Extends the dirty region by rect, clipped to the surface. Passing NULL marks
+// the whole surface dirty.
+void GFX_2D_Surface_MarkDirty(GFX_2D_SURFACE *surface, const GFX_2D_RECT *rect);
+void GFX_2D_Surface_MarkClean(GFX_2D_SURFACE *surface);
+
+// Locks the whole surface and marks all of it dirty.
 bool GFX_2D_Surface_Lock(
     GFX_2D_SURFACE *surface, GFX_2D_SURFACE_DESC *out_desc);
+// Locks the surface but marks only rect dirty; the caller must not write
+// outside of it.
+bool GFX_2D_Surface_LockRect(
+    GFX_2D_SURFACE *surface, const GFX_2D_RECT *rect,
+    GFX_2D_SURFACE_DESC *out_desc);
 bool GFX_2D_Surface_Unlock(GFX_2D_SURFACE *surface);
@@ -6,21 +6,19 @@
 #include "../gl/program.h"
 #include "../gl/sampler.h"
 #include "../gl/texture.h"
+#include "static_mesh.h"
+#include "vertex_arena.h"
 #include "vertex_stream.h"
 
 #define GFX_MAX_TEXTURES 128
 #define GFX_NO_TEXTURE (-1)
 #define GFX_ENV_MAP_TEXTURE (-2)
+#define GFX_MAX_STATIC_MESHES 1024
+#define GFX_NO_STATIC_MESH (-1)
 
 #include <stdbool.h>
 #include <stdint.h>
 
-typedef enum {
-    GFX_BLEND_MODE_OFF,
-    GFX_BLEND_MODE_NORMAL,
-    GFX_BLEND_MODE_MULTIPLY,
-} GFX_BLEND_MODE;
-
 typedef struct {
     const GFX_CONFIG *config;
 
@@ -32,6 +30,18 @@ typedef struct {
     GFX_GL_TEXTURE *env_map_texture;
     int selected_texture_num;
 
+    // the environment map storage is allocated once per size and refreshed
+    // in place; a separate sampler picks up its mipmaps
+    GFX_GL_SAMPLER env_map_sampler;
+    GLuint env_map_fbo;
+    int32_t env_map_side;
+    bool env_map_has_mipmaps;
+    uint32_t env_map_requests;
+
+    GFX_3D_STATIC_MESH *static_meshes[GFX_MAX_STATIC_MESHES];
+    // bumped whenever the lighting baked into the static meshes goes stale
+    uint32_t lighting_version;
+
     // shader variable locations
     GLint loc_mat_projection;
     GLint loc_mat_model_view;
@@ -48,6 +58,12 @@ void GFX_3D_Renderer_ClearDepth(GFX_3D_RENDERER *renderer);
 
 int GFX_3D_Renderer_RegisterTexturePage(
     GFX_3D_RENDERER *renderer, const void *data, int width, int height);
+// Registers several pages of the same size at once, generating their mipmaps
+// in parallel. Stores the texture numbers in out_texture_nums and returns
+// false if the renderer ran out of texture slots.
+bool GFX_3D_Renderer_RegisterTexturePages(
+    GFX_3D_RENDERER *renderer, const void *const *pages, int count, int width,
+    int height, int *out_texture_nums);
 bool GFX_3D_Renderer_UnregisterTexturePage(
     GFX_3D_RENDERER *renderer, int texture_num);
 
@@ -66,8 +82,38 @@ void GFX_3D_Renderer_RenderPrimFan(
 void GFX_3D_Renderer_RenderPrimList(
     GFX_3D_RENDERER *renderer, GFX_3D_VERTEX *vertices, int count);
 
+// Replays the arenas in the order given, as if their contents had been passed
+// to the renderer directly. The result does not depend on which thread filled
+// which arena or in what order the threads finished.
+void GFX_3D_Renderer_SubmitArenas(
+    GFX_3D_RENDERER *renderer, GFX_3D_VERTEX_ARENA *const *arenas,
+    int32_t count);
+
+// Uploads an indexed triangle mesh once and returns a handle to draw it with,
+// or GFX_NO_STATIC_MESH if there are no free slots left.
+int GFX_3D_Renderer_RegisterStaticMesh(
+    GFX_3D_RENDERER *renderer, const GFX_3D_VERTEX *vertices,
+    int32_t vertex_count, const uint32_t *indices, int32_t index_count,
+    const GFX_3D_STATIC_MESH_RANGE *ranges, int32_t range_count);
+bool GFX_3D_Renderer_UnregisterStaticMesh(
+    GFX_3D_RENDERER *renderer, int mesh_num);
+
+// Marks the lighting of every static mesh as out of date.
+void GFX_3D_Renderer_InvalidateStaticLighting(GFX_3D_RENDERER *renderer);
+// Replaces the vertices of a mesh with freshly lit ones.
+bool GFX_3D_Renderer_UpdateStaticMeshLighting(
+    GFX_3D_RENDERER *renderer, int mesh_num, const GFX_3D_VERTEX *vertices);
+
+// Draws a static mesh with each of its ranges' textures, transformed by the
+// given column-major matrix, or as is if transform is NULL. Returns false
+// without drawing anything if the mesh's lighting is out of date.
+bool GFX_3D_Renderer_DrawStaticMesh(
+    GFX_3D_RENDERER *renderer, int mesh_num, const float *transform);
+
 void GFX_3D_Renderer_SetPrimType(
     GFX_3D_RENDERER *renderer, GFX_3D_PRIM_TYPE value);
+void GFX_3D_Renderer_SetCulling(
+    GFX_3D_RENDERER *renderer, bool cull_offscreen, GFX_3D_CULL_FACE cull_face);
 void GFX_3D_Renderer_SetTextureFilter(
     GFX_3D_RENDERER *renderer, GFX_TEXTURE_FILTER filter);
 void GFX_3D_Renderer_SetDepthTestEnabled(
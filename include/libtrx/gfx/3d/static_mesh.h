@@ -0,0 +1,49 @@
+#pragma once
+
+#include "../gl/buffer.h"
+#include "../gl/vertex_array.h"
+#include "vertex_stream.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// A static mesh keeps geometry that does not change between frames, such as
+// room meshes, in GPU memory so that it does not have to be streamed again
+// every frame. The vertex colours carry the baked lighting and can be
+// replaced in place when it changes.
+
+typedef struct {
+    // a run of triangles in the index buffer drawn with one texture
+    int32_t first_index;
+    int32_t index_count;
+    int texture_num;
+} GFX_3D_STATIC_MESH_RANGE;
+
+typedef struct {
+    GFX_GL_VERTEX_ARRAY vtc_format;
+    GFX_GL_BUFFER vertex_buffer;
+    GFX_GL_BUFFER index_buffer;
+    int32_t vertex_count;
+    int32_t index_count;
+
+    GFX_3D_STATIC_MESH_RANGE *ranges;
+    int32_t range_count;
+
+    // the renderer's lighting version the vertices were uploaded with
+    uint32_t lighting_version;
+} GFX_3D_STATIC_MESH;
+
+void GFX_3D_StaticMesh_Init(
+    GFX_3D_STATIC_MESH *mesh, const GFX_3D_VERTEX *vertices,
+    int32_t vertex_count, const uint32_t *indices, int32_t index_count,
+    const GFX_3D_STATIC_MESH_RANGE *ranges, int32_t range_count);
+void GFX_3D_StaticMesh_Close(GFX_3D_STATIC_MESH *mesh);
+
+// Replaces all vertices, typically to update their lighting. The count must
+// match the one the mesh was created with.
+void GFX_3D_StaticMesh_UpdateVertices(
+    GFX_3D_STATIC_MESH *mesh, const GFX_3D_VERTEX *vertices);
+
+void GFX_3D_StaticMesh_Bind(GFX_3D_STATIC_MESH *mesh);
+void GFX_3D_StaticMesh_DrawRange(
+    const GFX_3D_STATIC_MESH *mesh, const GFX_3D_STATIC_MESH_RANGE *range);
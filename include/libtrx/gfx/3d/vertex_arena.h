@@ -0,0 +1,79 @@
+#pragma once
+
+#include "../common.h"
+#include "vertex_stream.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// A vertex arena records primitives and render state changes on behalf of
+// the 3D renderer without touching GL, so that several threads can each fill
+// their own arena in parallel. The render thread then replays the arenas with
+// GFX_3D_Renderer_SubmitArenas. Arenas must not be shared between threads
+// while they are being filled.
+
+typedef enum {
+    GFX_3D_ARENA_CMD_PRIMS,
+    GFX_3D_ARENA_CMD_SELECT_TEXTURE,
+    GFX_3D_ARENA_CMD_SET_PRIM_TYPE,
+    GFX_3D_ARENA_CMD_SET_TEXTURE_FILTER,
+    GFX_3D_ARENA_CMD_SET_DEPTH_TEST,
+    GFX_3D_ARENA_CMD_SET_BLENDING_MODE,
+    GFX_3D_ARENA_CMD_SET_TEXTURING,
+} GFX_3D_ARENA_CMD_TYPE;
+
+typedef struct {
+    GFX_3D_ARENA_CMD_TYPE type;
+    union {
+        // GFX_3D_ARENA_CMD_PRIMS: a range of vertices in the arena
+        struct {
+            size_t first;
+            size_t count;
+        } prims;
+        // state changes: the value passed to the matching renderer setter
+        int32_t value;
+    };
+} GFX_3D_ARENA_CMD;
+
+typedef struct {
+    GFX_3D_PRIM_TYPE prim_type;
+    struct {
+        GFX_3D_VERTEX *data;
+        size_t count;
+        size_t capacity;
+    } vertices;
+    struct {
+        GFX_3D_ARENA_CMD *data;
+        size_t count;
+        size_t capacity;
+    } commands;
+} GFX_3D_VERTEX_ARENA;
+
+void GFX_3D_VertexArena_Init(GFX_3D_VERTEX_ARENA *arena);
+void GFX_3D_VertexArena_Close(GFX_3D_VERTEX_ARENA *arena);
+
+// Forgets the recorded contents but keeps the memory for the next frame.
+void GFX_3D_VertexArena_Reset(GFX_3D_VERTEX_ARENA *arena);
+
+bool GFX_3D_VertexArena_PushPrimStrip(
+    GFX_3D_VERTEX_ARENA *arena, const GFX_3D_VERTEX *vertices, int count);
+bool GFX_3D_VertexArena_PushPrimFan(
+    GFX_3D_VERTEX_ARENA *arena, const GFX_3D_VERTEX *vertices, int count);
+bool GFX_3D_VertexArena_PushPrimList(
+    GFX_3D_VERTEX_ARENA *arena, const GFX_3D_VERTEX *vertices, int count);
+
+// The arena assumes triangles until told otherwise, regardless of what the
+// renderer is set to when the arena is submitted.
+void GFX_3D_VertexArena_SetPrimType(
+    GFX_3D_VERTEX_ARENA *arena, GFX_3D_PRIM_TYPE prim_type);
+void GFX_3D_VertexArena_SelectTexture(
+    GFX_3D_VERTEX_ARENA *arena, int texture_num);
+void GFX_3D_VertexArena_SetTextureFilter(
+    GFX_3D_VERTEX_ARENA *arena, GFX_TEXTURE_FILTER filter);
+void GFX_3D_VertexArena_SetDepthTestEnabled(
+    GFX_3D_VERTEX_ARENA *arena, bool is_enabled);
+void GFX_3D_VertexArena_SetBlendingMode(
+    GFX_3D_VERTEX_ARENA *arena, GFX_BLEND_MODE blend_mode);
+void GFX_3D_VertexArena_SetTexturingEnabled(
+    GFX_3D_VERTEX_ARENA *arena, bool is_enabled);
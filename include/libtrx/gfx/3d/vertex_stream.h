@@ -5,12 +5,20 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 typedef enum {
     GFX_3D_PRIM_LINE = 0,
     GFX_3D_PRIM_TRI = 1,
 } GFX_3D_PRIM_TYPE;
 
+typedef enum {
+    GFX_3D_CULL_FACE_NONE,
+    // winding as seen on screen, with the y axis pointing down
+    GFX_3D_CULL_FACE_CW,
+    GFX_3D_CULL_FACE_CCW,
+} GFX_3D_CULL_FACE;
+
 typedef struct {
     float x, y, z;
     float s, t, w;
@@ -26,7 +34,30 @@ typedef struct {
         GFX_3D_VERTEX *data;
         size_t count;
         size_t capacity;
+        // the most vertices ever flushed at once
+        size_t high_water_mark;
     } pending_vertices;
+
+    struct {
+        bool cull_offscreen;
+        GFX_3D_CULL_FACE cull_face;
+        float left;
+        float top;
+        float right;
+        float bottom;
+        // reset by GFX_3D_VertexStream_ResetFrameStats
+        uint32_t frame_kept;
+        uint32_t frame_culled;
+    } culling;
+
+    // running totals, never reset by the stream itself
+    struct {
+        uint64_t draw_calls;
+        uint64_t vertices;
+        uint64_t uploaded_bytes;
+        uint64_t triangles_kept;
+        uint64_t triangles_culled;
+    } stats;
 } GFX_3D_VERTEX_STREAM;
 
 void GFX_3D_VertexStream_Init(GFX_3D_VERTEX_STREAM *vertex_stream);
@@ -37,6 +68,27 @@ void GFX_3D_VertexStream_Bind(GFX_3D_VERTEX_STREAM *vertex_stream);
 void GFX_3D_VertexStream_SetPrimType(
     GFX_3D_VERTEX_STREAM *vertex_stream, GFX_3D_PRIM_TYPE prim_type);
 
+// Drops triangles before they are queued: those entirely outside of the
+// given screen rectangle if cull_offscreen is set, and degenerate ones plus
+// those wound like cull_face otherwise. Only applies to the PushPrim*
+// functions in triangle mode.
+void GFX_3D_VertexStream_SetCulling(
+    GFX_3D_VERTEX_STREAM *vertex_stream, bool cull_offscreen,
+    GFX_3D_CULL_FACE cull_face);
+void GFX_3D_VertexStream_SetCullRect(
+    GFX_3D_VERTEX_STREAM *vertex_stream, float left, float top, float right,
+    float bottom);
+void GFX_3D_VertexStream_ResetFrameStats(GFX_3D_VERTEX_STREAM *vertex_stream);
+
+// Makes room for count more pending vertices.
+void GFX_3D_VertexStream_Reserve(
+    GFX_3D_VERTEX_STREAM *vertex_stream, size_t count);
+// Appends count uninitialized vertices and returns a pointer to the first one
+// for the caller to fill in. The pointer is valid until the next push or
+// flush.
+GFX_3D_VERTEX *GFX_3D_VertexStream_PushVertices(
+    GFX_3D_VERTEX_STREAM *vertex_stream, size_t count);
+
 bool GFX_3D_VertexStream_PushPrimStrip(
     GFX_3D_VERTEX_STREAM *vertex_stream, GFX_3D_VERTEX *vertices, int count);
 bool GFX_3D_VertexStream_PushPrimFan(
@@ -8,11 +8,24 @@ typedef enum {
     GFX_TF_NUMBER_OF,
 } GFX_TEXTURE_FILTER;
 
+typedef enum {
+    GFX_BLEND_MODE_OFF,
+    GFX_BLEND_MODE_NORMAL,
+    GFX_BLEND_MODE_MULTIPLY,
+} GFX_BLEND_MODE;
+
 typedef enum {
     GFX_RM_LEGACY,
     GFX_RM_FRAMEBUFFER,
 } GFX_RENDER_MODE;
 
+typedef enum {
+    // block right after presenting, before the next frame is simulated
+    GFX_FP_LATENCY,
+    // block only when the next frame is about to be presented
+    GFX_FP_THROUGHPUT,
+} GFX_FRAME_PACING;
+
 typedef enum {
     GFX_GL_21,
     GFX_GL_33C,
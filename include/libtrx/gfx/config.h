@@ -5,8 +5,27 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#define GFX_MAX_FRAMES_IN_FLIGHT 3
+#define GFX_MIN_RENDER_SCALE 0.25f
+#define GFX_MAX_RENDER_SCALE 1.0f
+
 typedef struct {
     GFX_TEXTURE_FILTER display_filter;
     bool enable_wireframe;
     int32_t line_width;
+    GFX_FRAME_PACING frame_pacing;
+    int32_t max_frames_in_flight;
+    bool enable_pbo_uploads;
+    // fraction of the display size the framebuffer renderer draws at; with
+    // dynamic resolution this is the upper bound
+    float render_scale;
+    // scales the resolution by the GPU time spent rendering, measured with
+    // timer queries; does nothing where those are not supported
+    bool enable_dynamic_resolution;
+    int32_t target_fps;
+    // refresh the environment map only every n-th time it is requested
+    int32_t env_map_interval;
+    // side of the environment map in pixels, 0 to match the rendered image
+    int32_t env_map_size;
+    bool enable_env_map_mipmaps;
 } GFX_CONFIG;
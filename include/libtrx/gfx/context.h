@@ -10,12 +10,23 @@
 
 void GFX_Context_Attach(void *window_handle);
 void GFX_Context_Detach(void);
+// Creates a hidden window of its own to render into, for tools that run
+// without a display such as benchmarks. The window is destroyed by
+// GFX_Context_Detach.
+bool GFX_Context_AttachHeadless(int32_t width, int32_t height);
 
 void GFX_Context_SetDisplayFilter(GFX_TEXTURE_FILTER filter);
 void GFX_Context_SetWireframeMode(bool enable);
 void GFX_Context_SetLineWidth(int32_t line_width);
 void GFX_Context_SetAnisotropyFilter(float value);
 void GFX_Context_SetVSync(bool vsync);
+void GFX_Context_SetFramePacing(GFX_FRAME_PACING frame_pacing);
+void GFX_Context_SetMaxFramesInFlight(int32_t max_frames_in_flight);
+void GFX_Context_SetPBOUploads(bool enable);
+void GFX_Context_SetRenderScale(float render_scale);
+void GFX_Context_SetDynamicResolution(bool enable, int32_t target_fps);
+void GFX_Context_SetEnvironmentMapQuality(
+    int32_t interval, int32_t size, bool enable_mipmaps);
 void GFX_Context_SetWindowSize(int32_t width, int32_t height);
 void GFX_Context_SetDisplaySize(int32_t width, int32_t height);
 void GFX_Context_SetRenderingMode(GFX_RENDER_MODE target_mode);
@@ -23,6 +34,12 @@ void GFX_Context_SetRenderingMode(GFX_RENDER_MODE target_mode);
 void *GFX_Context_GetWindowHandle(void);
 int32_t GFX_Context_GetDisplayWidth(void);
 int32_t GFX_Context_GetDisplayHeight(void);
+// The size actually rendered to, which differs from the display size when the
+// framebuffer renderer is scaled.
+int32_t GFX_Context_GetRenderWidth(void);
+int32_t GFX_Context_GetRenderHeight(void);
+float GFX_Context_GetRenderScale(void);
+bool GFX_Context_IsFenceSupported(void);
 
 void GFX_Context_Clear(void);
 void GFX_Context_SwapBuffers(void);
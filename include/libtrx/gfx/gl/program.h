@@ -4,9 +4,18 @@
 #include "../gl/gl_core_3_3.h"
 
 #include <stdbool.h>
+#include <stdint.h>
+
+#define GFX_GL_PROGRAM_MAX_SHADERS 2
 
 typedef struct {
     GLuint id;
+
+    // Attached shaders are only compiled by GFX_GL_Program_Link, and only if
+    // the program binary cache has no usable entry for them.
+    int32_t shader_count;
+    GLenum shader_types[GFX_GL_PROGRAM_MAX_SHADERS];
+    char *shader_sources[GFX_GL_PROGRAM_MAX_SHADERS];
 } GFX_GL_PROGRAM;
 
 bool GFX_GL_Program_Init(GFX_GL_PROGRAM *program);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "gl_core_3_3.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Shadow copy of the GL state touched by the renderers. Every setter compares
+// against the cached value and only reaches the driver on a real change;
+// getters answer from the cache so that no glGet* round trip is needed.
+
+#define GFX_GL_STATE_MAX_TEXTURE_UNITS 8
+
+typedef struct {
+    uint64_t issued;
+    uint64_t elided;
+} GFX_GL_STATE_STATS;
+
+// Forget everything and assume the driver defaults are unknown. Must be called
+// after creating a context and whenever GL state was changed behind the
+// cache's back.
+void GFX_GL_State_Reset(void);
+
+// When enabled, each elided call is cross-checked against the driver with
+// glGet* and mismatches are logged. Slow; meant for debugging only.
+void GFX_GL_State_SetValidation(bool enable);
+bool GFX_GL_State_IsValidationEnabled(void);
+
+const GFX_GL_STATE_STATS *GFX_GL_State_GetStats(void);
+void GFX_GL_State_ResetStats(void);
+
+void GFX_GL_State_UseProgram(GLuint program);
+void GFX_GL_State_BindVertexArray(GLuint array);
+void GFX_GL_State_BindBuffer(GLenum target, GLuint buffer);
+void GFX_GL_State_BindFramebuffer(GLenum target, GLuint framebuffer);
+GLuint GFX_GL_State_GetDrawFramebuffer(void);
+void GFX_GL_State_ActiveTexture(GLuint unit);
+void GFX_GL_State_BindTexture(GLenum target, GLuint texture);
+void GFX_GL_State_BindSampler(GLuint unit, GLuint sampler);
+
+void GFX_GL_State_SetEnabled(GLenum cap, bool enable);
+bool GFX_GL_State_IsEnabled(GLenum cap);
+void GFX_GL_State_PolygonMode(GLenum mode);
+void GFX_GL_State_BlendFunc(GLenum sfactor, GLenum dfactor);
+void GFX_GL_State_DepthFunc(GLenum func);
+void GFX_GL_State_DepthMask(GLboolean flag);
+void GFX_GL_State_LineWidth(GLfloat width);
+void GFX_GL_State_Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+void GFX_GL_State_GetViewport(GLint viewport[4]);
+
+// Object deletion hooks - drop any cached binding of the given name so that
+// a recycled name is not mistaken for the deleted object.
+void GFX_GL_State_ForgetProgram(GLuint program);
+void GFX_GL_State_ForgetVertexArray(GLuint array);
+void GFX_GL_State_ForgetBuffer(GLuint buffer);
+void GFX_GL_State_ForgetFramebuffer(GLuint framebuffer);
+void GFX_GL_State_ForgetTexture(GLuint texture);
+void GFX_GL_State_ForgetSampler(GLuint sampler);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "texture.h"
+
+#include <stdint.h>
+
+// Uploads many RGBA textures at once, such as the texture pages of a level.
+// Mipmaps are computed on worker threads while the calling thread streams
+// already finished textures to the GPU through a pixel unpack buffer, using
+// immutable storage where the driver supports it.
+typedef struct GFX_GL_TEXTURE_BATCH GFX_GL_TEXTURE_BATCH;
+
+GFX_GL_TEXTURE_BATCH *GFX_GL_TextureBatch_Create(void);
+
+// Queues a texture; data must stay valid until the batch is uploaded.
+void GFX_GL_TextureBatch_Add(
+    GFX_GL_TEXTURE_BATCH *batch, GFX_GL_TEXTURE *texture, const void *data,
+    int32_t width, int32_t height);
+
+// Uploads all queued textures, logs a timing breakdown and frees the batch.
+void GFX_GL_TextureBatch_Upload(GFX_GL_TEXTURE_BATCH *batch);
@@ -3,6 +3,8 @@
 #include "../../log.h"
 #include "../gl/gl_core_3_3.h"
 
+#include <stdbool.h>
+
 #define GFX_GL_CheckError()                                                    \
     {                                                                          \
         for (GLenum err; (err = glGetError()) != GL_NO_ERROR;) {               \
@@ -11,3 +13,4 @@
     }
 
 const char *GFX_GL_GetErrorString(GLenum err);
+bool GFX_GL_IsExtensionSupported(const char *name);
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// GPU timings are gathered with timestamp queries kept in a ring spanning
+// several frames, so results are read back only once the GPU has produced
+// them and the CPU never waits on the driver.
+
+typedef enum {
+    GFX_PROFILER_PASS_3D,
+    GFX_PROFILER_PASS_2D_UPLOAD,
+    GFX_PROFILER_PASS_2D,
+    GFX_PROFILER_PASS_FBO_BLIT,
+    GFX_PROFILER_PASS_ENV_MAP,
+    GFX_PROFILER_PASS_NUMBER_OF,
+} GFX_PROFILER_PASS;
+
+typedef struct {
+    // GPU time spent in the pass during the last resolved frame
+    double last_ms;
+    // exponential moving average of last_ms
+    double average_ms;
+    // number of times the pass ran during the last resolved frame
+    int32_t count;
+} GFX_PROFILER_PASS_STATS;
+
+typedef struct {
+    GFX_PROFILER_PASS_STATS passes[GFX_PROFILER_PASS_NUMBER_OF];
+    // GPU time between the ends of two consecutive frames
+    double frame_ms;
+    double frame_average_ms;
+    // GPU time spent in the passes of the last resolved frame, leaving out
+    // idle time between them
+    double work_ms;
+    // frames whose queries were still pending when their slot was reused
+    int32_t dropped_frames;
+} GFX_PROFILER_STATS;
+
+void GFX_Profiler_Init(void);
+void GFX_Profiler_Shutdown(void);
+
+bool GFX_Profiler_IsSupported(void);
+bool GFX_Profiler_IsEnabled(void);
+void GFX_Profiler_SetEnabled(bool enable);
+// Keeps sampling running for internal users such as dynamic resolution,
+// whether or not the profiler is enabled for display.
+void GFX_Profiler_SetRequired(bool require);
+
+// Passes may nest (the environment map copy happens inside the 3D pass) and
+// may run several times per frame, in which case their times add up.
+void GFX_Profiler_BeginPass(GFX_PROFILER_PASS pass);
+void GFX_Profiler_EndPass(GFX_PROFILER_PASS pass);
+
+// Closes the current frame and resolves the oldest frame in the ring if its
+// results are available. Called by GFX_Context_SwapBuffers.
+void GFX_Profiler_EndFrame(void);
+
+const GFX_PROFILER_STATS *GFX_Profiler_GetStats(void);
+const char *GFX_Profiler_GetPassName(GFX_PROFILER_PASS pass);
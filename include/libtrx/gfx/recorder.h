@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    // frames whose readback was started
+    int32_t captured;
+    // frames written to the video file
+    int32_t encoded;
+    // frames skipped because the readback slots or the queue were full
+    int32_t dropped;
+} GFX_RECORDER_STATS;
+
+// Starts recording every frame_interval-th rendered frame into a video file
+// played back at fps frames per second. Frames are read back asynchronously
+// and encoded on a background thread; when the encoder falls behind, frames
+// are dropped rather than stalling the game.
+bool GFX_Recorder_Start(const char *path, int32_t frame_interval, int32_t fps);
+
+// Encodes the frames still queued and finalizes the file.
+void GFX_Recorder_Stop(void);
+
+bool GFX_Recorder_IsRecording(void);
+GFX_RECORDER_STATS GFX_Recorder_GetStats(void);
+
+// Called by the renderers once per frame, right before presenting.
+void GFX_Recorder_CaptureFrame(void);
@@ -1,12 +1,38 @@
 #pragma once
 
+#include "../engine/image.h"
 #include "gl/gl_core_3_3.h"
 
 #include <stdbool.h>
 #include <stdint.h>
 
+// Receives a top-down image of a frame captured with
+// GFX_Screenshot_CaptureAsync. Called on the render thread; the callee takes
+// ownership of the image.
+typedef void (*GFX_SCREENSHOT_CALLBACK)(IMAGE *image, void *user_data);
+
 bool GFX_Screenshot_CaptureToFile(const char *path);
 
 void GFX_Screenshot_CaptureToBuffer(
     uint8_t *out_buffer, GLint *out_width, GLint *out_height, GLint depth,
     GLenum format, GLenum type, bool vflip);
+
+// Starts reading the current viewport into a pixel buffer object. The pixels
+// are collected by GFX_Screenshot_Update a frame or two later, once the GPU
+// has written them, so the render thread does not stall. Returns false if all
+// readback slots are busy.
+bool GFX_Screenshot_CaptureAsync(
+    GFX_SCREENSHOT_CALLBACK callback, void *user_data);
+
+// Like GFX_Screenshot_CaptureToFile, but the readback is asynchronous and
+// the encoding happens on a worker thread. Falls back to a synchronous
+// readback if no slot is free, so no capture is ever lost.
+bool GFX_Screenshot_CaptureToFileAsync(const char *path);
+
+// Collects finished readbacks. With wait set, blocks until all of them are
+// done. Called once per frame by GFX_Context_SwapBuffers.
+void GFX_Screenshot_Update(bool wait);
+
+// Completes outstanding captures, waits for the encoder thread and releases
+// the GL objects. Must be called while the GL context is still current.
+void GFX_Screenshot_Shutdown(void);
@@ -21,6 +21,16 @@ typedef enum {
     JSON_TYPE_NULL
 } JSON_TYPE;
 
+// Bump allocator that can hold an entire document, see JSON_ArenaNew.
+typedef struct JSON_ARENA JSON_ARENA;
+
+typedef struct {
+    size_t blocks;
+    size_t allocations;
+    size_t reserved;
+    size_t used;
+} JSON_ARENA_STATS;
+
 typedef struct {
     void *payload;
     size_t type;
@@ -40,10 +50,22 @@ typedef struct {
     size_t row_no;
 } JSON_STRING_EX;
 
+typedef enum {
+    // only the text is known and is parsed on every read
+    JSON_NUMBER_TYPE_TEXT = 0,
+    JSON_NUMBER_TYPE_INT,
+    JSON_NUMBER_TYPE_DOUBLE,
+} JSON_NUMBER_TYPE;
+
 typedef struct {
     char *number;
     size_t number_size;
     size_t ref_count;
+    JSON_NUMBER_TYPE type;
+    union {
+        int64_t int_value;
+        double double_value;
+    };
 } JSON_NUMBER;
 
 typedef struct JSON_OBJECT_ELEMENT {
@@ -53,10 +75,17 @@ typedef struct JSON_OBJECT_ELEMENT {
     size_t ref_count;
 } JSON_OBJECT_ELEMENT;
 
+typedef struct JSON_OBJECT_INDEX JSON_OBJECT_INDEX;
+
 typedef struct {
     JSON_OBJECT_ELEMENT *start;
     size_t length;
     size_t ref_count;
+    // hash table of the elements by key, built on the first lookup into a
+    // large enough object
+    JSON_OBJECT_INDEX *index;
+    // where appended nodes are allocated, NULL for the heap
+    JSON_ARENA *arena;
 } JSON_OBJECT;
 
 typedef struct JSON_ARRAY_ELEMENT {
@@ -69,6 +98,12 @@ typedef struct {
     JSON_ARRAY_ELEMENT *start;
     size_t length;
     size_t ref_count;
+    // the same elements in order, for constant time access by index; built
+    // on the first such access or append
+    JSON_ARRAY_ELEMENT **elements;
+    size_t elements_capacity;
+    // where appended nodes are allocated, NULL for the heap
+    JSON_ARENA *arena;
 } JSON_ARRAY;
 
 typedef struct {
@@ -78,11 +113,31 @@ typedef struct {
     size_t row_no;
 } JSON_VALUE_EX;
 
+// arenas
+// Objects and arrays created in an arena allocate everything appended to
+// them through the JSON_*Append* functions from the same arena, and the
+// whole document is released with a single JSON_ArenaFree. Nested objects
+// and arrays must be created in the same arena. Freeing the values with
+// JSON_ValueFree is allowed but not needed.
+JSON_ARENA *JSON_ArenaNew(void);
+void JSON_ArenaFree(JSON_ARENA *arena);
+void *JSON_ArenaAlloc(JSON_ARENA *arena, size_t size);
+JSON_ARENA_STATS JSON_ArenaGetStats(const JSON_ARENA *arena);
+
+JSON_OBJECT *JSON_ObjectNewInArena(JSON_ARENA *arena);
+JSON_ARRAY *JSON_ArrayNewInArena(JSON_ARENA *arena);
+
 // numbers
 JSON_NUMBER *JSON_NumberNewInt(int number);
 JSON_NUMBER *JSON_NumberNewInt64(int64_t number);
 JSON_NUMBER *JSON_NumberNewDouble(double number);
 void JSON_NumberFree(JSON_NUMBER *num);
+// Converts the text of a number to its binary value once, so that reading
+// it does not parse the text again.
+void JSON_NumberCacheValue(JSON_NUMBER *num);
+int JSON_NumberGetInt(const JSON_NUMBER *num);
+int64_t JSON_NumberGetInt64(const JSON_NUMBER *num);
+double JSON_NumberGetDouble(const JSON_NUMBER *num);
 
 // strings
 JSON_STRING *JSON_StringNew(const char *string);
@@ -128,6 +183,9 @@ void JSON_ObjectAppendObject(
 
 void JSON_ObjectEvictKey(JSON_OBJECT *obj, const char *key);
 
+// Builds the key index right away rather than on the first lookup.
+void JSON_ObjectBuildIndex(JSON_OBJECT *obj);
+
 JSON_VALUE *JSON_ObjectGetValue(JSON_OBJECT *obj, const char *key);
 int JSON_ObjectGetBool(JSON_OBJECT *obj, const char *key, int d);
 int JSON_ObjectGetInt(JSON_OBJECT *obj, const char *key, int d);
@@ -229,6 +287,14 @@ typedef enum {
     /* allow multi line string values. */
     JSON_PARSE_FLAGS_ALLOW_MULTI_LINE_STRINGS = 0x2000,
 
+    /* build the key index of every object while parsing, rather than on the
+       first lookup. */
+    JSON_PARSE_FLAGS_INDEX_OBJECTS = 0x4000,
+
+    /* convert numbers to their binary value while parsing, rather than on
+       every read. */
+    JSON_PARSE_FLAGS_CONVERT_NUMBERS = 0x8000,
+
     /* allow simplified JSON to be parsed. Simplified JSON is an enabling of a
        set of other parsing options. */
     JSON_PARSE_FLAGS_ALLOW_SIMPLIFIED_JSON =
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "bson.h"
+#include "json.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Pull parser reading JSON or BSON one token at a time, without building a
+// DOM. It accepts the same input as JSON_ParseEx and BSON_ParseEx, and keeps
+// a single scratch buffer for decoded strings, so reading allocates next to
+// nothing. Strings returned by the reader stay valid until the next call to
+// JSON_ReaderNext.
+typedef struct JSON_READER JSON_READER;
+
+typedef enum {
+    // the whole input was read
+    JSON_TOKEN_NONE = 0,
+    // the input is malformed; every following call returns this too
+    JSON_TOKEN_ERROR,
+    JSON_TOKEN_BEGIN_OBJECT,
+    JSON_TOKEN_END_OBJECT,
+    JSON_TOKEN_BEGIN_ARRAY,
+    JSON_TOKEN_END_ARRAY,
+    // the name of the next object member; the value is the next token
+    JSON_TOKEN_KEY,
+    JSON_TOKEN_STRING,
+    JSON_TOKEN_NUMBER,
+    JSON_TOKEN_TRUE,
+    JSON_TOKEN_FALSE,
+    JSON_TOKEN_NULL,
+} JSON_TOKEN;
+
+// The source must stay valid while the reader is in use.
+JSON_READER *JSON_ReaderNew(
+    const void *src, size_t src_size, size_t flags_bitset);
+JSON_READER *BSON_ReaderNew(const void *src, size_t src_size);
+void JSON_ReaderFree(JSON_READER *reader);
+
+JSON_TOKEN JSON_ReaderNext(JSON_READER *reader);
+JSON_TOKEN JSON_ReaderGetToken(const JSON_READER *reader);
+
+// Skips the value that the current token starts: a whole object or array
+// after JSON_TOKEN_BEGIN_*, or the member value after JSON_TOKEN_KEY.
+// Returns false if the input turned out to be malformed.
+bool JSON_ReaderSkip(JSON_READER *reader);
+
+// The getters return the default value d unless the current token has
+// a matching type.
+const char *JSON_ReaderGetString(
+    const JSON_READER *reader, const char *d, size_t *out_size);
+int JSON_ReaderGetBool(const JSON_READER *reader, int d);
+int JSON_ReaderGetInt(JSON_READER *reader, int d);
+int64_t JSON_ReaderGetInt64(JSON_READER *reader, int64_t d);
+double JSON_ReaderGetDouble(JSON_READER *reader, double d);
+
+void JSON_ReaderGetResult(const JSON_READER *reader, JSON_PARSE_RESULT *result);
+void BSON_ReaderGetResult(const JSON_READER *reader, BSON_PARSE_RESULT *result);
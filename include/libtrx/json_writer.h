@@ -0,0 +1,49 @@
+#pragma once
+
+#include "filesystem.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Streams JSON or BSON straight to its output without building a DOM first.
+// Containers are opened and closed with the Begin/End calls; inside objects
+// every value must be preceded by JSON_WriterKey. Misuse is caught with
+// asserts.
+typedef struct JSON_WRITER JSON_WRITER;
+
+typedef enum {
+    JSON_WRITER_FORMAT_JSON,
+    // two space indents and \n newlines, same as the config files
+    JSON_WRITER_FORMAT_JSON_PRETTY,
+    // the root must be an object or an array
+    JSON_WRITER_FORMAT_BSON,
+} JSON_WRITER_FORMAT;
+
+// Writes into a growable memory buffer, returned by JSON_WriterFinish.
+JSON_WRITER *JSON_WriterNew(JSON_WRITER_FORMAT format);
+
+// Writes into an open file, flushing whenever enough output is buffered.
+// BSON lengths that were already flushed are patched by seeking back.
+JSON_WRITER *JSON_WriterNewFile(JSON_WRITER_FORMAT format, MYFILE *file);
+
+void JSON_WriterBeginObject(JSON_WRITER *writer);
+void JSON_WriterEndObject(JSON_WRITER *writer);
+void JSON_WriterBeginArray(JSON_WRITER *writer);
+void JSON_WriterEndArray(JSON_WRITER *writer);
+void JSON_WriterKey(JSON_WRITER *writer, const char *key);
+
+void JSON_WriterNull(JSON_WRITER *writer);
+void JSON_WriterBool(JSON_WRITER *writer, bool value);
+void JSON_WriterInt(JSON_WRITER *writer, int32_t value);
+// BSON stores 32-bit integers only, like BSON_Write.
+void JSON_WriterInt64(JSON_WRITER *writer, int64_t value);
+void JSON_WriterDouble(JSON_WRITER *writer, double value);
+void JSON_WriterString(JSON_WRITER *writer, const char *value);
+
+// Frees the writer. For memory writers, returns the output, which JSON
+// formats also terminate with a null character not counted in out_size.
+// For file writers, flushes the rest of the output and returns NULL, with
+// out_size set to the total number of bytes written. The out_size parameter
+// is optional.
+void *JSON_WriterFinish(JSON_WRITER *writer, size_t *out_size);
@@ -1,20 +1,151 @@
 #include "config/common.h"
 
 #include "config/file.h"
+#include "log.h"
+#include "memory.h"
 
+#include <SDL2/SDL_error.h>
+#include <SDL2/SDL_mutex.h>
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_timer.h>
 #include <assert.h>
 
+// how long the settings must stay unchanged before they are written
+#define M_WRITE_DELAY_MS 500
+
+typedef struct {
+    bool is_dirty;
+    uint32_t dirty_ticks;
+
+    SDL_Thread *thread;
+    SDL_mutex *mutex;
+    SDL_cond *cond;
+    bool is_quitting;
+    // a dumped config waiting for the thread, and where it goes
+    char *pending_path;
+    JSON_VALUE *pending_root;
+    bool is_writing;
+    // set by the thread when a write changed the file
+    bool is_written;
+} M_WRITER;
+
 EVENT_MANAGER *m_EventManager = NULL;
+static M_WRITER m_Writer = { 0 };
+
+static void M_FireWriteEvent(void);
+static int M_WriterThread(void *arg);
+static void M_StartWriter(void);
+static void M_StopWriter(void);
+static void M_WaitForWriter(void);
+
+static void M_FireWriteEvent(void)
+{
+    if (m_EventManager != NULL) {
+        const EVENT event = {
+            .name = "write",
+            .sender = NULL,
+            .data = NULL,
+        };
+        EventManager_Fire(m_EventManager, &event);
+    }
+}
+
+static int M_WriterThread(void *const arg)
+{
+    SDL_LockMutex(m_Writer.mutex);
+    while (true) {
+        while (m_Writer.pending_root == NULL && !m_Writer.is_quitting) {
+            SDL_CondWait(m_Writer.cond, m_Writer.mutex);
+        }
+        if (m_Writer.pending_root == NULL) {
+            break;
+        }
+
+        char *path = m_Writer.pending_path;
+        JSON_VALUE *const root = m_Writer.pending_root;
+        m_Writer.pending_path = NULL;
+        m_Writer.pending_root = NULL;
+        m_Writer.is_writing = true;
+        SDL_UnlockMutex(m_Writer.mutex);
+
+        const bool updated = ConfigFile_WriteDump(path, root);
+        Memory_FreePointer(&path);
+
+        SDL_LockMutex(m_Writer.mutex);
+        m_Writer.is_writing = false;
+        m_Writer.is_written |= updated;
+        SDL_CondBroadcast(m_Writer.cond);
+    }
+    SDL_UnlockMutex(m_Writer.mutex);
+    return 0;
+}
+
+static void M_StartWriter(void)
+{
+    m_Writer.is_quitting = false;
+    m_Writer.mutex = SDL_CreateMutex();
+    m_Writer.cond = SDL_CreateCond();
+    if (m_Writer.mutex != NULL && m_Writer.cond != NULL) {
+        m_Writer.thread = SDL_CreateThread(M_WriterThread, "config", NULL);
+    }
+    if (m_Writer.thread == NULL) {
+        // writes fall back to the calling thread
+        LOG_ERROR("Failed to start config writer thread: %s", SDL_GetError());
+        M_StopWriter();
+    }
+}
+
+static void M_StopWriter(void)
+{
+    if (m_Writer.thread != NULL) {
+        SDL_LockMutex(m_Writer.mutex);
+        m_Writer.is_quitting = true;
+        SDL_CondBroadcast(m_Writer.cond);
+        SDL_UnlockMutex(m_Writer.mutex);
+        SDL_WaitThread(m_Writer.thread, NULL);
+        m_Writer.thread = NULL;
+    }
+    if (m_Writer.cond != NULL) {
+        SDL_DestroyCond(m_Writer.cond);
+        m_Writer.cond = NULL;
+    }
+    if (m_Writer.mutex != NULL) {
+        SDL_DestroyMutex(m_Writer.mutex);
+        m_Writer.mutex = NULL;
+    }
+}
+
+static void M_WaitForWriter(void)
+{
+    if (m_Writer.thread == NULL) {
+        return;
+    }
+    SDL_LockMutex(m_Writer.mutex);
+    while (m_Writer.pending_root != NULL || m_Writer.is_writing) {
+        SDL_CondWait(m_Writer.cond, m_Writer.mutex);
+    }
+    SDL_UnlockMutex(m_Writer.mutex);
+}
 
 void Config_Init(void)
 {
     m_EventManager = EventManager_Create();
+    M_StartWriter();
 }
 
 void Config_Shutdown(void)
 {
+    // the thread finishes the write it has been given first
+    M_StopWriter();
+    if (m_Writer.is_dirty) {
+        m_Writer.is_dirty = false;
+        Config_Sanitize();
+        ConfigFile_Write(Config_GetPath(), &Config_DumpToJSON);
+    }
+
     EventManager_Free(m_EventManager);
     m_EventManager = NULL;
+    ConfigOption_Shutdown();
 }
 
 bool Config_Read(void)
@@ -29,22 +160,71 @@ bool Config_Read(void)
 
 bool Config_Write(void)
 {
+    // keep the writes in order
+    M_WaitForWriter();
+    m_Writer.is_dirty = false;
+
     Config_Sanitize();
     const bool updated = ConfigFile_Write(Config_GetPath(), &Config_DumpToJSON);
     if (updated) {
         Config_ApplyChanges();
-        if (m_EventManager != NULL) {
-            const EVENT event = {
-                .name = "write",
-                .sender = NULL,
-                .data = NULL,
-            };
-            EventManager_Fire(m_EventManager, &event);
-        }
+        M_FireWriteEvent();
     }
     return updated;
 }
 
+void Config_MarkDirty(void)
+{
+    m_Writer.is_dirty = true;
+    m_Writer.dirty_ticks = SDL_GetTicks();
+}
+
+bool Config_IsDirty(void)
+{
+    return m_Writer.is_dirty;
+}
+
+void Config_Update(void)
+{
+    bool is_busy = false;
+    bool is_written = false;
+    if (m_Writer.thread != NULL) {
+        SDL_LockMutex(m_Writer.mutex);
+        is_busy = m_Writer.pending_root != NULL || m_Writer.is_writing;
+        is_written = m_Writer.is_written;
+        m_Writer.is_written = false;
+        SDL_UnlockMutex(m_Writer.mutex);
+    }
+
+    if (is_written) {
+        M_FireWriteEvent();
+    }
+
+    if (!m_Writer.is_dirty || is_busy
+        || SDL_GetTicks() - m_Writer.dirty_ticks < M_WRITE_DELAY_MS) {
+        return;
+    }
+
+    // the dump callbacks read live game state, so only they run here; the
+    // tree they build is serialized, compared and written by the thread
+    m_Writer.is_dirty = false;
+    LOG_INFO("Saving user settings");
+    JSON_VALUE *const root = ConfigFile_Dump(&Config_DumpToJSON);
+
+    if (m_Writer.thread == NULL) {
+        if (ConfigFile_WriteDump(Config_GetPath(), root)) {
+            M_FireWriteEvent();
+        }
+        return;
+    }
+
+    SDL_LockMutex(m_Writer.mutex);
+    m_Writer.pending_path = Memory_DupStr(Config_GetPath());
+    m_Writer.pending_root = root;
+    SDL_CondSignal(m_Writer.cond);
+    SDL_UnlockMutex(m_Writer.mutex);
+}
+
 int32_t Config_SubscribeChanges(
     const EVENT_LISTENER listener, void *const user_data)
 {
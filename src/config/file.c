@@ -3,13 +3,21 @@
 #include "filesystem.h"
 #include "log.h"
 #include "memory.h"
+#include "utils.h"
 
 #include <string.h>
 
 static bool M_ReadFromJSON(
     const char *json, void (*load)(JSON_OBJECT *root_obj));
-static char *M_WriteToJSON(void (*dump)(JSON_OBJECT *root_obj));
 static const char *M_ResolveOptionName(const char *option_name);
+static int M_FindEnumValue(
+    const char *value_str, int default_value, const ENUM_STRING_MAP *enum_map);
+static void M_LoadDefaults(const CONFIG_OPTION *options);
+static bool *M_NewBoundFlags(const CONFIG_OPTION *options);
+static const CONFIG_OPTION *M_FindOption(
+    const CONFIG_OPTION *options, const CONFIG_OPTION *prev, const char *name);
+static void M_LoadOption(JSON_VALUE *value, const CONFIG_OPTION *opt);
+static void M_ReadOption(JSON_READER *reader, const CONFIG_OPTION *opt);
 
 static bool M_ReadFromJSON(
     const char *cfg_data, void (*load)(JSON_OBJECT *root_obj))
@@ -40,27 +48,155 @@ static bool M_ReadFromJSON(
     return result;
 }
 
-static char *M_WriteToJSON(void (*dump)(JSON_OBJECT *root_obj))
+static const char *M_ResolveOptionName(const char *option_name)
 {
-    JSON_OBJECT *root_obj = JSON_ObjectNew();
+    const char *dot = strrchr(option_name, '.');
+    if (dot) {
+        return dot + 1;
+    }
+    return option_name;
+}
 
-    dump(root_obj);
+static int M_FindEnumValue(
+    const char *const value_str, const int default_value,
+    const ENUM_STRING_MAP *enum_map)
+{
+    if (value_str) {
+        while (enum_map->text) {
+            if (!strcmp(value_str, enum_map->text)) {
+                return enum_map->value;
+            }
+            enum_map++;
+        }
+    }
+    return default_value;
+}
 
-    JSON_VALUE *root = JSON_ValueFromObject(root_obj);
-    size_t size;
-    char *data = JSON_WritePretty(root, "  ", "\n", &size);
-    JSON_ValueFree(root);
+static void M_LoadDefaults(const CONFIG_OPTION *options)
+{
+    const CONFIG_OPTION *opt = options;
+    while (opt->target) {
+        switch (opt->type) {
+        case COT_BOOL:
+            *(bool *)opt->target = *(bool *)opt->default_value;
+            break;
+
+        case COT_INT32:
+            *(int32_t *)opt->target = *(int32_t *)opt->default_value;
+            break;
+
+        case COT_FLOAT:
+            *(float *)opt->target = *(float *)opt->default_value;
+            break;
 
-    return data;
+        case COT_DOUBLE:
+            *(double *)opt->target = *(double *)opt->default_value;
+            break;
+
+        case COT_ENUM:
+            *(int *)opt->target = *(int *)opt->default_value;
+            break;
+        }
+        opt++;
+    }
 }
 
-static const char *M_ResolveOptionName(const char *option_name)
+static bool *M_NewBoundFlags(const CONFIG_OPTION *const options)
 {
-    const char *dot = strrchr(option_name, '.');
-    if (dot) {
-        return dot + 1;
+    size_t count = 0;
+    for (const CONFIG_OPTION *opt = options; opt->target; opt++) {
+        count++;
+    }
+    return Memory_Alloc(MAX(count, 1u) * sizeof(bool));
+}
+
+static const CONFIG_OPTION *M_FindOption(
+    const CONFIG_OPTION *const options, const CONFIG_OPTION *const prev,
+    const char *const name)
+{
+    // the index is lenient about '-' and '_', config files are not
+    const CONFIG_OPTION *opt = prev == NULL
+        ? ConfigOption_Find(options, name)
+        : ConfigOption_FindNext(options, prev);
+    while (opt != NULL && strcmp(M_ResolveOptionName(opt->name), name)) {
+        opt = ConfigOption_FindNext(options, opt);
+    }
+    return opt;
+}
+
+static void M_LoadOption(
+    JSON_VALUE *const value, const CONFIG_OPTION *const opt)
+{
+    // values of the wrong type keep the default, like JSON_ObjectGet*
+    JSON_NUMBER *const num = JSON_ValueAsNumber(value);
+    switch (opt->type) {
+    case COT_BOOL:
+        if (JSON_ValueIsTrue(value)) {
+            *(bool *)opt->target = true;
+        } else if (JSON_ValueIsFalse(value)) {
+            *(bool *)opt->target = false;
+        }
+        break;
+
+    case COT_INT32:
+        if (num != NULL) {
+            *(int32_t *)opt->target = JSON_NumberGetInt(num);
+        }
+        break;
+
+    case COT_FLOAT:
+        if (num != NULL) {
+            *(float *)opt->target = JSON_NumberGetDouble(num);
+        }
+        break;
+
+    case COT_DOUBLE:
+        if (num != NULL) {
+            *(double *)opt->target = JSON_NumberGetDouble(num);
+        }
+        break;
+
+    case COT_ENUM: {
+        JSON_STRING *const str = JSON_ValueAsString(value);
+        *(int *)opt->target = M_FindEnumValue(
+            str != NULL ? str->string : NULL, *(int *)opt->target,
+            (const ENUM_STRING_MAP *)opt->param);
+        break;
+    }
+    }
+}
+
+static void M_ReadOption(
+    JSON_READER *const reader, const CONFIG_OPTION *const opt)
+{
+    // values of the wrong type keep the default, like JSON_ObjectGet*
+    switch (opt->type) {
+    case COT_BOOL:
+        *(bool *)opt->target = JSON_ReaderGetBool(
+            reader, *(bool *)opt->default_value);
+        break;
+
+    case COT_INT32:
+        *(int32_t *)opt->target = JSON_ReaderGetInt(
+            reader, *(int32_t *)opt->default_value);
+        break;
+
+    case COT_FLOAT:
+        *(float *)opt->target = JSON_ReaderGetDouble(
+            reader, *(float *)opt->default_value);
+        break;
+
+    case COT_DOUBLE:
+        *(double *)opt->target = JSON_ReaderGetDouble(
+            reader, *(double *)opt->default_value);
+        break;
+
+    case COT_ENUM:
+        *(int *)opt->target = M_FindEnumValue(
+            JSON_ReaderGetString(reader, NULL, NULL),
+            *(int *)opt->default_value, (const ENUM_STRING_MAP *)opt->param);
+        break;
     }
-    return option_name;
 }
 
 bool ConfigFile_Read(const char *path, void (*load)(JSON_OBJECT *root_obj))
@@ -79,15 +215,58 @@ bool ConfigFile_Read(const char *path, void (*load)(JSON_OBJECT *root_obj))
     return result;
 }
 
-bool ConfigFile_Write(const char *path, void (*dump)(JSON_OBJECT *root_obj))
+bool ConfigFile_ReadStream(
+    const char *const path, void (*load)(JSON_READER *reader))
 {
-    LOG_INFO("Saving user settings");
+    char *cfg_data = NULL;
+    if (!File_Load(path, &cfg_data, NULL)) {
+        LOG_WARNING("'%s' not loaded - default settings will apply", path);
+    }
+
+    const char *const data = cfg_data != NULL ? cfg_data : "{}";
+    JSON_READER *const reader =
+        JSON_ReaderNew(data, strlen(data), JSON_PARSE_FLAGS_ALLOW_JSON5);
+    load(reader);
+
+    JSON_PARSE_RESULT parse_result;
+    JSON_ReaderGetResult(reader, &parse_result);
+    const bool result = parse_result.error == JSON_PARSE_ERROR_NONE;
+    if (!result) {
+        LOG_ERROR(
+            "failed to parse config file: %s in line %d, char %d",
+            JSON_GetErrorDescription(parse_result.error),
+            parse_result.error_line_no, parse_result.error_row_no);
+    }
 
+    JSON_ReaderFree(reader);
+    Memory_FreePointer(&cfg_data);
+    return result;
+}
+
+JSON_VALUE *ConfigFile_Dump(void (*dump)(JSON_OBJECT *root_obj))
+{
+    JSON_OBJECT *root_obj = JSON_ObjectNew();
+    dump(root_obj);
+    return JSON_ValueFromObject(root_obj);
+}
+
+bool ConfigFile_WriteDump(const char *const path, JSON_VALUE *const root)
+{
+    size_t size;
+    char *data = JSON_WritePretty(root, "  ", "\n", &size);
+    JSON_ValueFree(root);
+
+    const bool updated = ConfigFile_WriteData(path, data);
+    Memory_FreePointer(&data);
+    return updated;
+}
+
+bool ConfigFile_WriteData(const char *const path, const char *const data)
+{
     char *old_data;
     File_Load(path, &old_data, NULL);
 
     bool updated = false;
-    char *data = M_WriteToJSON(dump);
     if (old_data == NULL || strcmp(data, old_data) != 0) {
         MYFILE *const fp = File_Open(path, FILE_OPEN_WRITE);
         if (fp == NULL) {
@@ -99,80 +278,172 @@ bool ConfigFile_Write(const char *path, void (*dump)(JSON_OBJECT *root_obj))
         }
     }
 
+    Memory_FreePointer(&old_data);
+    return updated;
+}
+
+bool ConfigFile_Write(const char *path, void (*dump)(JSON_OBJECT *root_obj))
+{
+    LOG_INFO("Saving user settings");
+
+    return ConfigFile_WriteDump(path, ConfigFile_Dump(dump));
+}
+
+bool ConfigFile_WriteStream(
+    const char *path, void (*dump)(JSON_WRITER *writer))
+{
+    LOG_INFO("Saving user settings");
+
+    JSON_WRITER *const writer = JSON_WriterNew(JSON_WRITER_FORMAT_JSON_PRETTY);
+    JSON_WriterBeginObject(writer);
+    dump(writer);
+    JSON_WriterEndObject(writer);
+
+    char *data = JSON_WriterFinish(writer, NULL);
+    const bool updated = ConfigFile_WriteData(path, data);
     Memory_FreePointer(&data);
     return updated;
 }
 
 void ConfigFile_LoadOptions(JSON_OBJECT *root_obj, const CONFIG_OPTION *options)
+{
+    M_LoadDefaults(options);
+    if (root_obj == NULL) {
+        return;
+    }
+
+    // bind the keys in a single pass; the first of duplicate keys wins, like
+    // in JSON_ObjectGet*, and every option with that key gets the value
+    bool *is_bound = M_NewBoundFlags(options);
+    for (JSON_OBJECT_ELEMENT *elem = root_obj->start; elem != NULL;
+         elem = elem->next) {
+        const char *const name = elem->name->string;
+        for (const CONFIG_OPTION *opt = M_FindOption(options, NULL, name);
+             opt != NULL; opt = M_FindOption(options, opt, name)) {
+            if (!is_bound[opt - options]) {
+                is_bound[opt - options] = true;
+                M_LoadOption(elem->value, opt);
+            }
+        }
+    }
+    Memory_FreePointer(&is_bound);
+}
+
+void ConfigFile_LoadOptionsStream(
+    JSON_READER *const reader, const CONFIG_OPTION *const options)
+{
+    M_LoadDefaults(options);
+
+    JSON_TOKEN token = JSON_ReaderNext(reader);
+    if (token != JSON_TOKEN_BEGIN_OBJECT) {
+        return;
+    }
+
+    bool *is_bound = M_NewBoundFlags(options);
+    while ((token = JSON_ReaderNext(reader)) == JSON_TOKEN_KEY) {
+        // options sharing a key are always bound together
+        const CONFIG_OPTION *const first = M_FindOption(
+            options, NULL, JSON_ReaderGetString(reader, "", NULL));
+        if (first == NULL || is_bound[first - options]) {
+            if (!JSON_ReaderSkip(reader)) {
+                break;
+            }
+            continue;
+        }
+
+        // the key string does not outlive the next token
+        const char *const name = M_ResolveOptionName(first->name);
+        token = JSON_ReaderNext(reader);
+        const bool is_scalar = token != JSON_TOKEN_BEGIN_OBJECT
+            && token != JSON_TOKEN_BEGIN_ARRAY;
+        for (const CONFIG_OPTION *opt = first; opt != NULL;
+             opt = M_FindOption(options, opt, name)) {
+            is_bound[opt - options] = true;
+            if (is_scalar) {
+                M_ReadOption(reader, opt);
+            }
+        }
+        if (!is_scalar && !JSON_ReaderSkip(reader)) {
+            break;
+        }
+    }
+
+    Memory_FreePointer(&is_bound);
+
+    // the whole document must be valid, same as for ConfigFile_Read
+    if (token != JSON_TOKEN_END_OBJECT
+        || JSON_ReaderNext(reader) != JSON_TOKEN_NONE) {
+        M_LoadDefaults(options);
+    }
+}
+
+void ConfigFile_DumpOptions(JSON_OBJECT *root_obj, const CONFIG_OPTION *options)
 {
     const CONFIG_OPTION *opt = options;
     while (opt->target) {
         switch (opt->type) {
         case COT_BOOL:
-            *(bool *)opt->target = JSON_ObjectGetBool(
-                root_obj, M_ResolveOptionName(opt->name),
-                *(bool *)opt->default_value);
+            JSON_ObjectAppendBool(
+                root_obj, M_ResolveOptionName(opt->name), *(bool *)opt->target);
             break;
 
         case COT_INT32:
-            *(int32_t *)opt->target = JSON_ObjectGetInt(
+            JSON_ObjectAppendInt(
                 root_obj, M_ResolveOptionName(opt->name),
-                *(int32_t *)opt->default_value);
+                *(int32_t *)opt->target);
             break;
 
         case COT_FLOAT:
-            *(float *)opt->target = JSON_ObjectGetDouble(
+            JSON_ObjectAppendDouble(
                 root_obj, M_ResolveOptionName(opt->name),
-                *(float *)opt->default_value);
+                *(float *)opt->target);
             break;
 
         case COT_DOUBLE:
-            *(double *)opt->target = JSON_ObjectGetDouble(
+            JSON_ObjectAppendDouble(
                 root_obj, M_ResolveOptionName(opt->name),
-                *(double *)opt->default_value);
+                *(double *)opt->target);
             break;
 
         case COT_ENUM:
-            *(int *)opt->target = ConfigFile_ReadEnum(
-                root_obj, M_ResolveOptionName(opt->name),
-                *(int *)opt->default_value,
+            ConfigFile_WriteEnum(
+                root_obj, M_ResolveOptionName(opt->name), *(int *)opt->target,
                 (const ENUM_STRING_MAP *)opt->param);
+            break;
         }
         opt++;
     }
 }
 
-void ConfigFile_DumpOptions(JSON_OBJECT *root_obj, const CONFIG_OPTION *options)
+void ConfigFile_StreamOptions(
+    JSON_WRITER *const writer, const CONFIG_OPTION *options)
 {
     const CONFIG_OPTION *opt = options;
     while (opt->target) {
         switch (opt->type) {
         case COT_BOOL:
-            JSON_ObjectAppendBool(
-                root_obj, M_ResolveOptionName(opt->name), *(bool *)opt->target);
+            JSON_WriterKey(writer, M_ResolveOptionName(opt->name));
+            JSON_WriterBool(writer, *(bool *)opt->target);
             break;
 
         case COT_INT32:
-            JSON_ObjectAppendInt(
-                root_obj, M_ResolveOptionName(opt->name),
-                *(int32_t *)opt->target);
+            JSON_WriterKey(writer, M_ResolveOptionName(opt->name));
+            JSON_WriterInt(writer, *(int32_t *)opt->target);
             break;
 
         case COT_FLOAT:
-            JSON_ObjectAppendDouble(
-                root_obj, M_ResolveOptionName(opt->name),
-                *(float *)opt->target);
+            JSON_WriterKey(writer, M_ResolveOptionName(opt->name));
+            JSON_WriterDouble(writer, *(float *)opt->target);
             break;
 
         case COT_DOUBLE:
-            JSON_ObjectAppendDouble(
-                root_obj, M_ResolveOptionName(opt->name),
-                *(double *)opt->target);
+            JSON_WriterKey(writer, M_ResolveOptionName(opt->name));
+            JSON_WriterDouble(writer, *(double *)opt->target);
             break;
 
         case COT_ENUM:
-            ConfigFile_WriteEnum(
-                root_obj, M_ResolveOptionName(opt->name), *(int *)opt->target,
+            ConfigFile_StreamEnum(
+                writer, M_ResolveOptionName(opt->name), *(int *)opt->target,
                 (const ENUM_STRING_MAP *)opt->param);
             break;
         }
@@ -184,16 +455,8 @@ int ConfigFile_ReadEnum(
     JSON_OBJECT *obj, const char *name, int default_value,
     const ENUM_STRING_MAP *enum_map)
 {
-    const char *value_str = JSON_ObjectGetString(obj, name, NULL);
-    if (value_str) {
-        while (enum_map->text) {
-            if (!strcmp(value_str, enum_map->text)) {
-                return enum_map->value;
-            }
-            enum_map++;
-        }
-    }
-    return default_value;
+    return M_FindEnumValue(
+        JSON_ObjectGetString(obj, name, NULL), default_value, enum_map);
 }
 
 void ConfigFile_WriteEnum(
@@ -208,3 +471,17 @@ void ConfigFile_WriteEnum(
         enum_map++;
     }
 }
+
+void ConfigFile_StreamEnum(
+    JSON_WRITER *const writer, const char *const name, const int value,
+    const ENUM_STRING_MAP *enum_map)
+{
+    while (enum_map->text) {
+        if (enum_map->value == value) {
+            JSON_WriterKey(writer, name);
+            JSON_WriterString(writer, enum_map->text);
+            break;
+        }
+        enum_map++;
+    }
+}
@@ -0,0 +1,147 @@
+#include "config/option.h"
+
+#include "memory.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define M_INDEX_MIN_CAPACITY 16
+
+typedef struct {
+    // the option map that the index was built for
+    const CONFIG_OPTION *options;
+    // a power of two, at least twice the number of options
+    size_t capacity;
+    uint32_t *hashes;
+    const CONFIG_OPTION **slots;
+    // per option, the next one in the map with the same key
+    const CONFIG_OPTION **next;
+} M_INDEX;
+
+static M_INDEX m_Index = { 0 };
+
+static const char *M_ResolveName(const char *name);
+static char M_NormalizeChar(char c);
+static uint32_t M_HashKey(const char *key);
+static bool M_SameKey(const char *key1, const char *key2);
+static void M_Insert(const CONFIG_OPTION *option);
+static void M_Build(const CONFIG_OPTION *options);
+
+static const char *M_ResolveName(const char *const name)
+{
+    const char *const dot = strrchr(name, '.');
+    return dot != NULL ? dot + 1 : name;
+}
+
+static char M_NormalizeChar(const char c)
+{
+    return c == '_' ? '-' : c;
+}
+
+static uint32_t M_HashKey(const char *key)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    while (*key) {
+        hash ^= (uint8_t)M_NormalizeChar(*key++);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool M_SameKey(const char *key1, const char *key2)
+{
+    while (*key1 && M_NormalizeChar(*key1) == M_NormalizeChar(*key2)) {
+        key1++;
+        key2++;
+    }
+    return *key1 == *key2;
+}
+
+static void M_Insert(const CONFIG_OPTION *const option)
+{
+    const char *const key = M_ResolveName(option->name);
+    const uint32_t hash = M_HashKey(key);
+    const size_t mask = m_Index.capacity - 1;
+    size_t i = hash & mask;
+    while (m_Index.slots[i] != NULL) {
+        // options sharing a key are chained in map order
+        if (m_Index.hashes[i] == hash
+            && M_SameKey(M_ResolveName(m_Index.slots[i]->name), key)) {
+            const CONFIG_OPTION *last = m_Index.slots[i];
+            while (m_Index.next[last - m_Index.options] != NULL) {
+                last = m_Index.next[last - m_Index.options];
+            }
+            m_Index.next[last - m_Index.options] = option;
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+    m_Index.hashes[i] = hash;
+    m_Index.slots[i] = option;
+}
+
+static void M_Build(const CONFIG_OPTION *const options)
+{
+    ConfigOption_Shutdown();
+
+    size_t count = 0;
+    for (const CONFIG_OPTION *option = options; option->name != NULL;
+         option++) {
+        count++;
+    }
+
+    m_Index.options = options;
+    m_Index.capacity = M_INDEX_MIN_CAPACITY;
+    while (m_Index.capacity < count * 2) {
+        m_Index.capacity *= 2;
+    }
+    m_Index.hashes = Memory_Alloc(sizeof(uint32_t) * m_Index.capacity);
+    m_Index.slots =
+        Memory_Alloc(sizeof(const CONFIG_OPTION *) * m_Index.capacity);
+    m_Index.next = Memory_Alloc(sizeof(const CONFIG_OPTION *) * (count + 1));
+
+    for (const CONFIG_OPTION *option = options; option->name != NULL;
+         option++) {
+        M_Insert(option);
+    }
+}
+
+const CONFIG_OPTION *ConfigOption_Find(
+    const CONFIG_OPTION *const options, const char *const key)
+{
+    if (m_Index.options != options) {
+        M_Build(options);
+    }
+
+    const uint32_t hash = M_HashKey(key);
+    const size_t mask = m_Index.capacity - 1;
+    size_t i = hash & mask;
+    while (m_Index.slots[i] != NULL) {
+        if (m_Index.hashes[i] == hash
+            && M_SameKey(M_ResolveName(m_Index.slots[i]->name), key)) {
+            return m_Index.slots[i];
+        }
+        i = (i + 1) & mask;
+    }
+    return NULL;
+}
+
+const CONFIG_OPTION *ConfigOption_FindNext(
+    const CONFIG_OPTION *const options, const CONFIG_OPTION *const option)
+{
+    if (m_Index.options != options) {
+        M_Build(options);
+    }
+    return m_Index.next[option - options];
+}
+
+void ConfigOption_Shutdown(void)
+{
+    Memory_FreePointer(&m_Index.hashes);
+    Memory_FreePointer(&m_Index.slots);
+    Memory_FreePointer(&m_Index.next);
+    m_Index.options = NULL;
+    m_Index.capacity = 0;
+}
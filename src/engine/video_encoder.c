@@ -0,0 +1,261 @@
+#include "engine/video_encoder.h"
+
+#include "filesystem.h"
+#include "log.h"
+#include "memory.h"
+#include "utils.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavformat/avio.h>
+#include <libavutil/avutil.h>
+#include <libavutil/error.h>
+#include <libavutil/frame.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixfmt.h>
+#include <libavutil/rational.h>
+#include <libswscale/swscale.h>
+#include <stdint.h>
+
+struct VIDEO_ENCODER {
+    AVFormatContext *format_ctx;
+    AVCodecContext *codec_ctx;
+    AVStream *stream;
+    AVFrame *frame;
+    AVPacket *packet;
+    struct SwsContext *sws_ctx;
+    int64_t next_pts;
+    bool is_header_written;
+};
+
+static const AVCodec *M_FindEncoder(const AVOutputFormat *format);
+static int M_Encode(VIDEO_ENCODER *encoder, const AVFrame *frame);
+static void M_Free(VIDEO_ENCODER *encoder);
+
+static const AVCodec *M_FindEncoder(const AVOutputFormat *const format)
+{
+    const AVCodec *codec = NULL;
+    if (format->video_codec != AV_CODEC_ID_NONE) {
+        codec = avcodec_find_encoder(format->video_codec);
+    }
+    if (codec == NULL) {
+        // always built into libavcodec, unlike H.264
+        codec = avcodec_find_encoder(AV_CODEC_ID_MPEG4);
+    }
+    return codec;
+}
+
+static int M_Encode(VIDEO_ENCODER *const encoder, const AVFrame *const frame)
+{
+    int error_code = avcodec_send_frame(encoder->codec_ctx, frame);
+    while (error_code >= 0) {
+        error_code =
+            avcodec_receive_packet(encoder->codec_ctx, encoder->packet);
+        if (error_code == AVERROR(EAGAIN) || error_code == AVERROR_EOF) {
+            return 0;
+        }
+        if (error_code < 0) {
+            break;
+        }
+
+        av_packet_rescale_ts(
+            encoder->packet, encoder->codec_ctx->time_base,
+            encoder->stream->time_base);
+        encoder->packet->stream_index = encoder->stream->index;
+        error_code =
+            av_interleaved_write_frame(encoder->format_ctx, encoder->packet);
+    }
+    return error_code;
+}
+
+static void M_Free(VIDEO_ENCODER *const encoder)
+{
+    if (encoder->sws_ctx != NULL) {
+        sws_freeContext(encoder->sws_ctx);
+    }
+    if (encoder->packet != NULL) {
+        av_packet_free(&encoder->packet);
+    }
+    if (encoder->frame != NULL) {
+        av_frame_free(&encoder->frame);
+    }
+    if (encoder->codec_ctx != NULL) {
+        avcodec_free_context(&encoder->codec_ctx);
+    }
+    if (encoder->format_ctx != NULL) {
+        if (encoder->format_ctx->pb != NULL
+            && !(encoder->format_ctx->oformat->flags & AVFMT_NOFILE)) {
+            avio_closep(&encoder->format_ctx->pb);
+        }
+        avformat_free_context(encoder->format_ctx);
+    }
+    Memory_Free(encoder);
+}
+
+VIDEO_ENCODER *VideoEncoder_Open(
+    const char *const path, const int32_t width, const int32_t height,
+    const int32_t fps)
+{
+    assert(path != NULL);
+    assert(width > 0);
+    assert(height > 0);
+    assert(fps > 0);
+
+    int error_code = 0;
+    char *full_path = File_GetFullPath(path);
+    VIDEO_ENCODER *encoder = Memory_Alloc(sizeof(VIDEO_ENCODER));
+
+    error_code = avformat_alloc_output_context2(
+        &encoder->format_ctx, NULL, NULL, full_path);
+    if (error_code < 0) {
+        error_code = avformat_alloc_output_context2(
+            &encoder->format_ctx, NULL, "matroska", full_path);
+        if (error_code < 0) {
+            goto cleanup;
+        }
+    }
+
+    const AVOutputFormat *const format = encoder->format_ctx->oformat;
+    const AVCodec *const codec = M_FindEncoder(format);
+    if (codec == NULL) {
+        error_code = AVERROR_ENCODER_NOT_FOUND;
+        goto cleanup;
+    }
+
+    encoder->stream = avformat_new_stream(encoder->format_ctx, NULL);
+    encoder->codec_ctx = avcodec_alloc_context3(codec);
+    if (encoder->stream == NULL || encoder->codec_ctx == NULL) {
+        error_code = AVERROR(ENOMEM);
+        goto cleanup;
+    }
+
+    AVCodecContext *const codec_ctx = encoder->codec_ctx;
+    // 4:2:0 chroma subsampling needs even dimensions
+    codec_ctx->width = MAX(2, width & ~1);
+    codec_ctx->height = MAX(2, height & ~1);
+    codec_ctx->time_base = (AVRational) { 1, fps };
+    codec_ctx->framerate = (AVRational) { fps, 1 };
+    codec_ctx->gop_size = fps;
+    codec_ctx->pix_fmt = codec->id == AV_CODEC_ID_MJPEG ? AV_PIX_FMT_YUVJ420P
+                                                        : AV_PIX_FMT_YUV420P;
+    codec_ctx->bit_rate =
+        (int64_t)codec_ctx->width * codec_ctx->height * fps / 8;
+    if (format->flags & AVFMT_GLOBALHEADER) {
+        codec_ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+    encoder->stream->time_base = codec_ctx->time_base;
+
+    error_code = avcodec_open2(codec_ctx, codec, NULL);
+    if (error_code < 0) {
+        goto cleanup;
+    }
+
+    error_code =
+        avcodec_parameters_from_context(encoder->stream->codecpar, codec_ctx);
+    if (error_code < 0) {
+        goto cleanup;
+    }
+
+    if (!(format->flags & AVFMT_NOFILE)) {
+        error_code =
+            avio_open(&encoder->format_ctx->pb, full_path, AVIO_FLAG_WRITE);
+        if (error_code < 0) {
+            goto cleanup;
+        }
+    }
+
+    error_code = avformat_write_header(encoder->format_ctx, NULL);
+    if (error_code < 0) {
+        goto cleanup;
+    }
+    encoder->is_header_written = true;
+
+    encoder->frame = av_frame_alloc();
+    encoder->packet = av_packet_alloc();
+    if (encoder->frame == NULL || encoder->packet == NULL) {
+        error_code = AVERROR(ENOMEM);
+        goto cleanup;
+    }
+    encoder->frame->format = codec_ctx->pix_fmt;
+    encoder->frame->width = codec_ctx->width;
+    encoder->frame->height = codec_ctx->height;
+    error_code = av_frame_get_buffer(encoder->frame, 0);
+    if (error_code < 0) {
+        goto cleanup;
+    }
+
+    LOG_INFO(
+        "Recording video to %s (%s, %dx%d @ %d fps)", path, codec->name,
+        codec_ctx->width, codec_ctx->height, fps);
+
+cleanup:
+    if (error_code < 0) {
+        LOG_ERROR(
+            "Error while opening video %s: %s", path, av_err2str(error_code));
+        M_Free(encoder);
+        encoder = NULL;
+    }
+    Memory_FreePointer(&full_path);
+    return encoder;
+}
+
+bool VideoEncoder_WriteFrame(
+    VIDEO_ENCODER *const encoder, const IMAGE *const image)
+{
+    assert(encoder != NULL);
+    assert(image != NULL);
+
+    AVFrame *const frame = encoder->frame;
+    encoder->sws_ctx = sws_getCachedContext(
+        encoder->sws_ctx, image->width, image->height, AV_PIX_FMT_RGB24,
+        frame->width, frame->height, frame->format, SWS_BILINEAR, NULL, NULL,
+        NULL);
+    if (encoder->sws_ctx == NULL) {
+        LOG_ERROR("Failed to get SWS context");
+        return false;
+    }
+
+    // the encoder may still reference the previous frame's buffers
+    int error_code = av_frame_make_writable(frame);
+    if (error_code < 0) {
+        LOG_ERROR("Error while encoding video: %s", av_err2str(error_code));
+        return false;
+    }
+
+    uint8_t *src_planes[4];
+    int src_linesize[4];
+    av_image_fill_arrays(
+        src_planes, src_linesize, (const uint8_t *)image->data,
+        AV_PIX_FMT_RGB24, image->width, image->height, 1);
+
+    sws_scale(
+        encoder->sws_ctx, (const uint8_t *const *)src_planes, src_linesize, 0,
+        image->height, frame->data, frame->linesize);
+
+    frame->pts = encoder->next_pts++;
+    error_code = M_Encode(encoder, frame);
+    if (error_code < 0) {
+        LOG_ERROR("Error while encoding video: %s", av_err2str(error_code));
+        return false;
+    }
+    return true;
+}
+
+void VideoEncoder_Close(VIDEO_ENCODER *const encoder)
+{
+    if (encoder == NULL) {
+        return;
+    }
+
+    if (encoder->is_header_written) {
+        const int error_code = M_Encode(encoder, NULL);
+        if (error_code < 0) {
+            LOG_ERROR(
+                "Error while flushing video: %s", av_err2str(error_code));
+        }
+        av_write_trailer(encoder->format_ctx);
+    }
+    M_Free(encoder);
+}
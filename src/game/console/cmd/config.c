@@ -11,7 +11,6 @@
 #include <string.h>
 
 static const char *M_Resolve(const char *option_name);
-static bool M_SameKey(const char *key1, const char *key2);
 static char *M_NormalizeKey(const char *key);
 
 static bool M_GetCurrentValue(
@@ -30,31 +29,6 @@ static const char *M_Resolve(const char *const option_name)
     return option_name;
 }
 
-static bool M_SameKey(const char *key1, const char *key2)
-{
-    key1 = M_Resolve(key1);
-    key2 = M_Resolve(key2);
-    const size_t len1 = strlen(key1);
-    const size_t len2 = strlen(key2);
-    if (len1 != len2) {
-        return false;
-    }
-    for (uint32_t i = 0; i < len1; i++) {
-        char c1 = key1[i];
-        char c2 = key2[i];
-        if (c1 == '_') {
-            c1 = '-';
-        }
-        if (c2 == '_') {
-            c2 = '-';
-        }
-        if (c1 != c2) {
-            return false;
-        }
-    }
-    return true;
-}
-
 static char *M_NormalizeKey(const char *key)
 {
     // TODO: Once we support arbitrary glyphs, this conversion should
@@ -191,14 +165,7 @@ cleanup:
 
 const CONFIG_OPTION *Console_Cmd_Config_GetOptionFromKey(const char *const key)
 {
-    for (const CONFIG_OPTION *option = Config_GetOptionMap();
-         option->name != NULL; option++) {
-        if (M_SameKey(option->name, key)) {
-            return option;
-        }
-    }
-
-    return NULL;
+    return ConfigOption_Find(Config_GetOptionMap(), M_Resolve(key));
 }
 
 const CONFIG_OPTION *Console_Cmd_Config_GetOptionFromTarget(
@@ -234,7 +201,9 @@ COMMAND_RESULT Console_Cmd_Config_Helper(
     }
 
     if (M_SetCurrentValue(option, new_value)) {
-        Config_Write();
+        Config_Sanitize();
+        Config_ApplyChanges();
+        Config_MarkDirty();
 
         char final_value[128];
         assert(M_GetCurrentValue(option, final_value, 128));
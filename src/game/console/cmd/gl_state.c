@@ -0,0 +1,35 @@
+#include "game/console/cmd/gl_state.h"
+
+#include "game/game_string.h"
+#include "gfx/gl/state.h"
+#include "strings.h"
+
+static COMMAND_RESULT M_Entrypoint(const COMMAND_CONTEXT *ctx);
+
+static COMMAND_RESULT M_Entrypoint(const COMMAND_CONTEXT *const ctx)
+{
+    bool enable;
+    if (String_ParseBool(ctx->args, &enable)) {
+        GFX_GL_State_SetValidation(enable);
+        Console_Log(
+            enable ? GS(OSD_GL_STATE_VALIDATION_ENABLED)
+                   : GS(OSD_GL_STATE_VALIDATION_DISABLED));
+        return CR_SUCCESS;
+    }
+
+    if (!String_IsEmpty(ctx->args)) {
+        return CR_BAD_INVOCATION;
+    }
+
+    // mismatches found by the validation go to the log file
+    const GFX_GL_STATE_STATS *const stats = GFX_GL_State_GetStats();
+    Console_Log(
+        GS(OSD_GL_STATE_STATS), (unsigned long long)stats->issued,
+        (unsigned long long)stats->elided);
+    return CR_SUCCESS;
+}
+
+CONSOLE_COMMAND g_Console_Cmd_GLState = {
+    .prefix = "glstate",
+    .proc = M_Entrypoint,
+};
@@ -0,0 +1,58 @@
+#include "game/console/cmd/gpu_profiler.h"
+
+#include "game/game_string.h"
+#include "gfx/profiler.h"
+#include "strings.h"
+
+static void M_LogStats(void);
+static COMMAND_RESULT M_Entrypoint(const COMMAND_CONTEXT *ctx);
+
+static void M_LogStats(void)
+{
+    const GFX_PROFILER_STATS *const stats = GFX_Profiler_GetStats();
+    Console_Log(
+        GS(OSD_GPU_PROFILER_FRAME), stats->frame_ms, stats->frame_average_ms);
+    for (int32_t i = 0; i < GFX_PROFILER_PASS_NUMBER_OF; i++) {
+        const GFX_PROFILER_PASS_STATS *const pass = &stats->passes[i];
+        Console_Log(
+            GS(OSD_GPU_PROFILER_PASS), GFX_Profiler_GetPassName(i),
+            pass->last_ms, pass->average_ms, pass->count);
+    }
+}
+
+static COMMAND_RESULT M_Entrypoint(const COMMAND_CONTEXT *const ctx)
+{
+    if (!GFX_Profiler_IsSupported()) {
+        Console_Log(GS(OSD_GPU_PROFILER_UNSUPPORTED));
+        return CR_UNAVAILABLE;
+    }
+
+    bool enable;
+    if (String_ParseBool(ctx->args, &enable)) {
+        GFX_Profiler_SetEnabled(enable);
+        Console_Log(
+            enable ? GS(OSD_GPU_PROFILER_ENABLED)
+                   : GS(OSD_GPU_PROFILER_DISABLED));
+        return CR_SUCCESS;
+    }
+
+    if (!String_IsEmpty(ctx->args)) {
+        return CR_BAD_INVOCATION;
+    }
+
+    // without arguments, the first call starts sampling and shows the
+    // overlay, and the following ones also copy the timings to the log
+    if (!GFX_Profiler_IsEnabled()) {
+        GFX_Profiler_SetEnabled(true);
+        Console_Log(GS(OSD_GPU_PROFILER_ENABLED));
+        return CR_SUCCESS;
+    }
+
+    M_LogStats();
+    return CR_SUCCESS;
+}
+
+CONSOLE_COMMAND g_Console_Cmd_GpuProfiler = {
+    .prefix = "gpuprof",
+    .proc = M_Entrypoint,
+};
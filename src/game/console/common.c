@@ -1,8 +1,10 @@
 #include "game/console/common.h"
 
 #include "./extern.h"
+#include "config/common.h"
 #include "game/game_string.h"
 #include "game/ui/widgets/console.h"
+#include "game/ui/widgets/gpu_profiler.h"
 #include "log.h"
 #include "memory.h"
 #include "strings.h"
@@ -14,6 +16,7 @@
 
 static bool m_IsOpened = false;
 static UI_WIDGET *m_Console;
+static UI_WIDGET *m_GpuProfiler;
 
 static void M_LogMultiline(const char *text);
 static void M_Log(const char *text);
@@ -50,6 +53,7 @@ static void M_Log(const char *text)
 void Console_Init(void)
 {
     m_Console = UI_Console_Create();
+    m_GpuProfiler = UI_GpuProfiler_Create();
 }
 
 void Console_Shutdown(void)
@@ -58,6 +62,10 @@ void Console_Shutdown(void)
         m_Console->free(m_Console);
         m_Console = NULL;
     }
+    if (m_GpuProfiler != NULL) {
+        m_GpuProfiler->free(m_GpuProfiler);
+        m_GpuProfiler = NULL;
+    }
 
     m_IsOpened = false;
 }
@@ -175,6 +183,10 @@ COMMAND_RESULT Console_Eval(const char *const cmdline)
 
 void Console_Draw(void)
 {
+    // the console is drawn every frame, which makes it the place to flush
+    // settings changed through it
+    Config_Update();
+
     if (m_Console == NULL) {
         return;
     }
@@ -186,4 +198,5 @@ void Console_Draw(void)
     }
 
     m_Console->draw(m_Console);
+    m_GpuProfiler->draw(m_GpuProfiler);
 }
@@ -0,0 +1,146 @@
+#include "game/ui/widgets/gpu_profiler.h"
+
+#include "game/game_string.h"
+#include "game/ui/common.h"
+#include "game/ui/events.h"
+#include "game/ui/widgets/label.h"
+#include "game/ui/widgets/stack.h"
+#include "gfx/profiler.h"
+#include "memory.h"
+
+#include <stdio.h>
+
+#define WINDOW_MARGIN 5
+#define LINE_HEIGHT 16
+#define LINE_SCALE 0.8
+// the frame line followed by one line per pass
+#define LINE_COUNT (GFX_PROFILER_PASS_NUMBER_OF + 1)
+
+typedef struct {
+    UI_WIDGET_VTABLE vtable;
+    UI_WIDGET *container;
+    UI_WIDGET *lines[LINE_COUNT];
+    bool is_shown;
+
+    int32_t listener;
+} UI_GPU_PROFILER;
+
+static void M_HandleCanvasResize(const EVENT *event, void *data);
+static void M_UpdateLines(UI_GPU_PROFILER *self);
+static void M_ClearLines(UI_GPU_PROFILER *self);
+
+static int32_t M_GetWidth(const UI_GPU_PROFILER *self);
+static int32_t M_GetHeight(const UI_GPU_PROFILER *self);
+static void M_SetPosition(UI_GPU_PROFILER *self, int32_t x, int32_t y);
+static void M_Draw(UI_GPU_PROFILER *self);
+static void M_Free(UI_GPU_PROFILER *self);
+
+static void M_HandleCanvasResize(const EVENT *event, void *data)
+{
+    UI_GPU_PROFILER *const self = (UI_GPU_PROFILER *)data;
+    UI_Stack_SetSize(self->container, M_GetWidth(self), M_GetHeight(self));
+}
+
+static void M_UpdateLines(UI_GPU_PROFILER *const self)
+{
+    const GFX_PROFILER_STATS *const stats = GFX_Profiler_GetStats();
+
+    char text[128];
+    snprintf(
+        text, sizeof(text), GS(OSD_GPU_PROFILER_FRAME), stats->frame_ms,
+        stats->frame_average_ms);
+    UI_Label_ChangeText(self->lines[0], text);
+
+    for (int32_t i = 0; i < GFX_PROFILER_PASS_NUMBER_OF; i++) {
+        const GFX_PROFILER_PASS_STATS *const pass = &stats->passes[i];
+        snprintf(
+            text, sizeof(text), GS(OSD_GPU_PROFILER_PASS),
+            GFX_Profiler_GetPassName(i), pass->last_ms, pass->average_ms,
+            pass->count);
+        UI_Label_ChangeText(self->lines[i + 1], text);
+    }
+
+    UI_Stack_DoLayout(self->container);
+}
+
+static void M_ClearLines(UI_GPU_PROFILER *const self)
+{
+    for (int32_t i = 0; i < LINE_COUNT; i++) {
+        UI_Label_ChangeText(self->lines[i], "");
+    }
+    UI_Stack_DoLayout(self->container);
+}
+
+static int32_t M_GetWidth(const UI_GPU_PROFILER *const self)
+{
+    return UI_GetCanvasWidth() - 2 * WINDOW_MARGIN;
+}
+
+static int32_t M_GetHeight(const UI_GPU_PROFILER *const self)
+{
+    return UI_GetCanvasHeight() - 2 * WINDOW_MARGIN;
+}
+
+static void M_SetPosition(UI_GPU_PROFILER *const self, int32_t x, int32_t y)
+{
+    return self->container->set_position(self->container, x, y);
+}
+
+static void M_Draw(UI_GPU_PROFILER *const self)
+{
+    // the timings change every frame, so the text is refreshed here rather
+    // than on events
+    if (GFX_Profiler_IsEnabled()) {
+        M_UpdateLines(self);
+        self->is_shown = true;
+    } else if (self->is_shown) {
+        M_ClearLines(self);
+        self->is_shown = false;
+    }
+
+    if (self->is_shown && self->container->draw != NULL) {
+        self->container->draw(self->container);
+    }
+}
+
+static void M_Free(UI_GPU_PROFILER *const self)
+{
+    for (int32_t i = 0; i < LINE_COUNT; i++) {
+        self->lines[i]->free(self->lines[i]);
+    }
+    self->container->free(self->container);
+    UI_Events_Unsubscribe(self->listener);
+    Memory_Free(self);
+}
+
+UI_WIDGET *UI_GpuProfiler_Create(void)
+{
+    UI_GPU_PROFILER *const self = Memory_Alloc(sizeof(UI_GPU_PROFILER));
+    self->vtable = (UI_WIDGET_VTABLE) {
+        .control = NULL,
+        .draw = (UI_WIDGET_DRAW)M_Draw,
+        .get_width = (UI_WIDGET_GET_WIDTH)M_GetWidth,
+        .get_height = (UI_WIDGET_GET_HEIGHT)M_GetHeight,
+        .set_position = (UI_WIDGET_SET_POSITION)M_SetPosition,
+        .free = (UI_WIDGET_FREE)M_Free,
+    };
+
+    // top right, out of the way of the console logs at the bottom
+    self->container = UI_Stack_Create(
+        UI_STACK_LAYOUT_VERTICAL, M_GetWidth(self), M_GetHeight(self));
+    UI_Stack_SetHAlign(self->container, UI_STACK_H_ALIGN_RIGHT);
+
+    for (int32_t i = 0; i < LINE_COUNT; i++) {
+        self->lines[i] =
+            UI_Label_Create("", UI_LABEL_AUTO_SIZE, LINE_HEIGHT * LINE_SCALE);
+        UI_Label_SetScale(self->lines[i], LINE_SCALE);
+        UI_Stack_AddChild(self->container, self->lines[i]);
+    }
+
+    M_SetPosition(self, WINDOW_MARGIN, WINDOW_MARGIN);
+
+    self->listener =
+        UI_Events_Subscribe("canvas_resize", NULL, M_HandleCanvasResize, self);
+
+    return (UI_WIDGET *)self;
+}
@@ -1,15 +1,100 @@
 #include "gfx/2d/2d_renderer.h"
 
+#include "gfx/2d/2d_surface.h"
 #include "gfx/gl/gl_core_3_3.h"
+#include "gfx/gl/state.h"
 #include "gfx/gl/utils.h"
+#include "gfx/profiler.h"
 #include "log.h"
 
 #include <assert.h>
+#include <string.h>
+
+static void M_UploadDirect(
+    const GFX_2D_SURFACE_DESC *desc, const uint8_t *data,
+    const GFX_2D_RECT *rect);
+static bool M_UploadBuffered(
+    GFX_2D_RENDERER *renderer, const GFX_2D_SURFACE_DESC *desc,
+    const uint8_t *data, const GFX_2D_RECT *rect);
+
+static void M_UploadDirect(
+    const GFX_2D_SURFACE_DESC *const desc, const uint8_t *const data,
+    const GFX_2D_RECT *const rect)
+{
+    const int32_t bpp = desc->bit_count / 8;
+
+    // other uploads may rely on whatever the unpack state was
+    GLint alignment;
+    GLint row_length;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glGetIntegerv(GL_UNPACK_ROW_LENGTH, &row_length);
+
+    // let GL walk the surface rows itself instead of repacking the region
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, desc->pitch / bpp);
+    glTexSubImage2D(
+        GL_TEXTURE_2D, 0, rect->x, rect->y, rect->width, rect->height,
+        desc->tex_format, desc->tex_type,
+        data + rect->y * desc->pitch + rect->x * bpp);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, row_length);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    GFX_GL_CheckError();
+}
+
+static bool M_UploadBuffered(
+    GFX_2D_RENDERER *const renderer, const GFX_2D_SURFACE_DESC *const desc,
+    const uint8_t *const data, const GFX_2D_RECT *const rect)
+{
+    const int32_t bpp = desc->bit_count / 8;
+    const int32_t row_size = rect->width * bpp;
+
+    // orphan the previous contents so that the driver never has to wait for
+    // last frame's transfer to finish
+    GFX_GL_Buffer_Bind(&renderer->upload_buffer);
+    GFX_GL_Buffer_Data(
+        &renderer->upload_buffer, row_size * rect->height, NULL,
+        GL_STREAM_DRAW);
+    uint8_t *const dst =
+        GFX_GL_Buffer_Map(&renderer->upload_buffer, GL_WRITE_ONLY);
+    if (dst == NULL) {
+        GFX_GL_State_BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
 
-void GFX_2D_Renderer_Init(GFX_2D_RENDERER *renderer)
+    const uint8_t *src = data + rect->y * desc->pitch + rect->x * bpp;
+    for (int32_t y = 0; y < rect->height; y++) {
+        memcpy(dst + y * row_size, src, row_size);
+        src += desc->pitch;
+    }
+    GFX_GL_Buffer_Unmap(&renderer->upload_buffer);
+
+    GLint alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(
+        GL_TEXTURE_2D, 0, rect->x, rect->y, rect->width, rect->height,
+        desc->tex_format, desc->tex_type, NULL);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    GFX_GL_CheckError();
+
+    // a bound unpack buffer turns every other texture upload pointer into an
+    // offset, so never leave it bound
+    GFX_GL_State_BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
+}
+
+void GFX_2D_Renderer_Init(
+    GFX_2D_RENDERER *renderer, const GFX_CONFIG *const config)
 {
     LOG_INFO("");
     assert(renderer);
+    assert(config);
+    renderer->config = config;
+    renderer->surface = NULL;
+    renderer->stats.draw_calls = 0;
+    renderer->stats.uploaded_bytes = 0;
+
+    GFX_GL_Buffer_Init(&renderer->upload_buffer, GL_PIXEL_UNPACK_BUFFER);
 
     GFX_GL_Buffer_Init(&renderer->surface_buffer, GL_ARRAY_BUFFER);
     GFX_GL_Buffer_Bind(&renderer->surface_buffer);
@@ -54,6 +139,7 @@ void GFX_2D_Renderer_Close(GFX_2D_RENDERER *renderer)
 
     GFX_GL_VertexArray_Close(&renderer->surface_format);
     GFX_GL_Buffer_Close(&renderer->surface_buffer);
+    GFX_GL_Buffer_Close(&renderer->upload_buffer);
     GFX_GL_Texture_Close(&renderer->surface_texture);
     GFX_GL_Sampler_Close(&renderer->sampler);
     GFX_GL_Program_Close(&renderer->program);
@@ -61,10 +147,19 @@ void GFX_2D_Renderer_Close(GFX_2D_RENDERER *renderer)
 
 void GFX_2D_Renderer_Upload(
     GFX_2D_RENDERER *renderer, GFX_2D_SURFACE_DESC *desc, const uint8_t *data)
+{
+    GFX_2D_Renderer_UploadRect(renderer, desc, data, NULL);
+}
+
+void GFX_2D_Renderer_UploadRect(
+    GFX_2D_RENDERER *const renderer, GFX_2D_SURFACE_DESC *const desc,
+    const uint8_t *const data, const GFX_2D_RECT *const rect)
 {
     const uint32_t width = desc->width;
     const uint32_t height = desc->height;
+    renderer->surface = NULL;
 
+    GFX_Profiler_BeginPass(GFX_PROFILER_PASS_2D_UPLOAD);
     GFX_GL_Texture_Bind(&renderer->surface_texture);
 
     // TODO: implement texture packs
@@ -77,42 +172,68 @@ void GFX_2D_Renderer_Upload(
             GL_TEXTURE_2D, 0, GL_RGBA, renderer->width, renderer->height, 0,
             desc->tex_format, desc->tex_type, data);
         GFX_GL_CheckError();
+        renderer->stats.uploaded_bytes +=
+            (uint64_t)width * height * (desc->bit_count / 8);
     } else {
-        glTexSubImage2D(
-            GL_TEXTURE_2D, 0, 0, 0, renderer->width, renderer->height,
-            desc->tex_format, desc->tex_type, data);
-        GFX_GL_CheckError();
+        GFX_2D_RECT region = { 0, 0, width, height };
+        if (rect != NULL) {
+            region = *rect;
+        }
+        assert(region.x >= 0 && region.y >= 0);
+        assert(region.x + region.width <= (int32_t)width);
+        assert(region.y + region.height <= (int32_t)height);
+
+        if (region.width > 0 && region.height > 0) {
+            if (!renderer->config->enable_pbo_uploads
+                || !M_UploadBuffered(renderer, desc, data, &region)) {
+                M_UploadDirect(desc, data, &region);
+            }
+            renderer->stats.uploaded_bytes += (uint64_t)region.width
+                * region.height * (desc->bit_count / 8);
+        }
+    }
+    GFX_Profiler_EndPass(GFX_PROFILER_PASS_2D_UPLOAD);
+}
+
+void GFX_2D_Renderer_UploadSurface(
+    GFX_2D_RENDERER *const renderer, GFX_2D_SURFACE *const surface)
+{
+    assert(surface != NULL);
+    const bool is_current = renderer->surface == surface
+        && surface->desc.width == (int32_t)renderer->width
+        && surface->desc.height == (int32_t)renderer->height;
+    if (is_current && !surface->is_dirty) {
+        return;
     }
+
+    // the texture holds another image, so the whole surface has to go up
+    GFX_2D_Renderer_UploadRect(
+        renderer, &surface->desc, surface->buffer,
+        is_current ? &surface->dirty_rect : NULL);
+    renderer->surface = surface;
+    GFX_2D_Surface_MarkClean(surface);
 }
 
 void GFX_2D_Renderer_Render(GFX_2D_RENDERER *renderer)
 {
+    GFX_Profiler_BeginPass(GFX_PROFILER_PASS_2D);
     GFX_GL_Program_Bind(&renderer->program);
     GFX_GL_Buffer_Bind(&renderer->surface_buffer);
     GFX_GL_VertexArray_Bind(&renderer->surface_format);
     GFX_GL_Texture_Bind(&renderer->surface_texture);
     GFX_GL_Sampler_Bind(&renderer->sampler, 0);
 
-    GLboolean blend = glIsEnabled(GL_BLEND);
-    if (blend) {
-        glDisable(GL_BLEND);
-    }
-
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-    GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
-    if (depth_test) {
-        glDisable(GL_DEPTH_TEST);
-    }
+    const bool blend = GFX_GL_State_IsEnabled(GL_BLEND);
+    const bool depth_test = GFX_GL_State_IsEnabled(GL_DEPTH_TEST);
+    GFX_GL_State_SetEnabled(GL_BLEND, false);
+    GFX_GL_State_SetEnabled(GL_DEPTH_TEST, false);
+    GFX_GL_State_PolygonMode(GL_FILL);
 
     glDrawArrays(GL_TRIANGLES, 0, 6);
     GFX_GL_CheckError();
+    renderer->stats.draw_calls++;
 
-    if (blend) {
-        glEnable(GL_BLEND);
-    }
-
-    if (depth_test) {
-        glEnable(GL_DEPTH_TEST);
-    }
+    GFX_GL_State_SetEnabled(GL_BLEND, blend);
+    GFX_GL_State_SetEnabled(GL_DEPTH_TEST, depth_test);
+    GFX_Profiler_EndPass(GFX_PROFILER_PASS_2D);
 }
@@ -3,10 +3,22 @@
 #include "gfx/context.h"
 #include "log.h"
 #include "memory.h"
+#include "utils.h"
 
 #include <assert.h>
 #include <string.h>
 
+static void M_GetFullRect(const GFX_2D_SURFACE *surface, GFX_2D_RECT *rect);
+
+static void M_GetFullRect(
+    const GFX_2D_SURFACE *const surface, GFX_2D_RECT *const rect)
+{
+    rect->x = 0;
+    rect->y = 0;
+    rect->width = surface->desc.width;
+    rect->height = surface->desc.height;
+}
+
 GFX_2D_SURFACE *GFX_2D_Surface_Create(const GFX_2D_SURFACE_DESC *desc)
 {
     GFX_2D_SURFACE *surface = Memory_Alloc(sizeof(GFX_2D_SURFACE));
@@ -30,6 +42,7 @@ GFX_2D_SURFACE *GFX_2D_Surface_CreateFromImage(const IMAGE *image)
     memcpy(
         surface->buffer, image->data,
         surface->desc.pitch * surface->desc.height);
+    M_GetFullRect(surface, &surface->dirty_rect);
     return surface;
 }
 
@@ -74,6 +87,9 @@ void GFX_2D_Surface_Init(
 
     surface->buffer = Memory_Alloc(surface->desc.pitch * surface->desc.height);
     surface->desc.pixels = NULL;
+
+    // a new surface has never been uploaded
+    GFX_2D_Surface_MarkDirty(surface, NULL);
 }
 
 void GFX_2D_Surface_Close(GFX_2D_SURFACE *surface)
@@ -88,12 +104,62 @@ bool GFX_2D_Surface_Clear(GFX_2D_SURFACE *surface)
         return false;
     }
 
-    surface->is_dirty = true;
+    GFX_2D_Surface_MarkDirty(surface, NULL);
     memset(surface->buffer, 0, surface->desc.pitch * surface->desc.height);
     return true;
 }
 
+void GFX_2D_Surface_MarkDirty(
+    GFX_2D_SURFACE *const surface, const GFX_2D_RECT *const rect)
+{
+    assert(surface != NULL);
+
+    GFX_2D_RECT full;
+    M_GetFullRect(surface, &full);
+    if (rect == NULL) {
+        surface->dirty_rect = full;
+        surface->is_dirty = true;
+        return;
+    }
+
+    int32_t x0 = MAX(rect->x, 0);
+    int32_t y0 = MAX(rect->y, 0);
+    int32_t x1 = MIN(rect->x + rect->width, full.width);
+    int32_t y1 = MIN(rect->y + rect->height, full.height);
+    if (x1 <= x0 || y1 <= y0) {
+        return;
+    }
+
+    if (surface->is_dirty) {
+        const GFX_2D_RECT *const old = &surface->dirty_rect;
+        x0 = MIN(x0, old->x);
+        y0 = MIN(y0, old->y);
+        x1 = MAX(x1, old->x + old->width);
+        y1 = MAX(y1, old->y + old->height);
+    }
+
+    surface->dirty_rect.x = x0;
+    surface->dirty_rect.y = y0;
+    surface->dirty_rect.width = x1 - x0;
+    surface->dirty_rect.height = y1 - y0;
+    surface->is_dirty = true;
+}
+
+void GFX_2D_Surface_MarkClean(GFX_2D_SURFACE *const surface)
+{
+    assert(surface != NULL);
+    surface->is_dirty = false;
+    surface->dirty_rect = (GFX_2D_RECT) { 0 };
+}
+
 bool GFX_2D_Surface_Lock(GFX_2D_SURFACE *surface, GFX_2D_SURFACE_DESC *out_desc)
+{
+    return GFX_2D_Surface_LockRect(surface, NULL, out_desc);
+}
+
+bool GFX_2D_Surface_LockRect(
+    GFX_2D_SURFACE *const surface, const GFX_2D_RECT *const rect,
+    GFX_2D_SURFACE_DESC *const out_desc)
 {
     assert(surface != NULL);
     if (surface->is_locked) {
@@ -105,7 +171,7 @@ bool GFX_2D_Surface_Lock(GFX_2D_SURFACE *surface, GFX_2D_SURFACE_DESC *out_desc)
     surface->desc.pixels = surface->buffer;
 
     surface->is_locked = true;
-    surface->is_dirty = true;
+    GFX_2D_Surface_MarkDirty(surface, rect);
 
     *out_desc = surface->desc;
 
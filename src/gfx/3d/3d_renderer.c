@@ -1,13 +1,33 @@
 #include "gfx/3d/3d_renderer.h"
 
 #include "gfx/context.h"
+#include "gfx/gl/state.h"
+#include "gfx/gl/texture_batch.h"
 #include "gfx/gl/utils.h"
+#include "gfx/profiler.h"
 #include "log.h"
+#include "memory.h"
+#include "utils.h"
 
 #include <assert.h>
 #include <stddef.h>
 
+// negate Z axis so the model is rendered behind the viewport, which is
+// better than having a negative z_near in the ortho matrix, which seems
+// to mess up depth testing
+static const GLfloat m_ModelView[4][4] = {
+    { +1.0f, +0.0f, +0.0f, +0.0f },
+    { +0.0f, +1.0f, +0.0f, +0.0f },
+    { +0.0f, +0.0f, -1.0f, +0.0f },
+    { +0.0f, +0.0f, +0.0f, +1.0f },
+};
+
 static void M_SelectTextureImpl(GFX_3D_RENDERER *renderer, int texture_num);
+static GFX_3D_STATIC_MESH *M_GetStaticMesh(
+    const GFX_3D_RENDERER *renderer, int mesh_num);
+static void M_AllocateEnvironmentMap(
+    GFX_3D_RENDERER *renderer, int32_t side, bool has_mipmaps);
+static void M_FreeEnvironmentMapStorage(GFX_3D_RENDERER *renderer);
 
 static void M_SelectTextureImpl(GFX_3D_RENDERER *renderer, int texture_num)
 {
@@ -23,12 +43,72 @@ static void M_SelectTextureImpl(GFX_3D_RENDERER *renderer, int texture_num)
     }
 
     if (texture == NULL) {
-        glBindTexture(GL_TEXTURE_2D, 0);
-        GFX_GL_CheckError();
+        GFX_GL_State_BindTexture(GL_TEXTURE_2D, 0);
         return;
     }
 
     GFX_GL_Texture_Bind(texture);
+    if (texture_num == GFX_ENV_MAP_TEXTURE && renderer->env_map_has_mipmaps) {
+        GFX_GL_Sampler_Bind(&renderer->env_map_sampler, 0);
+    } else {
+        GFX_GL_Sampler_Bind(&renderer->sampler, 0);
+    }
+}
+
+static GFX_3D_STATIC_MESH *M_GetStaticMesh(
+    const GFX_3D_RENDERER *const renderer, const int mesh_num)
+{
+    if (mesh_num < 0 || mesh_num >= GFX_MAX_STATIC_MESHES
+        || renderer->static_meshes[mesh_num] == NULL) {
+        LOG_ERROR("Invalid static mesh handle");
+        return NULL;
+    }
+    return renderer->static_meshes[mesh_num];
+}
+
+static void M_AllocateEnvironmentMap(
+    GFX_3D_RENDERER *const renderer, const int32_t side,
+    const bool has_mipmaps)
+{
+    GFX_GL_TEXTURE *const env_map = renderer->env_map_texture;
+    GFX_GL_Texture_Bind(env_map);
+    glTexImage2D(
+        GL_TEXTURE_2D, 0, GL_RGB, side, side, 0, GL_RGB, GL_UNSIGNED_BYTE,
+        NULL);
+    GFX_GL_CheckError();
+    renderer->env_map_side = side;
+    renderer->env_map_has_mipmaps = has_mipmaps;
+
+    if (renderer->env_map_fbo == 0) {
+        glGenFramebuffers(1, &renderer->env_map_fbo);
+        GFX_GL_CheckError();
+    }
+
+    // keep whatever framebuffer the scene is being drawn into
+    const GLuint draw_fbo = GFX_GL_State_GetDrawFramebuffer();
+    GFX_GL_State_BindFramebuffer(GL_DRAW_FRAMEBUFFER, renderer->env_map_fbo);
+    glFramebufferTexture2D(
+        GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, env_map->id,
+        0);
+    GFX_GL_CheckError();
+    GFX_GL_State_BindFramebuffer(GL_DRAW_FRAMEBUFFER, draw_fbo);
+
+    LOG_DEBUG(
+        "Environment map storage: %dx%d%s", side, side,
+        has_mipmaps ? " (mipmapped)" : "");
+}
+
+static void M_FreeEnvironmentMapStorage(GFX_3D_RENDERER *const renderer)
+{
+    if (renderer->env_map_fbo != 0) {
+        GFX_GL_State_ForgetFramebuffer(renderer->env_map_fbo);
+        glDeleteFramebuffers(1, &renderer->env_map_fbo);
+        GFX_GL_CheckError();
+        renderer->env_map_fbo = 0;
+    }
+    renderer->env_map_side = 0;
+    renderer->env_map_has_mipmaps = false;
+    renderer->env_map_requests = 0;
 }
 
 void GFX_3D_Renderer_Init(
@@ -53,6 +133,22 @@ void GFX_3D_Renderer_Init(
     GFX_GL_Sampler_Parameteri(
         &renderer->sampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
+    renderer->env_map_fbo = 0;
+    renderer->env_map_side = 0;
+    renderer->env_map_has_mipmaps = false;
+    renderer->env_map_requests = 0;
+    GFX_GL_Sampler_Init(&renderer->env_map_sampler);
+    GFX_GL_Sampler_Parameteri(
+        &renderer->env_map_sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    GFX_GL_Sampler_Parameteri(
+        &renderer->env_map_sampler, GL_TEXTURE_MIN_FILTER,
+        GL_LINEAR_MIPMAP_LINEAR);
+    GFX_GL_Sampler_Parameteri(
+        &renderer->env_map_sampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    GFX_GL_Sampler_Parameteri(
+        &renderer->env_map_sampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GFX_GL_Sampler_Bind(&renderer->sampler, 0);
+
     GFX_GL_Program_Init(&renderer->program);
     GFX_GL_Program_AttachShader(
         &renderer->program, GL_VERTEX_SHADER, "shaders/3d.glsl");
@@ -72,18 +168,14 @@ void GFX_3D_Renderer_Init(
     GFX_GL_Program_FragmentData(&renderer->program, "fragColor");
     GFX_GL_Program_Bind(&renderer->program);
 
-    // negate Z axis so the model is rendered behind the viewport, which is
-    // better than having a negative z_near in the ortho matrix, which seems
-    // to mess up depth testing
-    GLfloat model_view[4][4] = {
-        { +1.0f, +0.0f, +0.0f, +0.0f },
-        { +0.0f, +1.0f, +0.0f, +0.0f },
-        { +0.0f, +0.0f, -1.0f, +0.0f },
-        { +0.0f, +0.0f, +0.0f, +1.0f },
-    };
     GFX_GL_Program_UniformMatrix4fv(
         &renderer->program, renderer->loc_mat_model_view, 1, GL_FALSE,
-        &model_view[0][0]);
+        &m_ModelView[0][0]);
+
+    for (int i = 0; i < GFX_MAX_STATIC_MESHES; i++) {
+        renderer->static_meshes[i] = NULL;
+    }
+    renderer->lighting_version = 0;
 
     GFX_3D_VertexStream_Init(&renderer->vertex_stream);
 
@@ -95,21 +187,27 @@ void GFX_3D_Renderer_Close(GFX_3D_RENDERER *renderer)
     LOG_INFO("");
     assert(renderer);
 
+    for (int i = 0; i < GFX_MAX_STATIC_MESHES; i++) {
+        if (renderer->static_meshes[i] != NULL) {
+            GFX_3D_Renderer_UnregisterStaticMesh(renderer, i);
+        }
+    }
     GFX_3D_VertexStream_Close(&renderer->vertex_stream);
     GFX_GL_Program_Close(&renderer->program);
     GFX_GL_Sampler_Close(&renderer->sampler);
+    M_FreeEnvironmentMapStorage(renderer);
+    GFX_GL_Sampler_Close(&renderer->env_map_sampler);
 }
 
 void GFX_3D_Renderer_RenderBegin(GFX_3D_RENDERER *renderer)
 {
     assert(renderer);
-    glEnable(GL_BLEND);
+    GFX_Profiler_BeginPass(GFX_PROFILER_PASS_3D);
+    GFX_GL_State_SetEnabled(GL_BLEND, true);
 
-    glLineWidth(renderer->config->line_width);
-    glPolygonMode(
-        GL_FRONT_AND_BACK,
+    GFX_GL_State_LineWidth(renderer->config->line_width);
+    GFX_GL_State_PolygonMode(
         renderer->config->enable_wireframe ? GL_LINE : GL_FILL);
-    GFX_GL_CheckError();
 
     GFX_GL_Program_Bind(&renderer->program);
     GFX_3D_VertexStream_Bind(&renderer->vertex_stream);
@@ -123,6 +221,9 @@ void GFX_3D_Renderer_RenderBegin(GFX_3D_RENDERER *renderer)
     const float bottom = GFX_Context_GetDisplayHeight();
     const float z_near = -1e6;
     const float z_far = 1e6;
+    GFX_3D_VertexStream_SetCullRect(
+        &renderer->vertex_stream, left, top, right, bottom);
+    GFX_3D_VertexStream_ResetFrameStats(&renderer->vertex_stream);
     GLfloat projection[4][4] = {
         { 2.0f / (right - left), 0.0f, 0.0f, 0.0f },
         { 0.0f, 2.0f / (top - bottom), 0.0f, 0.0f },
@@ -135,10 +236,9 @@ void GFX_3D_Renderer_RenderBegin(GFX_3D_RENDERER *renderer)
         &renderer->program, renderer->loc_mat_projection, 1, GL_FALSE,
         &projection[0][0]);
 
-    glDepthFunc(GL_LEQUAL);
-    glDepthMask(GL_TRUE);
-    glEnable(GL_DEPTH_TEST);
-    GFX_GL_CheckError();
+    GFX_GL_State_DepthFunc(GL_LEQUAL);
+    GFX_GL_State_DepthMask(GL_TRUE);
+    GFX_GL_State_SetEnabled(GL_DEPTH_TEST, true);
 }
 
 void GFX_3D_Renderer_RenderEnd(GFX_3D_RENDERER *renderer)
@@ -147,6 +247,7 @@ void GFX_3D_Renderer_RenderEnd(GFX_3D_RENDERER *renderer)
     GFX_3D_VertexStream_RenderPending(&renderer->vertex_stream);
 
     GFX_GL_CheckError();
+    GFX_Profiler_EndPass(GFX_PROFILER_PASS_3D);
 }
 
 void GFX_3D_Renderer_ClearDepth(GFX_3D_RENDERER *renderer)
@@ -191,6 +292,7 @@ bool GFX_3D_Renderer_UnregisterEnvironmentMap(
         renderer->selected_texture_num = GFX_NO_TEXTURE;
     }
 
+    M_FreeEnvironmentMapStorage(renderer);
     GFX_GL_Texture_Free(texture);
     renderer->env_map_texture = NULL;
     return true;
@@ -201,11 +303,67 @@ void GFX_3D_Renderer_FillEnvironmentMap(GFX_3D_RENDERER *const renderer)
     assert(renderer != NULL);
 
     GFX_GL_TEXTURE *const env_map = renderer->env_map_texture;
-    if (env_map != NULL) {
-        GFX_3D_VertexStream_RenderPending(&renderer->vertex_stream);
-        GFX_GL_Texture_LoadFromBackBuffer(env_map);
-        GFX_3D_Renderer_RestoreTexture(renderer);
+    if (env_map == NULL) {
+        return;
+    }
+
+    // until the first refresh there is nothing to reuse; that refresh still
+    // counts, so the next one comes a full interval later
+    const int32_t interval = renderer->config->env_map_interval;
+    const uint32_t request = renderer->env_map_requests++;
+    if (renderer->env_map_side != 0 && interval > 1
+        && request % (uint32_t)interval != 0) {
+        return;
+    }
+
+    GFX_3D_VertexStream_RenderPending(&renderer->vertex_stream);
+    GFX_Profiler_BeginPass(GFX_PROFILER_PASS_ENV_MAP);
+
+    // use the largest centered square of what was rendered so far
+    GLint viewport[4];
+    GFX_GL_State_GetViewport(viewport);
+    const int32_t src_side = MIN(viewport[2], viewport[3]);
+    const int32_t src_x = viewport[0] + (viewport[2] - src_side) / 2;
+    const int32_t src_y = viewport[1] + (viewport[3] - src_side) / 2;
+
+    int32_t side = src_side;
+    if (renderer->config->env_map_size > 0) {
+        side = MIN(side, renderer->config->env_map_size);
+    }
+    const bool has_mipmaps = renderer->config->enable_env_map_mipmaps;
+    if (side != renderer->env_map_side
+        || has_mipmaps != renderer->env_map_has_mipmaps) {
+        M_AllocateEnvironmentMap(renderer, side, has_mipmaps);
     }
+
+    // read back from wherever the scene is being drawn into
+    const GLuint draw_fbo = GFX_GL_State_GetDrawFramebuffer();
+    GFX_GL_State_BindFramebuffer(GL_READ_FRAMEBUFFER, draw_fbo);
+
+    GFX_GL_Texture_Bind(env_map);
+    if (side == src_side) {
+        glCopyTexSubImage2D(
+            GL_TEXTURE_2D, 0, 0, 0, src_x, src_y, src_side, src_side);
+        GFX_GL_CheckError();
+    } else {
+        // downscale on the GPU straight into the texture
+        GFX_GL_State_BindFramebuffer(
+            GL_DRAW_FRAMEBUFFER, renderer->env_map_fbo);
+        glBlitFramebuffer(
+            src_x, src_y, src_x + src_side, src_y + src_side, 0, 0, side,
+            side, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        GFX_GL_CheckError();
+        GFX_GL_State_BindFramebuffer(GL_DRAW_FRAMEBUFFER, draw_fbo);
+    }
+
+    if (has_mipmaps) {
+        // queued on the GPU like the copy; the CPU does not wait for it
+        glGenerateMipmap(GL_TEXTURE_2D);
+        GFX_GL_CheckError();
+    }
+
+    GFX_Profiler_EndPass(GFX_PROFILER_PASS_ENV_MAP);
+    GFX_3D_Renderer_RestoreTexture(renderer);
 }
 
 int GFX_3D_Renderer_RegisterTexturePage(
@@ -231,6 +389,41 @@ int GFX_3D_Renderer_RegisterTexturePage(
     return texture_num;
 }
 
+bool GFX_3D_Renderer_RegisterTexturePages(
+    GFX_3D_RENDERER *const renderer, const void *const *const pages,
+    const int count, const int width, const int height,
+    int *const out_texture_nums)
+{
+    assert(renderer != NULL);
+    assert(pages != NULL);
+    assert(out_texture_nums != NULL);
+
+    bool result = true;
+    GFX_GL_TEXTURE_BATCH *const batch = GFX_GL_TextureBatch_Create();
+    int slot = 0;
+    for (int i = 0; i < count; i++) {
+        while (slot < GFX_MAX_TEXTURES && renderer->textures[slot] != NULL) {
+            slot++;
+        }
+        if (slot == GFX_MAX_TEXTURES) {
+            LOG_ERROR("No free texture slots left");
+            out_texture_nums[i] = GFX_NO_TEXTURE;
+            result = false;
+            continue;
+        }
+
+        GFX_GL_TEXTURE *const texture = GFX_GL_Texture_Create(GL_TEXTURE_2D);
+        GFX_GL_TextureBatch_Add(batch, texture, pages[i], width, height);
+        renderer->textures[slot] = texture;
+        out_texture_nums[i] = slot;
+    }
+    GFX_GL_TextureBatch_Upload(batch);
+
+    GFX_3D_Renderer_RestoreTexture(renderer);
+    GFX_GL_CheckError();
+    return result;
+}
+
 bool GFX_3D_Renderer_UnregisterTexturePage(
     GFX_3D_RENDERER *renderer, int texture_num)
 {
@@ -280,6 +473,153 @@ void GFX_3D_Renderer_RenderPrimList(
     GFX_3D_VertexStream_PushPrimList(&renderer->vertex_stream, vertices, count);
 }
 
+void GFX_3D_Renderer_SubmitArenas(
+    GFX_3D_RENDERER *const renderer, GFX_3D_VERTEX_ARENA *const *const arenas,
+    const int32_t count)
+{
+    assert(renderer != NULL);
+    assert(arenas != NULL);
+
+    for (int32_t i = 0; i < count; i++) {
+        const GFX_3D_VERTEX_ARENA *const arena = arenas[i];
+        for (size_t j = 0; j < arena->commands.count; j++) {
+            const GFX_3D_ARENA_CMD *const cmd = &arena->commands.data[j];
+            switch (cmd->type) {
+            case GFX_3D_ARENA_CMD_PRIMS:
+                // strips and fans were already expanded by the arena
+                GFX_3D_VertexStream_PushPrimList(
+                    &renderer->vertex_stream,
+                    &arena->vertices.data[cmd->prims.first],
+                    cmd->prims.count);
+                break;
+            case GFX_3D_ARENA_CMD_SELECT_TEXTURE:
+                GFX_3D_Renderer_SelectTexture(renderer, cmd->value);
+                break;
+            case GFX_3D_ARENA_CMD_SET_PRIM_TYPE:
+                GFX_3D_Renderer_SetPrimType(renderer, cmd->value);
+                break;
+            case GFX_3D_ARENA_CMD_SET_TEXTURE_FILTER:
+                GFX_3D_Renderer_SetTextureFilter(renderer, cmd->value);
+                break;
+            case GFX_3D_ARENA_CMD_SET_DEPTH_TEST:
+                GFX_3D_Renderer_SetDepthTestEnabled(renderer, cmd->value);
+                break;
+            case GFX_3D_ARENA_CMD_SET_BLENDING_MODE:
+                GFX_3D_Renderer_SetBlendingMode(renderer, cmd->value);
+                break;
+            case GFX_3D_ARENA_CMD_SET_TEXTURING:
+                GFX_3D_Renderer_SetTexturingEnabled(renderer, cmd->value);
+                break;
+            }
+        }
+    }
+}
+
+int GFX_3D_Renderer_RegisterStaticMesh(
+    GFX_3D_RENDERER *const renderer, const GFX_3D_VERTEX *const vertices,
+    const int32_t vertex_count, const uint32_t *const indices,
+    const int32_t index_count, const GFX_3D_STATIC_MESH_RANGE *const ranges,
+    const int32_t range_count)
+{
+    assert(renderer != NULL);
+
+    for (int i = 0; i < GFX_MAX_STATIC_MESHES; i++) {
+        if (renderer->static_meshes[i] != NULL) {
+            continue;
+        }
+        GFX_3D_STATIC_MESH *const mesh =
+            Memory_Alloc(sizeof(GFX_3D_STATIC_MESH));
+        GFX_3D_StaticMesh_Init(
+            mesh, vertices, vertex_count, indices, index_count, ranges,
+            range_count);
+        mesh->lighting_version = renderer->lighting_version;
+        renderer->static_meshes[i] = mesh;
+        return i;
+    }
+
+    LOG_ERROR("No free static mesh slots left");
+    return GFX_NO_STATIC_MESH;
+}
+
+bool GFX_3D_Renderer_UnregisterStaticMesh(
+    GFX_3D_RENDERER *const renderer, const int mesh_num)
+{
+    assert(renderer != NULL);
+    GFX_3D_STATIC_MESH *mesh = M_GetStaticMesh(renderer, mesh_num);
+    if (mesh == NULL) {
+        return false;
+    }
+
+    GFX_3D_StaticMesh_Close(mesh);
+    Memory_FreePointer(&mesh);
+    renderer->static_meshes[mesh_num] = NULL;
+    return true;
+}
+
+void GFX_3D_Renderer_InvalidateStaticLighting(GFX_3D_RENDERER *const renderer)
+{
+    assert(renderer != NULL);
+    renderer->lighting_version++;
+}
+
+bool GFX_3D_Renderer_UpdateStaticMeshLighting(
+    GFX_3D_RENDERER *const renderer, const int mesh_num,
+    const GFX_3D_VERTEX *const vertices)
+{
+    assert(renderer != NULL);
+    GFX_3D_STATIC_MESH *const mesh = M_GetStaticMesh(renderer, mesh_num);
+    if (mesh == NULL) {
+        return false;
+    }
+
+    GFX_3D_StaticMesh_UpdateVertices(mesh, vertices);
+    mesh->lighting_version = renderer->lighting_version;
+    return true;
+}
+
+bool GFX_3D_Renderer_DrawStaticMesh(
+    GFX_3D_RENDERER *const renderer, const int mesh_num,
+    const float *const transform)
+{
+    assert(renderer != NULL);
+    GFX_3D_STATIC_MESH *const mesh = M_GetStaticMesh(renderer, mesh_num);
+    if (mesh == NULL || mesh->lighting_version != renderer->lighting_version) {
+        return false;
+    }
+
+    // keep the draw order of whatever was queued before the mesh
+    GFX_3D_VertexStream_RenderPending(&renderer->vertex_stream);
+
+    if (transform != NULL) {
+        // the fixed Z flip is applied after the mesh transform
+        GLfloat model_view[4][4];
+        for (int32_t col = 0; col < 4; col++) {
+            for (int32_t row = 0; row < 4; row++) {
+                model_view[col][row] =
+                    transform[col * 4 + row] * m_ModelView[row][row];
+            }
+        }
+        GFX_GL_Program_UniformMatrix4fv(
+            &renderer->program, renderer->loc_mat_model_view, 1, GL_FALSE,
+            &model_view[0][0]);
+    }
+
+    GFX_3D_StaticMesh_Bind(mesh);
+    for (int32_t i = 0; i < mesh->range_count; i++) {
+        const GFX_3D_STATIC_MESH_RANGE *const range = &mesh->ranges[i];
+        M_SelectTextureImpl(renderer, range->texture_num);
+        GFX_3D_StaticMesh_DrawRange(mesh, range);
+    }
+    GFX_3D_Renderer_RestoreTexture(renderer);
+
+    if (transform != NULL) {
+        GFX_GL_Program_UniformMatrix4fv(
+            &renderer->program, renderer->loc_mat_model_view, 1, GL_FALSE,
+            &m_ModelView[0][0]);
+    }
+    return true;
+}
+
 void GFX_3D_Renderer_SelectTexture(GFX_3D_RENDERER *renderer, int texture_num)
 {
     assert(renderer);
@@ -302,6 +642,16 @@ void GFX_3D_Renderer_SetPrimType(
     GFX_3D_VertexStream_SetPrimType(&renderer->vertex_stream, value);
 }
 
+void GFX_3D_Renderer_SetCulling(
+    GFX_3D_RENDERER *const renderer, const bool cull_offscreen,
+    const GFX_3D_CULL_FACE cull_face)
+{
+    assert(renderer != NULL);
+    // already queued triangles were tested with the previous settings
+    GFX_3D_VertexStream_SetCulling(
+        &renderer->vertex_stream, cull_offscreen, cull_face);
+}
+
 void GFX_3D_Renderer_SetTextureFilter(
     GFX_3D_RENDERER *renderer, GFX_TEXTURE_FILTER filter)
 {
@@ -323,11 +673,7 @@ void GFX_3D_Renderer_SetDepthTestEnabled(
 {
     assert(renderer);
     GFX_3D_VertexStream_RenderPending(&renderer->vertex_stream);
-    if (is_enabled) {
-        glEnable(GL_DEPTH_TEST);
-    } else {
-        glDisable(GL_DEPTH_TEST);
-    }
+    GFX_GL_State_SetEnabled(GL_DEPTH_TEST, is_enabled);
 }
 
 void GFX_3D_Renderer_SetBlendingMode(
@@ -338,13 +684,13 @@ void GFX_3D_Renderer_SetBlendingMode(
 
     switch (blend_mode) {
     case GFX_BLEND_MODE_OFF:
-        glBlendFunc(GL_ONE, GL_ZERO);
+        GFX_GL_State_BlendFunc(GL_ONE, GL_ZERO);
         break;
     case GFX_BLEND_MODE_NORMAL:
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        GFX_GL_State_BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         break;
     case GFX_BLEND_MODE_MULTIPLY:
-        glBlendFunc(GL_DST_COLOR, GL_SRC_COLOR);
+        GFX_GL_State_BlendFunc(GL_DST_COLOR, GL_SRC_COLOR);
         break;
     }
 }
@@ -0,0 +1,96 @@
+#include "gfx/3d/static_mesh.h"
+
+#include "gfx/gl/utils.h"
+#include "memory.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+void GFX_3D_StaticMesh_Init(
+    GFX_3D_STATIC_MESH *const mesh, const GFX_3D_VERTEX *const vertices,
+    const int32_t vertex_count, const uint32_t *const indices,
+    const int32_t index_count, const GFX_3D_STATIC_MESH_RANGE *const ranges,
+    const int32_t range_count)
+{
+    assert(mesh != NULL);
+    assert(vertices != NULL);
+    assert(indices != NULL);
+    assert(ranges != NULL);
+
+    mesh->vertex_count = vertex_count;
+    mesh->index_count = index_count;
+    mesh->range_count = range_count;
+    mesh->ranges =
+        Memory_Alloc(sizeof(GFX_3D_STATIC_MESH_RANGE) * range_count);
+    memcpy(
+        mesh->ranges, ranges, sizeof(GFX_3D_STATIC_MESH_RANGE) * range_count);
+    mesh->lighting_version = 0;
+
+    // the element array binding belongs to the vertex array, so it has to
+    // be bound first
+    GFX_GL_VertexArray_Init(&mesh->vtc_format);
+    GFX_GL_VertexArray_Bind(&mesh->vtc_format);
+
+    GFX_GL_Buffer_Init(&mesh->vertex_buffer, GL_ARRAY_BUFFER);
+    GFX_GL_Buffer_Bind(&mesh->vertex_buffer);
+    GFX_GL_Buffer_Data(
+        &mesh->vertex_buffer, sizeof(GFX_3D_VERTEX) * vertex_count, vertices,
+        GL_STATIC_DRAW);
+
+    GFX_GL_Buffer_Init(&mesh->index_buffer, GL_ELEMENT_ARRAY_BUFFER);
+    GFX_GL_Buffer_Bind(&mesh->index_buffer);
+    GFX_GL_Buffer_Data(
+        &mesh->index_buffer, sizeof(uint32_t) * index_count, indices,
+        GL_STATIC_DRAW);
+
+    GFX_GL_VertexArray_Attribute(
+        &mesh->vtc_format, 0, 3, GL_FLOAT, GL_FALSE, 40, 0);
+    GFX_GL_VertexArray_Attribute(
+        &mesh->vtc_format, 1, 3, GL_FLOAT, GL_FALSE, 40, 12);
+    GFX_GL_VertexArray_Attribute(
+        &mesh->vtc_format, 2, 4, GL_FLOAT, GL_FALSE, 40, 24);
+
+    GFX_GL_CheckError();
+}
+
+void GFX_3D_StaticMesh_Close(GFX_3D_STATIC_MESH *const mesh)
+{
+    assert(mesh != NULL);
+    GFX_GL_VertexArray_Close(&mesh->vtc_format);
+    GFX_GL_Buffer_Close(&mesh->index_buffer);
+    GFX_GL_Buffer_Close(&mesh->vertex_buffer);
+    Memory_FreePointer(&mesh->ranges);
+}
+
+void GFX_3D_StaticMesh_UpdateVertices(
+    GFX_3D_STATIC_MESH *const mesh, const GFX_3D_VERTEX *const vertices)
+{
+    assert(mesh != NULL);
+    assert(vertices != NULL);
+    GFX_GL_Buffer_Bind(&mesh->vertex_buffer);
+    GFX_GL_Buffer_SubData(
+        &mesh->vertex_buffer, 0, sizeof(GFX_3D_VERTEX) * mesh->vertex_count,
+        vertices);
+}
+
+void GFX_3D_StaticMesh_Bind(GFX_3D_STATIC_MESH *const mesh)
+{
+    assert(mesh != NULL);
+    GFX_GL_VertexArray_Bind(&mesh->vtc_format);
+}
+
+void GFX_3D_StaticMesh_DrawRange(
+    const GFX_3D_STATIC_MESH *const mesh,
+    const GFX_3D_STATIC_MESH_RANGE *const range)
+{
+    assert(mesh != NULL);
+    assert(range != NULL);
+    assert(range->first_index >= 0);
+    assert(range->first_index + range->index_count <= mesh->index_count);
+    glDrawElements(
+        GL_TRIANGLES, range->index_count, GL_UNSIGNED_INT,
+        (const void *)(uintptr_t)(range->first_index * sizeof(uint32_t)));
+    GFX_GL_CheckError();
+}
@@ -0,0 +1,189 @@
+#include "gfx/3d/vertex_arena.h"
+
+#include "log.h"
+#include "memory.h"
+#include "utils.h"
+
+#include <assert.h>
+#include <string.h>
+
+static GFX_3D_VERTEX *M_AllocVertices(GFX_3D_VERTEX_ARENA *arena, int count);
+static GFX_3D_ARENA_CMD *M_AllocCommand(GFX_3D_VERTEX_ARENA *arena);
+static void M_PushState(
+    GFX_3D_VERTEX_ARENA *arena, GFX_3D_ARENA_CMD_TYPE type, int32_t value);
+
+static GFX_3D_VERTEX *M_AllocVertices(
+    GFX_3D_VERTEX_ARENA *const arena, const int count)
+{
+    const size_t first = arena->vertices.count;
+    if (first + count > arena->vertices.capacity) {
+        // grow geometrically so that a frame settles after a few reallocs
+        size_t capacity = MAX(arena->vertices.capacity * 2, 1024);
+        while (capacity < first + count) {
+            capacity *= 2;
+        }
+        arena->vertices.data = Memory_Realloc(
+            arena->vertices.data, capacity * sizeof(GFX_3D_VERTEX));
+        arena->vertices.capacity = capacity;
+    }
+    arena->vertices.count += count;
+
+    // merge with the previous batch of primitives if nothing came in between
+    GFX_3D_ARENA_CMD *cmd = NULL;
+    if (arena->commands.count > 0) {
+        cmd = &arena->commands.data[arena->commands.count - 1];
+    }
+    if (cmd == NULL || cmd->type != GFX_3D_ARENA_CMD_PRIMS) {
+        cmd = M_AllocCommand(arena);
+        cmd->type = GFX_3D_ARENA_CMD_PRIMS;
+        cmd->prims.first = first;
+        cmd->prims.count = 0;
+    }
+    cmd->prims.count += count;
+
+    return &arena->vertices.data[first];
+}
+
+static GFX_3D_ARENA_CMD *M_AllocCommand(GFX_3D_VERTEX_ARENA *const arena)
+{
+    if (arena->commands.count == arena->commands.capacity) {
+        arena->commands.capacity = MAX(arena->commands.capacity * 2, 64);
+        arena->commands.data = Memory_Realloc(
+            arena->commands.data,
+            arena->commands.capacity * sizeof(GFX_3D_ARENA_CMD));
+    }
+    return &arena->commands.data[arena->commands.count++];
+}
+
+static void M_PushState(
+    GFX_3D_VERTEX_ARENA *const arena, const GFX_3D_ARENA_CMD_TYPE type,
+    const int32_t value)
+{
+    GFX_3D_ARENA_CMD *const cmd = M_AllocCommand(arena);
+    cmd->type = type;
+    cmd->value = value;
+}
+
+void GFX_3D_VertexArena_Init(GFX_3D_VERTEX_ARENA *const arena)
+{
+    assert(arena != NULL);
+    arena->prim_type = GFX_3D_PRIM_TRI;
+    arena->vertices.data = NULL;
+    arena->vertices.count = 0;
+    arena->vertices.capacity = 0;
+    arena->commands.data = NULL;
+    arena->commands.count = 0;
+    arena->commands.capacity = 0;
+}
+
+void GFX_3D_VertexArena_Close(GFX_3D_VERTEX_ARENA *const arena)
+{
+    assert(arena != NULL);
+    Memory_FreePointer(&arena->vertices.data);
+    Memory_FreePointer(&arena->commands.data);
+    GFX_3D_VertexArena_Init(arena);
+}
+
+void GFX_3D_VertexArena_Reset(GFX_3D_VERTEX_ARENA *const arena)
+{
+    assert(arena != NULL);
+    arena->prim_type = GFX_3D_PRIM_TRI;
+    arena->vertices.count = 0;
+    arena->commands.count = 0;
+}
+
+bool GFX_3D_VertexArena_PushPrimStrip(
+    GFX_3D_VERTEX_ARENA *const arena, const GFX_3D_VERTEX *const vertices,
+    const int count)
+{
+    if (arena->prim_type != GFX_3D_PRIM_TRI) {
+        LOG_ERROR("Unsupported prim type: %d", arena->prim_type);
+        return false;
+    }
+
+    if (count <= 2) {
+        return GFX_3D_VertexArena_PushPrimList(arena, vertices, count);
+    }
+
+    // convert strip to raw triangles
+    GFX_3D_VERTEX *dst = M_AllocVertices(arena, (count - 2) * 3);
+    for (int i = 2; i < count; i++) {
+        // every other triangle of a strip is flipped to keep the winding
+        *dst++ = vertices[i % 2 ? i - 1 : i - 2];
+        *dst++ = vertices[i % 2 ? i - 2 : i - 1];
+        *dst++ = vertices[i];
+    }
+    return true;
+}
+
+bool GFX_3D_VertexArena_PushPrimFan(
+    GFX_3D_VERTEX_ARENA *const arena, const GFX_3D_VERTEX *const vertices,
+    const int count)
+{
+    if (arena->prim_type != GFX_3D_PRIM_TRI) {
+        LOG_ERROR("Unsupported prim type: %d", arena->prim_type);
+        return false;
+    }
+
+    if (count <= 2) {
+        return GFX_3D_VertexArena_PushPrimList(arena, vertices, count);
+    }
+
+    // convert fan to raw triangles
+    GFX_3D_VERTEX *dst = M_AllocVertices(arena, (count - 2) * 3);
+    for (int i = 2; i < count; i++) {
+        *dst++ = vertices[0];
+        *dst++ = vertices[i - 1];
+        *dst++ = vertices[i];
+    }
+    return true;
+}
+
+bool GFX_3D_VertexArena_PushPrimList(
+    GFX_3D_VERTEX_ARENA *const arena, const GFX_3D_VERTEX *const vertices,
+    const int count)
+{
+    if (count <= 0) {
+        return true;
+    }
+    GFX_3D_VERTEX *const dst = M_AllocVertices(arena, count);
+    memcpy(dst, vertices, count * sizeof(GFX_3D_VERTEX));
+    return true;
+}
+
+void GFX_3D_VertexArena_SetPrimType(
+    GFX_3D_VERTEX_ARENA *const arena, const GFX_3D_PRIM_TYPE prim_type)
+{
+    arena->prim_type = prim_type;
+    M_PushState(arena, GFX_3D_ARENA_CMD_SET_PRIM_TYPE, prim_type);
+}
+
+void GFX_3D_VertexArena_SelectTexture(
+    GFX_3D_VERTEX_ARENA *const arena, const int texture_num)
+{
+    M_PushState(arena, GFX_3D_ARENA_CMD_SELECT_TEXTURE, texture_num);
+}
+
+void GFX_3D_VertexArena_SetTextureFilter(
+    GFX_3D_VERTEX_ARENA *const arena, const GFX_TEXTURE_FILTER filter)
+{
+    M_PushState(arena, GFX_3D_ARENA_CMD_SET_TEXTURE_FILTER, filter);
+}
+
+void GFX_3D_VertexArena_SetDepthTestEnabled(
+    GFX_3D_VERTEX_ARENA *const arena, const bool is_enabled)
+{
+    M_PushState(arena, GFX_3D_ARENA_CMD_SET_DEPTH_TEST, is_enabled);
+}
+
+void GFX_3D_VertexArena_SetBlendingMode(
+    GFX_3D_VERTEX_ARENA *const arena, const GFX_BLEND_MODE blend_mode)
+{
+    M_PushState(arena, GFX_3D_ARENA_CMD_SET_BLENDING_MODE, blend_mode);
+}
+
+void GFX_3D_VertexArena_SetTexturingEnabled(
+    GFX_3D_VERTEX_ARENA *const arena, const bool is_enabled)
+{
+    M_PushState(arena, GFX_3D_ARENA_CMD_SET_TEXTURING, is_enabled);
+}
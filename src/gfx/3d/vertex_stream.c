@@ -4,28 +4,99 @@
 #include "gfx/gl/utils.h"
 #include "log.h"
 #include "memory.h"
+#include "utils.h"
+
+#include <string.h>
+
+#define M_MIN_CAPACITY 1024u
+// triangles tested together; the loops over a batch are written so that
+// the compiler can turn them into SIMD code
+#define M_CULL_BATCH 8
 
 static const GLenum GL_PRIM_MODES[] = {
     GL_LINES, // GFX_3D_PRIM_LINE
     GL_TRIANGLES, // GFX_3D_PRIM_TRI
 };
 
-static void M_PushVertex(
-    GFX_3D_VERTEX_STREAM *vertex_stream, GFX_3D_VERTEX *vertex);
+static bool M_IsCullingEnabled(const GFX_3D_VERTEX_STREAM *vertex_stream);
+static void M_CullTriangles(GFX_3D_VERTEX_STREAM *vertex_stream, size_t first);
 
-static void M_PushVertex(
-    GFX_3D_VERTEX_STREAM *vertex_stream, GFX_3D_VERTEX *vertex)
+static bool M_IsCullingEnabled(const GFX_3D_VERTEX_STREAM *const vertex_stream)
 {
-    if (vertex_stream->pending_vertices.count + 1
-        >= vertex_stream->pending_vertices.capacity) {
-        vertex_stream->pending_vertices.capacity += 1000;
-        vertex_stream->pending_vertices.data = Memory_Realloc(
-            vertex_stream->pending_vertices.data,
-            vertex_stream->pending_vertices.capacity * sizeof(GFX_3D_VERTEX));
+    return vertex_stream->prim_type == GFX_3D_PRIM_TRI
+        && (vertex_stream->culling.cull_offscreen
+            || vertex_stream->culling.cull_face != GFX_3D_CULL_FACE_NONE);
+}
+
+static void M_CullTriangles(
+    GFX_3D_VERTEX_STREAM *const vertex_stream, const size_t first)
+{
+    GFX_3D_VERTEX *const vertices = vertex_stream->pending_vertices.data;
+    const size_t end = vertex_stream->pending_vertices.count;
+    const size_t tri_count = (end - first) / 3;
+
+    const bool cull_offscreen = vertex_stream->culling.cull_offscreen;
+    const GFX_3D_CULL_FACE cull_face = vertex_stream->culling.cull_face;
+    const float left = vertex_stream->culling.left;
+    const float top = vertex_stream->culling.top;
+    const float right = vertex_stream->culling.right;
+    const float bottom = vertex_stream->culling.bottom;
+
+    size_t out = first;
+    for (size_t tri = 0; tri < tri_count; tri += M_CULL_BATCH) {
+        const int32_t n = MIN((size_t)M_CULL_BATCH, tri_count - tri);
+        const GFX_3D_VERTEX *const src = &vertices[first + tri * 3];
+
+        float x[3][M_CULL_BATCH];
+        float y[3][M_CULL_BATCH];
+        bool keep[M_CULL_BATCH];
+        for (int32_t i = 0; i < n; i++) {
+            for (int32_t j = 0; j < 3; j++) {
+                x[j][i] = src[i * 3 + j].x;
+                y[j][i] = src[i * 3 + j].y;
+            }
+        }
+
+        for (int32_t i = 0; i < n; i++) {
+            const bool is_offscreen =
+                (x[0][i] < left && x[1][i] < left && x[2][i] < left)
+                | (x[0][i] > right && x[1][i] > right && x[2][i] > right)
+                | (y[0][i] < top && y[1][i] < top && y[2][i] < top)
+                | (y[0][i] > bottom && y[1][i] > bottom && y[2][i] > bottom);
+            const float area = (x[1][i] - x[0][i]) * (y[2][i] - y[0][i])
+                - (x[2][i] - x[0][i]) * (y[1][i] - y[0][i]);
+            const bool is_backface =
+                (cull_face == GFX_3D_CULL_FACE_CW && area >= 0.0f)
+                | (cull_face == GFX_3D_CULL_FACE_CCW && area <= 0.0f);
+            keep[i] = !((cull_offscreen & is_offscreen) | is_backface);
+        }
+
+        for (int32_t i = 0; i < n; i++) {
+            if (!keep[i]) {
+                continue;
+            }
+            if (out != first + (tri + i) * 3) {
+                memcpy(&vertices[out], &src[i * 3], sizeof(GFX_3D_VERTEX) * 3);
+            }
+            out += 3;
+        }
     }
 
-    vertex_stream->pending_vertices
-        .data[vertex_stream->pending_vertices.count++] = *vertex;
+    const uint32_t kept = (out - first) / 3;
+    const uint32_t culled = tri_count - kept;
+
+    // a list that does not end on a whole triangle is passed through as is
+    const size_t tail = (end - first) % 3;
+    if (tail != 0 && out != end - tail) {
+        memmove(
+            &vertices[out], &vertices[end - tail], tail * sizeof(*vertices));
+    }
+    vertex_stream->pending_vertices.count = out + tail;
+
+    vertex_stream->culling.frame_kept += kept;
+    vertex_stream->culling.frame_culled += culled;
+    vertex_stream->stats.triangles_kept += kept;
+    vertex_stream->stats.triangles_culled += culled;
 }
 
 void GFX_3D_VertexStream_Init(GFX_3D_VERTEX_STREAM *vertex_stream)
@@ -35,6 +106,20 @@ void GFX_3D_VertexStream_Init(GFX_3D_VERTEX_STREAM *vertex_stream)
     vertex_stream->pending_vertices.data = NULL;
     vertex_stream->pending_vertices.count = 0;
     vertex_stream->pending_vertices.capacity = 0;
+    vertex_stream->pending_vertices.high_water_mark = 0;
+    vertex_stream->stats.draw_calls = 0;
+    vertex_stream->stats.vertices = 0;
+    vertex_stream->stats.uploaded_bytes = 0;
+    vertex_stream->stats.triangles_kept = 0;
+    vertex_stream->stats.triangles_culled = 0;
+    vertex_stream->culling.cull_offscreen = false;
+    vertex_stream->culling.cull_face = GFX_3D_CULL_FACE_NONE;
+    vertex_stream->culling.left = 0.0f;
+    vertex_stream->culling.top = 0.0f;
+    vertex_stream->culling.right = 0.0f;
+    vertex_stream->culling.bottom = 0.0f;
+    vertex_stream->culling.frame_kept = 0;
+    vertex_stream->culling.frame_culled = 0;
 
     GFX_GL_Buffer_Init(&vertex_stream->buffer, GL_ARRAY_BUFFER);
     GFX_GL_Buffer_Bind(&vertex_stream->buffer);
@@ -70,6 +155,61 @@ void GFX_3D_VertexStream_SetPrimType(
     vertex_stream->prim_type = prim_type;
 }
 
+void GFX_3D_VertexStream_SetCulling(
+    GFX_3D_VERTEX_STREAM *const vertex_stream, const bool cull_offscreen,
+    const GFX_3D_CULL_FACE cull_face)
+{
+    vertex_stream->culling.cull_offscreen = cull_offscreen;
+    vertex_stream->culling.cull_face = cull_face;
+}
+
+void GFX_3D_VertexStream_SetCullRect(
+    GFX_3D_VERTEX_STREAM *const vertex_stream, const float left,
+    const float top, const float right, const float bottom)
+{
+    vertex_stream->culling.left = left;
+    vertex_stream->culling.top = top;
+    vertex_stream->culling.right = right;
+    vertex_stream->culling.bottom = bottom;
+}
+
+void GFX_3D_VertexStream_ResetFrameStats(
+    GFX_3D_VERTEX_STREAM *const vertex_stream)
+{
+    vertex_stream->culling.frame_kept = 0;
+    vertex_stream->culling.frame_culled = 0;
+}
+
+void GFX_3D_VertexStream_Reserve(
+    GFX_3D_VERTEX_STREAM *const vertex_stream, const size_t count)
+{
+    const size_t required = vertex_stream->pending_vertices.count + count;
+    if (required <= vertex_stream->pending_vertices.capacity) {
+        return;
+    }
+
+    // grow geometrically; the storage is kept across frames, so a steady
+    // scene stops reallocating after the first few
+    size_t capacity =
+        MAX(vertex_stream->pending_vertices.capacity * 2, M_MIN_CAPACITY);
+    while (capacity < required) {
+        capacity *= 2;
+    }
+
+    vertex_stream->pending_vertices.data = Memory_Realloc(
+        vertex_stream->pending_vertices.data, capacity * sizeof(GFX_3D_VERTEX));
+    vertex_stream->pending_vertices.capacity = capacity;
+}
+
+GFX_3D_VERTEX *GFX_3D_VertexStream_PushVertices(
+    GFX_3D_VERTEX_STREAM *const vertex_stream, const size_t count)
+{
+    GFX_3D_VertexStream_Reserve(vertex_stream, count);
+    const size_t first = vertex_stream->pending_vertices.count;
+    vertex_stream->pending_vertices.count += count;
+    return &vertex_stream->pending_vertices.data[first];
+}
+
 bool GFX_3D_VertexStream_PushPrimStrip(
     GFX_3D_VERTEX_STREAM *vertex_stream, GFX_3D_VERTEX *vertices, int count)
 {
@@ -79,16 +219,21 @@ bool GFX_3D_VertexStream_PushPrimStrip(
     }
 
     if (count <= 2) {
-        for (int i = 0; i < count; i++) {
-            M_PushVertex(vertex_stream, &vertices[i]);
-        }
-    } else {
-        // convert strip to raw triangles
-        for (int i = 2; i < count; i++) {
-            M_PushVertex(vertex_stream, &vertices[i - 2]);
-            M_PushVertex(vertex_stream, &vertices[i - 1]);
-            M_PushVertex(vertex_stream, &vertices[i]);
-        }
+        return GFX_3D_VertexStream_PushPrimList(vertex_stream, vertices, count);
+    }
+
+    // convert strip to raw triangles
+    const size_t first = vertex_stream->pending_vertices.count;
+    GFX_3D_VERTEX *dst =
+        GFX_3D_VertexStream_PushVertices(vertex_stream, (count - 2) * 3);
+    for (int i = 2; i < count; i++) {
+        // every other triangle of a strip is flipped to keep the winding
+        *dst++ = vertices[i % 2 ? i - 1 : i - 2];
+        *dst++ = vertices[i % 2 ? i - 2 : i - 1];
+        *dst++ = vertices[i];
+    }
+    if (M_IsCullingEnabled(vertex_stream)) {
+        M_CullTriangles(vertex_stream, first);
     }
 
     return true;
@@ -103,16 +248,20 @@ bool GFX_3D_VertexStream_PushPrimFan(
     }
 
     if (count <= 2) {
-        for (int i = 0; i < count; i++) {
-            M_PushVertex(vertex_stream, &vertices[i]);
-        }
-    } else {
-        // convert fan to raw triangles
-        for (int i = 2; i < count; i++) {
-            M_PushVertex(vertex_stream, &vertices[0]);
-            M_PushVertex(vertex_stream, &vertices[i - 1]);
-            M_PushVertex(vertex_stream, &vertices[i]);
-        }
+        return GFX_3D_VertexStream_PushPrimList(vertex_stream, vertices, count);
+    }
+
+    // convert fan to raw triangles
+    const size_t first = vertex_stream->pending_vertices.count;
+    GFX_3D_VERTEX *dst =
+        GFX_3D_VertexStream_PushVertices(vertex_stream, (count - 2) * 3);
+    for (int i = 2; i < count; i++) {
+        *dst++ = vertices[0];
+        *dst++ = vertices[i - 1];
+        *dst++ = vertices[i];
+    }
+    if (M_IsCullingEnabled(vertex_stream)) {
+        M_CullTriangles(vertex_stream, first);
     }
 
     return true;
@@ -121,8 +270,15 @@ bool GFX_3D_VertexStream_PushPrimFan(
 bool GFX_3D_VertexStream_PushPrimList(
     GFX_3D_VERTEX_STREAM *vertex_stream, GFX_3D_VERTEX *vertices, int count)
 {
-    for (int i = 0; i < count; i++) {
-        M_PushVertex(vertex_stream, &vertices[i]);
+    if (count <= 0) {
+        return true;
+    }
+    const size_t first = vertex_stream->pending_vertices.count;
+    GFX_3D_VERTEX *const dst =
+        GFX_3D_VertexStream_PushVertices(vertex_stream, count);
+    memcpy(dst, vertices, count * sizeof(GFX_3D_VERTEX));
+    if (M_IsCullingEnabled(vertex_stream)) {
+        M_CullTriangles(vertex_stream, first);
     }
     return true;
 }
@@ -133,7 +289,14 @@ void GFX_3D_VertexStream_RenderPending(GFX_3D_VERTEX_STREAM *vertex_stream)
         return;
     }
 
+    if (vertex_stream->pending_vertices.count
+        > vertex_stream->pending_vertices.high_water_mark) {
+        vertex_stream->pending_vertices.high_water_mark =
+            vertex_stream->pending_vertices.count;
+    }
+
     GFX_GL_VertexArray_Bind(&vertex_stream->vtc_format);
+    GFX_GL_Buffer_Bind(&vertex_stream->buffer);
 
     // resize GPU buffer if required
     size_t buffer_size =
@@ -156,5 +319,9 @@ void GFX_3D_VertexStream_RenderPending(GFX_3D_VERTEX_STREAM *vertex_stream)
         vertex_stream->pending_vertices.count);
     GFX_GL_CheckError();
 
+    vertex_stream->stats.draw_calls++;
+    vertex_stream->stats.vertices += vertex_stream->pending_vertices.count;
+    vertex_stream->stats.uploaded_bytes += buffer_size;
+
     vertex_stream->pending_vertices.count = 0;
 }
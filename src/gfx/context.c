@@ -2,19 +2,38 @@
 
 #include "game/shell.h"
 #include "gfx/gl/gl_core_3_3.h"
+#include "gfx/gl/state.h"
 #include "gfx/gl/utils.h"
+#include "gfx/profiler.h"
+#include "gfx/recorder.h"
 #include "gfx/renderers/fbo_renderer.h"
 #include "gfx/renderers/legacy_renderer.h"
 #include "gfx/screenshot.h"
 #include "log.h"
 #include "memory.h"
+#include "utils.h"
 
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_error.h>
+#include <SDL2/SDL_hints.h>
 #include <SDL2/SDL_video.h>
-#include <string.h>
+#include <math.h>
+
+// number of frames the dynamic resolution waits before adjusting the scale
+// again, so that the timings can settle
+#define M_DYNRES_COOLDOWN 30
+// frame time headroom below which the resolution is raised again
+#define M_DYNRES_RAISE_THRESHOLD 0.85
+// frame time excess above which the resolution is lowered
+#define M_DYNRES_LOWER_THRESHOLD 1.05
+// scales are kept on a coarse grid so small timing noise doesn't resize
+#define M_DYNRES_STEP (1.0f / 32.0f)
 
 typedef struct {
     SDL_GLContext context;
     SDL_Window *window_handle;
+    // set when the window was created by GFX_Context_AttachHeadless
+    bool is_headless;
 
     GFX_CONFIG config;
     GFX_RENDER_MODE render_mode;
@@ -23,6 +42,14 @@ typedef struct {
     int32_t window_width;
     int32_t window_height;
 
+    bool has_sync;
+    uint32_t frame_num;
+    GLsync frame_fences[GFX_MAX_FRAMES_IN_FLIGHT];
+
+    float render_scale;
+    double frame_ms_average;
+    int32_t dynres_cooldown;
+
     char *scheduled_screenshot_path;
     GFX_RENDERER *renderer;
     GFX_2D_RENDERER renderer_2d;
@@ -31,37 +58,100 @@ typedef struct {
 
 static GFX_CONTEXT m_Context = { 0 };
 
-static bool M_IsExtensionSupported(const char *name);
 static void M_CheckExtensionSupport(const char *name);
+static void M_WaitForFrame(uint32_t frame_num);
+static void M_DeleteFrameFences(void);
+static void M_UpdateDynamicResolution(double work_ms);
 
-static bool M_IsExtensionSupported(const char *name)
+static void M_CheckExtensionSupport(const char *name)
 {
-    int number_of_extensions;
+    LOG_INFO(
+        "%s supported: %s", name,
+        GFX_GL_IsExtensionSupported(name) ? "yes" : "no");
+}
 
-    glGetIntegerv(GL_NUM_EXTENSIONS, &number_of_extensions);
-    GFX_GL_CheckError();
+static void M_WaitForFrame(const uint32_t frame_num)
+{
+    GLsync *const fence =
+        &m_Context.frame_fences[frame_num % GFX_MAX_FRAMES_IN_FLIGHT];
+    if (*fence == NULL) {
+        return;
+    }
 
-    for (int i = 0; i < number_of_extensions; i++) {
-        const char *gl_ext = (const char *)glGetStringi(GL_EXTENSIONS, i);
-        GFX_GL_CheckError();
+    // wait in short slices so that a lost context cannot hang the game
+    const GLuint64 timeout = 100 * 1000 * 1000; // 100 ms
+    for (int32_t i = 0; i < 10; i++) {
+        const GLenum result =
+            glClientWaitSync(*fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+        if (result != GL_TIMEOUT_EXPIRED) {
+            if (result == GL_WAIT_FAILED) {
+                GFX_GL_CheckError();
+            }
+            break;
+        }
+    }
 
-        if (gl_ext && !strcmp(gl_ext, name)) {
-            return true;
+    glDeleteSync(*fence);
+    GFX_GL_CheckError();
+    *fence = NULL;
+}
+
+static void M_DeleteFrameFences(void)
+{
+    for (int32_t i = 0; i < GFX_MAX_FRAMES_IN_FLIGHT; i++) {
+        if (m_Context.frame_fences[i] != NULL) {
+            glDeleteSync(m_Context.frame_fences[i]);
+            m_Context.frame_fences[i] = NULL;
         }
     }
-    return false;
+    GFX_GL_CheckError();
 }
 
-static void M_CheckExtensionSupport(const char *name)
+static void M_UpdateDynamicResolution(const double work_ms)
 {
-    LOG_INFO(
-        "%s supported: %s", name, M_IsExtensionSupported(name) ? "yes" : "no");
+    const GFX_CONFIG *const config = &m_Context.config;
+    if (m_Context.frame_ms_average <= 0.0) {
+        m_Context.frame_ms_average = work_ms;
+    } else {
+        m_Context.frame_ms_average =
+            m_Context.frame_ms_average * 0.9 + work_ms * 0.1;
+    }
+
+    if (m_Context.dynres_cooldown > 0) {
+        m_Context.dynres_cooldown--;
+        return;
+    }
+
+    const double target_ms = 1000.0 / config->target_fps;
+    const double load = m_Context.frame_ms_average / target_ms;
+    float scale = m_Context.render_scale;
+    if (load > M_DYNRES_LOWER_THRESHOLD) {
+        // the cost is roughly proportional to the pixel count
+        scale *= sqrt(1.0 / load);
+    } else if (load < M_DYNRES_RAISE_THRESHOLD) {
+        // raise slowly to avoid oscillating around the target
+        scale += 2 * M_DYNRES_STEP;
+    } else {
+        return;
+    }
+
+    scale = roundf(scale / M_DYNRES_STEP) * M_DYNRES_STEP;
+    CLAMP(scale, GFX_MIN_RENDER_SCALE, config->render_scale);
+    if (scale != m_Context.render_scale) {
+        LOG_DEBUG(
+            "Dynamic resolution: %.3f (%.2f ms, target %.2f ms)", scale,
+            m_Context.frame_ms_average, target_ms);
+        m_Context.render_scale = scale;
+        m_Context.dynres_cooldown = M_DYNRES_COOLDOWN;
+        // the renderer already set up the viewport for the next frame
+        GFX_Context_SwitchToDisplayViewport();
+    }
 }
 
 void GFX_Context_SwitchToWindowViewport(void)
 {
-    glViewport(0, 0, m_Context.window_width, m_Context.window_height);
-    GFX_GL_CheckError();
+    GFX_GL_State_Viewport(
+        0, 0, m_Context.window_width, m_Context.window_height);
 }
 
 void GFX_Context_SwitchToWindowViewportAR(void)
@@ -89,14 +179,13 @@ void GFX_Context_SwitchToWindowViewportAR(void)
         vp_height = max_h;
     }
 
-    glViewport(vp_x, vp_y, vp_width, vp_height);
-    GFX_GL_CheckError();
+    GFX_GL_State_Viewport(vp_x, vp_y, vp_width, vp_height);
 }
 
 void GFX_Context_SwitchToDisplayViewport(void)
 {
-    glViewport(0, 0, m_Context.display_width, m_Context.display_height);
-    GFX_GL_CheckError();
+    GFX_GL_State_Viewport(
+        0, 0, GFX_Context_GetRenderWidth(), GFX_Context_GetRenderHeight());
 }
 
 void GFX_Context_Attach(void *window_handle)
@@ -111,6 +200,18 @@ void GFX_Context_Attach(void *window_handle)
 
     m_Context.config.line_width = 1;
     m_Context.config.enable_wireframe = false;
+    m_Context.config.frame_pacing = GFX_FP_LATENCY;
+    m_Context.config.max_frames_in_flight = 2;
+    m_Context.config.enable_pbo_uploads = false;
+    m_Context.config.render_scale = GFX_MAX_RENDER_SCALE;
+    m_Context.config.enable_dynamic_resolution = false;
+    m_Context.config.target_fps = 60;
+    m_Context.config.env_map_interval = 1;
+    m_Context.config.env_map_size = 0;
+    m_Context.config.enable_env_map_mipmaps = false;
+    m_Context.render_scale = GFX_MAX_RENDER_SCALE;
+    m_Context.frame_ms_average = 0.0;
+    m_Context.dynres_cooldown = 0;
     m_Context.render_mode = -1;
     SDL_GetWindowSize(
         window_handle, &m_Context.window_width, &m_Context.window_height);
@@ -136,6 +237,8 @@ void GFX_Context_Attach(void *window_handle)
         Shell_ExitSystem("Can't activate OpenGL context");
     }
 
+    GFX_GL_State_Reset();
+
     LOG_INFO("OpenGL vendor string:   %s", glGetString(GL_VENDOR));
     LOG_INFO("OpenGL renderer string: %s", glGetString(GL_RENDERER));
     LOG_INFO("OpenGL version string:  %s", glGetString(GL_VERSION));
@@ -151,8 +254,14 @@ void GFX_Context_Attach(void *window_handle)
     if (GFX_GL_DEFAULT_BACKEND == GFX_GL_21) {
         M_CheckExtensionSupport("GL_ARB_explicit_attrib_location");
         M_CheckExtensionSupport("GL_EXT_gpu_shader4");
+        M_CheckExtensionSupport("GL_ARB_sync");
     }
 
+    // fences are core since OpenGL 3.2; without them fall back to glFinish
+    m_Context.has_sync = GFX_GL_DEFAULT_BACKEND == GFX_GL_33C
+        || GFX_GL_IsExtensionSupported("GL_ARB_sync");
+    m_Context.frame_num = 0;
+
     glClearColor(0, 0, 0, 0);
     glClearDepth(1);
     GFX_GL_CheckError();
@@ -160,8 +269,9 @@ void GFX_Context_Attach(void *window_handle)
     // VSync defaults to on unless user disabled it in runtime json
     SDL_GL_SetSwapInterval(1);
 
-    GFX_2D_Renderer_Init(&m_Context.renderer_2d);
+    GFX_2D_Renderer_Init(&m_Context.renderer_2d, &m_Context.config);
     GFX_3D_Renderer_Init(&m_Context.renderer_3d, &m_Context.config);
+    GFX_Profiler_Init();
 }
 
 void GFX_Context_Detach(void)
@@ -174,6 +284,10 @@ void GFX_Context_Detach(void)
         m_Context.renderer->shutdown(m_Context.renderer);
     }
 
+    GFX_Recorder_Stop();
+    GFX_Screenshot_Shutdown();
+    M_DeleteFrameFences();
+    GFX_Profiler_Shutdown();
     GFX_2D_Renderer_Close(&m_Context.renderer_2d);
     GFX_3D_Renderer_Close(&m_Context.renderer_3d);
 
@@ -183,9 +297,53 @@ void GFX_Context_Detach(void)
         SDL_GL_DeleteContext(m_Context.context);
         m_Context.context = NULL;
     }
+    if (m_Context.is_headless) {
+        SDL_DestroyWindow(m_Context.window_handle);
+        SDL_QuitSubSystem(SDL_INIT_VIDEO);
+        m_Context.is_headless = false;
+    }
     m_Context.window_handle = NULL;
 }
 
+bool GFX_Context_AttachHeadless(const int32_t width, const int32_t height)
+{
+    if (m_Context.window_handle) {
+        LOG_ERROR("Context is already attached");
+        return false;
+    }
+
+    // SDL's offscreen driver renders through EGL without any display
+    // server; pair it with LIBGL_ALWAYS_SOFTWARE=1 to use llvmpipe on
+    // machines without a GPU. Respect an explicitly requested driver.
+    SDL_SetHintWithPriority(
+        SDL_HINT_VIDEODRIVER, "offscreen", SDL_HINT_DEFAULT);
+    if (SDL_InitSubSystem(SDL_INIT_VIDEO) != 0) {
+        LOG_ERROR("Cannot initialize headless video: %s", SDL_GetError());
+        return false;
+    }
+
+    if (GFX_GL_DEFAULT_BACKEND == GFX_GL_33C) {
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+        SDL_GL_SetAttribute(
+            SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+    }
+
+    SDL_Window *const window = SDL_CreateWindow(
+        "libtrx", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, width,
+        height, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    if (window == NULL) {
+        LOG_ERROR("Cannot create headless window: %s", SDL_GetError());
+        SDL_QuitSubSystem(SDL_INIT_VIDEO);
+        return false;
+    }
+
+    LOG_INFO("Using video driver: %s", SDL_GetCurrentVideoDriver());
+    GFX_Context_Attach(window);
+    m_Context.is_headless = true;
+    return true;
+}
+
 void GFX_Context_SetDisplayFilter(const GFX_TEXTURE_FILTER filter)
 {
     m_Context.config.display_filter = filter;
@@ -213,6 +371,49 @@ void GFX_Context_SetVSync(bool vsync)
     SDL_GL_SetSwapInterval(vsync);
 }
 
+void GFX_Context_SetFramePacing(const GFX_FRAME_PACING frame_pacing)
+{
+    m_Context.config.frame_pacing = frame_pacing;
+}
+
+void GFX_Context_SetMaxFramesInFlight(int32_t max_frames_in_flight)
+{
+    CLAMP(max_frames_in_flight, 1, GFX_MAX_FRAMES_IN_FLIGHT);
+    m_Context.config.max_frames_in_flight = max_frames_in_flight;
+}
+
+void GFX_Context_SetPBOUploads(const bool enable)
+{
+    m_Context.config.enable_pbo_uploads = enable;
+}
+
+void GFX_Context_SetRenderScale(float render_scale)
+{
+    CLAMP(render_scale, GFX_MIN_RENDER_SCALE, GFX_MAX_RENDER_SCALE);
+    m_Context.config.render_scale = render_scale;
+    m_Context.render_scale = render_scale;
+}
+
+void GFX_Context_SetDynamicResolution(const bool enable, int32_t target_fps)
+{
+    CLAMP(target_fps, 1, 1000);
+    m_Context.config.enable_dynamic_resolution = enable;
+    m_Context.config.target_fps = target_fps;
+    m_Context.render_scale = m_Context.config.render_scale;
+    m_Context.frame_ms_average = 0.0;
+    m_Context.dynres_cooldown = M_DYNRES_COOLDOWN;
+}
+
+void GFX_Context_SetEnvironmentMapQuality(
+    int32_t interval, int32_t size, const bool enable_mipmaps)
+{
+    CLAMPL(interval, 1);
+    CLAMPL(size, 0);
+    m_Context.config.env_map_interval = interval;
+    m_Context.config.env_map_size = size;
+    m_Context.config.enable_env_map_mipmaps = enable_mipmaps;
+}
+
 void GFX_Context_SetWindowSize(int32_t width, int32_t height)
 {
     LOG_INFO("Window size: %dx%d", width, height);
@@ -281,6 +482,32 @@ int32_t GFX_Context_GetDisplayHeight(void)
     return m_Context.display_height;
 }
 
+int32_t GFX_Context_GetRenderWidth(void)
+{
+    return MAX(
+        1, lroundf(m_Context.display_width * GFX_Context_GetRenderScale()));
+}
+
+int32_t GFX_Context_GetRenderHeight(void)
+{
+    return MAX(
+        1, lroundf(m_Context.display_height * GFX_Context_GetRenderScale()));
+}
+
+float GFX_Context_GetRenderScale(void)
+{
+    // only the framebuffer renderer has anything to upscale from
+    if (m_Context.render_mode != GFX_RM_FRAMEBUFFER) {
+        return GFX_MAX_RENDER_SCALE;
+    }
+    return m_Context.render_scale;
+}
+
+bool GFX_Context_IsFenceSupported(void)
+{
+    return m_Context.has_sync;
+}
+
 void GFX_Context_Clear(void)
 {
     if (m_Context.config.enable_wireframe) {
@@ -293,13 +520,55 @@ void GFX_Context_Clear(void)
 
 void GFX_Context_SwapBuffers(void)
 {
-    glFinish();
-    GFX_GL_CheckError();
+    const uint32_t frames_in_flight = m_Context.config.max_frames_in_flight;
+
+    if (!m_Context.has_sync) {
+        glFinish();
+        GFX_GL_CheckError();
+    } else if (m_Context.config.frame_pacing == GFX_FP_THROUGHPUT) {
+        // the CPU had the whole frame to run ahead; only now make sure the
+        // GPU is not more than the allowed number of frames behind
+        M_WaitForFrame(m_Context.frame_num - frames_in_flight);
+    }
 
     if (m_Context.renderer != NULL
         && m_Context.renderer->swap_buffers != NULL) {
         m_Context.renderer->swap_buffers(m_Context.renderer);
     }
+
+    GFX_Screenshot_Update(false);
+
+    if (m_Context.has_sync) {
+        const int32_t slot = m_Context.frame_num % GFX_MAX_FRAMES_IN_FLIGHT;
+        GLsync *const fence = &m_Context.frame_fences[slot];
+        if (*fence != NULL) {
+            glDeleteSync(*fence);
+        }
+        *fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        GFX_GL_CheckError();
+
+        if (m_Context.config.frame_pacing == GFX_FP_LATENCY) {
+            // keep input sampling close to presentation by not letting the
+            // next frame start until the GPU has caught up
+            M_WaitForFrame(m_Context.frame_num + 1 - frames_in_flight);
+        }
+        m_Context.frame_num++;
+    }
+
+    // the load is the GPU time spent in the render passes: the frame limiter,
+    // vsync and the fence waits above are idle time that a lower resolution
+    // would not shorten
+    const bool use_dynres = m_Context.config.enable_dynamic_resolution
+        && m_Context.render_mode == GFX_RM_FRAMEBUFFER;
+    GFX_Profiler_SetRequired(use_dynres);
+    GFX_Profiler_EndFrame();
+    if (use_dynres) {
+        // zero until the first frame is resolved
+        const double work_ms = GFX_Profiler_GetStats()->work_ms;
+        if (work_ms > 0.0) {
+            M_UpdateDynamicResolution(work_ms);
+        }
+    }
 }
 
 void GFX_Context_ScheduleScreenshot(const char *path)
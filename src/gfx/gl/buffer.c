@@ -1,5 +1,6 @@
 #include "gfx/gl/buffer.h"
 
+#include "gfx/gl/state.h"
 #include "gfx/gl/utils.h"
 
 #include <assert.h>
@@ -15,6 +16,7 @@ void GFX_GL_Buffer_Init(GFX_GL_BUFFER *buf, GLenum target)
 void GFX_GL_Buffer_Close(GFX_GL_BUFFER *buf)
 {
     assert(buf);
+    GFX_GL_State_ForgetBuffer(buf->id);
     glDeleteBuffers(1, &buf->id);
     GFX_GL_CheckError();
 }
@@ -22,8 +24,7 @@ void GFX_GL_Buffer_Close(GFX_GL_BUFFER *buf)
 void GFX_GL_Buffer_Bind(GFX_GL_BUFFER *buf)
 {
     assert(buf);
-    glBindBuffer(buf->target, buf->id);
-    GFX_GL_CheckError();
+    GFX_GL_State_BindBuffer(buf->target, buf->id);
 }
 
 void GFX_GL_Buffer_Data(
@@ -2,17 +2,286 @@
 
 #include "filesystem.h"
 #include "game/shell.h"
+#include "gfx/gl/state.h"
 #include "gfx/gl/utils.h"
 #include "log.h"
 #include "memory.h"
 
 #include <assert.h>
 #include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 
+#define M_CACHE_DIR "cache"
+#define M_CACHE_SHADER_DIR M_CACHE_DIR "/shaders"
+#define M_CACHE_MAGIC 0x50585254 // TRXP
+#define M_CACHE_VERSION 1
+
+typedef enum {
+    M_BINARY_UNKNOWN,
+    M_BINARY_UNSUPPORTED,
+    M_BINARY_SUPPORTED,
+} M_BINARY_SUPPORT;
+
+static M_BINARY_SUPPORT m_BinarySupport = M_BINARY_UNKNOWN;
+
+static uint64_t M_Hash(uint64_t hash, const void *data, size_t size);
+static bool M_IsBinaryCacheSupported(void);
+static char *M_GetDriverString(void);
+static uint64_t M_GetCacheKey(
+    const GFX_GL_PROGRAM *program, const char *driver);
+static char *M_GetCachePath(uint64_t key);
+static bool M_ReadU32(const char **data, const char *end, uint32_t *value);
+static bool M_LoadBinary(
+    GFX_GL_PROGRAM *program, const char *path, uint64_t key,
+    const char *driver);
+static void M_SaveBinary(
+    GFX_GL_PROGRAM *program, const char *path, uint64_t key,
+    const char *driver);
+static void M_CompileShader(
+    GFX_GL_PROGRAM *program, GLenum type, char *source);
+static void M_FreeShaderSources(GFX_GL_PROGRAM *program);
+
+static uint64_t M_Hash(
+    uint64_t hash, const void *const data, const size_t size)
+{
+    // FNV-1a
+    const uint8_t *const bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+static bool M_IsBinaryCacheSupported(void)
+{
+    if (m_BinarySupport == M_BINARY_UNKNOWN) {
+        GLint format_count = 0;
+        if (GFX_GL_IsExtensionSupported("GL_ARB_get_program_binary")) {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+            GFX_GL_CheckError();
+        }
+        // some drivers expose the extension without any binary format
+        m_BinarySupport =
+            format_count > 0 ? M_BINARY_SUPPORTED : M_BINARY_UNSUPPORTED;
+        LOG_INFO(
+            "Shader program binary cache: %s",
+            m_BinarySupport == M_BINARY_SUPPORTED ? "enabled" : "unavailable");
+    }
+    return m_BinarySupport == M_BINARY_SUPPORTED;
+}
+
+static char *M_GetDriverString(void)
+{
+    const char *const vendor = (const char *)glGetString(GL_VENDOR);
+    const char *const renderer = (const char *)glGetString(GL_RENDERER);
+    const char *const version = (const char *)glGetString(GL_VERSION);
+    GFX_GL_CheckError();
+
+    const char *const fmt = "%s\n%s\n%s";
+    const size_t size = snprintf(
+                            NULL, 0, fmt, vendor ? vendor : "",
+                            renderer ? renderer : "", version ? version : "")
+        + 1;
+    char *const result = Memory_Alloc(size);
+    snprintf(
+        result, size, fmt, vendor ? vendor : "", renderer ? renderer : "",
+        version ? version : "");
+    return result;
+}
+
+static uint64_t M_GetCacheKey(
+    const GFX_GL_PROGRAM *const program, const char *const driver)
+{
+    const uint32_t version = M_CACHE_VERSION;
+    const GFX_GL_BACKEND backend = GFX_GL_DEFAULT_BACKEND;
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    hash = M_Hash(hash, &version, sizeof(version));
+    hash = M_Hash(hash, &backend, sizeof(backend));
+    hash = M_Hash(hash, driver, strlen(driver) + 1);
+    for (int32_t i = 0; i < program->shader_count; i++) {
+        const char *const source = program->shader_sources[i];
+        hash = M_Hash(
+            hash, &program->shader_types[i], sizeof(program->shader_types[i]));
+        hash = M_Hash(hash, source, strlen(source) + 1);
+    }
+    return hash;
+}
+
+static char *M_GetCachePath(const uint64_t key)
+{
+    const char *const fmt = M_CACHE_SHADER_DIR "/%016llx.bin";
+    const size_t size = snprintf(NULL, 0, fmt, (unsigned long long)key) + 1;
+    char *const path = Memory_Alloc(size);
+    snprintf(path, size, fmt, (unsigned long long)key);
+    return path;
+}
+
+static bool M_ReadU32(
+    const char **const data, const char *const end, uint32_t *const value)
+{
+    if (end - *data < (ptrdiff_t)sizeof(uint32_t)) {
+        return false;
+    }
+    memcpy(value, *data, sizeof(uint32_t));
+    *data += sizeof(uint32_t);
+    return true;
+}
+
+static bool M_LoadBinary(
+    GFX_GL_PROGRAM *const program, const char *const path, const uint64_t key,
+    const char *const driver)
+{
+    if (!File_Exists(path)) {
+        return false;
+    }
+
+    char *content = NULL;
+    size_t size = 0;
+    if (!File_Load(path, &content, &size)) {
+        return false;
+    }
+
+    bool result = false;
+    const char *data = content;
+    const char *const end = content + size;
+    const size_t driver_size = strlen(driver);
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t key_lo;
+    uint32_t key_hi;
+    uint32_t stored_driver_size;
+    uint32_t format;
+    uint32_t length;
+    if (!M_ReadU32(&data, end, &magic) || magic != M_CACHE_MAGIC
+        || !M_ReadU32(&data, end, &version) || version != M_CACHE_VERSION
+        || !M_ReadU32(&data, end, &key_lo) || !M_ReadU32(&data, end, &key_hi)
+        || (((uint64_t)key_hi << 32) | key_lo) != key
+        || !M_ReadU32(&data, end, &stored_driver_size)
+        || stored_driver_size != driver_size
+        || end - data < (ptrdiff_t)driver_size
+        || memcmp(data, driver, driver_size) != 0) {
+        LOG_INFO("Ignoring stale shader cache entry: %s", path);
+        goto cleanup;
+    }
+    data += driver_size;
+
+    if (!M_ReadU32(&data, end, &format) || !M_ReadU32(&data, end, &length)
+        || end - data != (ptrdiff_t)length) {
+        LOG_INFO("Ignoring corrupt shader cache entry: %s", path);
+        goto cleanup;
+    }
+
+    glProgramBinary(program->id, format, data, length);
+    GFX_GL_CheckError();
+
+    // the driver rejects binaries it cannot use, for example after an update
+    GLint link_status = GL_FALSE;
+    glGetProgramiv(program->id, GL_LINK_STATUS, &link_status);
+    GFX_GL_CheckError();
+    result = link_status == GL_TRUE;
+    if (!result) {
+        LOG_INFO("Driver rejected cached shader program: %s", path);
+    }
+
+cleanup:
+    Memory_FreePointer(&content);
+    return result;
+}
+
+static void M_SaveBinary(
+    GFX_GL_PROGRAM *const program, const char *const path, const uint64_t key,
+    const char *const driver)
+{
+    GLint length = 0;
+    glGetProgramiv(program->id, GL_PROGRAM_BINARY_LENGTH, &length);
+    GFX_GL_CheckError();
+    if (length <= 0) {
+        return;
+    }
+
+    GLenum format = 0;
+    char *binary = Memory_Alloc(length);
+    glGetProgramBinary(program->id, length, &length, &format, binary);
+    GFX_GL_CheckError();
+
+    File_CreateDirectory(M_CACHE_DIR);
+    File_CreateDirectory(M_CACHE_SHADER_DIR);
+    MYFILE *const fp = File_Open(path, FILE_OPEN_WRITE);
+    if (fp == NULL) {
+        LOG_ERROR("Cannot write shader cache entry: %s", path);
+        goto cleanup;
+    }
+
+    const uint32_t driver_size = strlen(driver);
+    File_WriteU32(fp, M_CACHE_MAGIC);
+    File_WriteU32(fp, M_CACHE_VERSION);
+    File_WriteU32(fp, (uint32_t)key);
+    File_WriteU32(fp, (uint32_t)(key >> 32));
+    File_WriteU32(fp, driver_size);
+    File_WriteData(fp, driver, driver_size);
+    File_WriteU32(fp, format);
+    File_WriteU32(fp, length);
+    File_WriteData(fp, binary, length);
+    File_Close(fp);
+
+cleanup:
+    Memory_FreePointer(&binary);
+}
+
+static void M_CompileShader(
+    GFX_GL_PROGRAM *const program, const GLenum type, char *const source)
+{
+    GLuint shader_id = glCreateShader(type);
+    GFX_GL_CheckError();
+    if (!shader_id) {
+        Shell_ExitSystem("Failed to create shader");
+    }
+
+    glShaderSource(shader_id, 1, (const char *const *)&source, NULL);
+
+    GFX_GL_CheckError();
+    glCompileShader(shader_id);
+    GFX_GL_CheckError();
+
+    int compile_status;
+    glGetShaderiv(shader_id, GL_COMPILE_STATUS, &compile_status);
+    GFX_GL_CheckError();
+
+    if (compile_status != GL_TRUE) {
+        GLsizei info_log_size = 4096;
+        char info_log[info_log_size];
+        glGetShaderInfoLog(shader_id, info_log_size, &info_log_size, info_log);
+        GFX_GL_CheckError();
+
+        if (info_log[0]) {
+            Shell_ExitSystemFmt("Shader compilation failed:\n%s", info_log);
+        } else {
+            Shell_ExitSystemFmt("Shader compilation failed.");
+        }
+    }
+
+    glAttachShader(program->id, shader_id);
+    GFX_GL_CheckError();
+
+    glDeleteShader(shader_id);
+    GFX_GL_CheckError();
+}
+
+static void M_FreeShaderSources(GFX_GL_PROGRAM *const program)
+{
+    for (int32_t i = 0; i < program->shader_count; i++) {
+        Memory_FreePointer(&program->shader_sources[i]);
+    }
+    program->shader_count = 0;
+}
+
 bool GFX_GL_Program_Init(GFX_GL_PROGRAM *program)
 {
     assert(program);
+    program->shader_count = 0;
     program->id = glCreateProgram();
     GFX_GL_CheckError();
     if (!program->id) {
@@ -24,7 +293,9 @@ bool GFX_GL_Program_Init(GFX_GL_PROGRAM *program)
 
 void GFX_GL_Program_Close(GFX_GL_PROGRAM *program)
 {
+    M_FreeShaderSources(program);
     if (program->id) {
+        GFX_GL_State_ForgetProgram(program->id);
         glDeleteProgram(program->id);
         GFX_GL_CheckError();
         program->id = 0;
@@ -33,8 +304,7 @@ void GFX_GL_Program_Close(GFX_GL_PROGRAM *program)
 
 void GFX_GL_Program_Bind(GFX_GL_PROGRAM *program)
 {
-    glUseProgram(program->id);
-    GFX_GL_CheckError();
+    GFX_GL_State_UseProgram(program->id);
 }
 
 char *GFX_GL_Program_PreprocessShader(
@@ -85,11 +355,7 @@ char *GFX_GL_Program_PreprocessShader(
 void GFX_GL_Program_AttachShader(
     GFX_GL_PROGRAM *program, GLenum type, const char *path)
 {
-    GLuint shader_id = glCreateShader(type);
-    GFX_GL_CheckError();
-    if (!shader_id) {
-        Shell_ExitSystem("Failed to create shader");
-    }
+    assert(program->shader_count < GFX_GL_PROGRAM_MAX_SHADERS);
 
     char *content = NULL;
     if (!File_Load(path, &content, NULL)) {
@@ -103,40 +369,38 @@ void GFX_GL_Program_AttachShader(
         Shell_ExitSystemFmt("Failed to pre-process shader source:  %s", path);
     }
 
-    glShaderSource(shader_id, 1, (const char *const *)&processed_content, NULL);
-
-    GFX_GL_CheckError();
-    glCompileShader(shader_id);
-    GFX_GL_CheckError();
-
-    int compile_status;
-    glGetShaderiv(shader_id, GL_COMPILE_STATUS, &compile_status);
-    GFX_GL_CheckError();
-
-    if (compile_status != GL_TRUE) {
-        GLsizei info_log_size = 4096;
-        char info_log[info_log_size];
-        glGetShaderInfoLog(shader_id, info_log_size, &info_log_size, info_log);
-        GFX_GL_CheckError();
+    program->shader_types[program->shader_count] = type;
+    program->shader_sources[program->shader_count] = processed_content;
+    program->shader_count++;
+}
 
-        if (info_log[0]) {
-            Shell_ExitSystemFmt("Shader compilation failed:\n%s", info_log);
-        } else {
-            Shell_ExitSystemFmt("Shader compilation failed.");
+void GFX_GL_Program_Link(GFX_GL_PROGRAM *program)
+{
+    char *driver = NULL;
+    char *cache_path = NULL;
+    uint64_t key = 0;
+
+    const bool use_cache = M_IsBinaryCacheSupported();
+    if (use_cache) {
+        driver = M_GetDriverString();
+        key = M_GetCacheKey(program, driver);
+        cache_path = M_GetCachePath(key);
+        if (M_LoadBinary(program, cache_path, key, driver)) {
+            goto cleanup;
         }
     }
 
-    Memory_FreePointer(&processed_content);
-
-    glAttachShader(program->id, shader_id);
-    GFX_GL_CheckError();
+    for (int32_t i = 0; i < program->shader_count; i++) {
+        M_CompileShader(
+            program, program->shader_types[i], program->shader_sources[i]);
+    }
 
-    glDeleteShader(shader_id);
-    GFX_GL_CheckError();
-}
+    if (use_cache) {
+        glProgramParameteri(
+            program->id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        GFX_GL_CheckError();
+    }
 
-void GFX_GL_Program_Link(GFX_GL_PROGRAM *program)
-{
     glLinkProgram(program->id);
     GFX_GL_CheckError();
 
@@ -156,6 +420,15 @@ void GFX_GL_Program_Link(GFX_GL_PROGRAM *program)
             Shell_ExitSystemFmt("Shader linking failed.");
         }
     }
+
+    if (use_cache) {
+        M_SaveBinary(program, cache_path, key, driver);
+    }
+
+cleanup:
+    M_FreeShaderSources(program);
+    Memory_FreePointer(&cache_path);
+    Memory_FreePointer(&driver);
 }
 
 void GFX_GL_Program_FragmentData(GFX_GL_PROGRAM *program, const char *name)
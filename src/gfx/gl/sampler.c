@@ -1,5 +1,6 @@
 #include "gfx/gl/sampler.h"
 
+#include "gfx/gl/state.h"
 #include "gfx/gl/utils.h"
 
 void GFX_GL_Sampler_Init(GFX_GL_SAMPLER *sampler)
@@ -10,14 +11,14 @@ void GFX_GL_Sampler_Init(GFX_GL_SAMPLER *sampler)
 
 void GFX_GL_Sampler_Close(GFX_GL_SAMPLER *sampler)
 {
+    GFX_GL_State_ForgetSampler(sampler->id);
     glDeleteSamplers(1, &sampler->id);
     GFX_GL_CheckError();
 }
 
 void GFX_GL_Sampler_Bind(GFX_GL_SAMPLER *sampler, GLuint unit)
 {
-    glBindSampler(unit, sampler->id);
-    GFX_GL_CheckError();
+    GFX_GL_State_BindSampler(unit, sampler->id);
 }
 
 void GFX_GL_Sampler_Parameteri(
@@ -0,0 +1,555 @@
+#include "gfx/gl/state.h"
+
+#include "gfx/gl/utils.h"
+#include "log.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+#define M_UNKNOWN ((GLuint)-1)
+
+typedef enum {
+    M_BUF_ARRAY,
+    M_BUF_ELEMENT_ARRAY,
+    M_BUF_PIXEL_PACK,
+    M_BUF_PIXEL_UNPACK,
+    M_BUF_NUMBER_OF,
+} M_BUFFER_SLOT;
+
+typedef enum {
+    M_CAP_BLEND,
+    M_CAP_DEPTH_TEST,
+    M_CAP_CULL_FACE,
+    M_CAP_SCISSOR_TEST,
+    M_CAP_NUMBER_OF,
+} M_CAP_SLOT;
+
+typedef struct {
+    GLuint program;
+    GLuint vertex_array;
+    GLuint buffers[M_BUF_NUMBER_OF];
+    GLuint draw_framebuffer;
+    GLuint read_framebuffer;
+    GLuint active_unit;
+    GLuint textures[GFX_GL_STATE_MAX_TEXTURE_UNITS];
+    GLuint samplers[GFX_GL_STATE_MAX_TEXTURE_UNITS];
+
+    // -1 = unknown, 0 = disabled, 1 = enabled
+    int8_t caps[M_CAP_NUMBER_OF];
+    GLenum polygon_mode;
+    GLenum blend_src;
+    GLenum blend_dst;
+    GLenum depth_func;
+    GLuint depth_mask;
+    GLfloat line_width;
+    bool viewport_known;
+    GLint viewport[4];
+
+    bool validate;
+    GFX_GL_STATE_STATS stats;
+} M_CACHE;
+
+static M_CACHE m_Cache = { 0 };
+
+static const GLenum m_BufferTargets[M_BUF_NUMBER_OF] = {
+    [M_BUF_ARRAY] = GL_ARRAY_BUFFER,
+    [M_BUF_ELEMENT_ARRAY] = GL_ELEMENT_ARRAY_BUFFER,
+    [M_BUF_PIXEL_PACK] = GL_PIXEL_PACK_BUFFER,
+    [M_BUF_PIXEL_UNPACK] = GL_PIXEL_UNPACK_BUFFER,
+};
+
+static const GLenum m_BufferBindings[M_BUF_NUMBER_OF] = {
+    [M_BUF_ARRAY] = GL_ARRAY_BUFFER_BINDING,
+    [M_BUF_ELEMENT_ARRAY] = GL_ELEMENT_ARRAY_BUFFER_BINDING,
+    [M_BUF_PIXEL_PACK] = GL_PIXEL_PACK_BUFFER_BINDING,
+    [M_BUF_PIXEL_UNPACK] = GL_PIXEL_UNPACK_BUFFER_BINDING,
+};
+
+static const GLenum m_Caps[M_CAP_NUMBER_OF] = {
+    [M_CAP_BLEND] = GL_BLEND,
+    [M_CAP_DEPTH_TEST] = GL_DEPTH_TEST,
+    [M_CAP_CULL_FACE] = GL_CULL_FACE,
+    [M_CAP_SCISSOR_TEST] = GL_SCISSOR_TEST,
+};
+
+static int32_t M_GetBufferSlot(GLenum target);
+static int32_t M_GetCapSlot(GLenum cap);
+static bool M_Elide(void);
+static void M_Issue(void);
+static void M_ValidateInt(GLenum pname, GLint expected, const char *what);
+
+static int32_t M_GetBufferSlot(const GLenum target)
+{
+    for (int32_t i = 0; i < M_BUF_NUMBER_OF; i++) {
+        if (m_BufferTargets[i] == target) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int32_t M_GetCapSlot(const GLenum cap)
+{
+    for (int32_t i = 0; i < M_CAP_NUMBER_OF; i++) {
+        if (m_Caps[i] == cap) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool M_Elide(void)
+{
+    m_Cache.stats.elided++;
+    return m_Cache.validate;
+}
+
+static void M_Issue(void)
+{
+    m_Cache.stats.issued++;
+}
+
+static void M_ValidateInt(
+    const GLenum pname, const GLint expected, const char *const what)
+{
+    GLint actual = 0;
+    glGetIntegerv(pname, &actual);
+    GFX_GL_CheckError();
+    if (actual != expected) {
+        LOG_ERROR(
+            "GL state cache mismatch (%s): cached %d, actual %d", what,
+            expected, actual);
+    }
+}
+
+void GFX_GL_State_Reset(void)
+{
+    const bool validate = m_Cache.validate;
+    const GFX_GL_STATE_STATS stats = m_Cache.stats;
+
+    m_Cache = (M_CACHE) {
+        .program = M_UNKNOWN,
+        .vertex_array = M_UNKNOWN,
+        .draw_framebuffer = M_UNKNOWN,
+        .read_framebuffer = M_UNKNOWN,
+        .polygon_mode = M_UNKNOWN,
+        .blend_src = M_UNKNOWN,
+        .blend_dst = M_UNKNOWN,
+        .depth_func = M_UNKNOWN,
+        .depth_mask = M_UNKNOWN,
+        .line_width = -1.0f,
+        .viewport_known = false,
+        .validate = validate,
+        .stats = stats,
+    };
+    for (int32_t i = 0; i < M_BUF_NUMBER_OF; i++) {
+        m_Cache.buffers[i] = M_UNKNOWN;
+    }
+    for (int32_t i = 0; i < GFX_GL_STATE_MAX_TEXTURE_UNITS; i++) {
+        m_Cache.textures[i] = M_UNKNOWN;
+        m_Cache.samplers[i] = M_UNKNOWN;
+    }
+    for (int32_t i = 0; i < M_CAP_NUMBER_OF; i++) {
+        m_Cache.caps[i] = -1;
+    }
+
+    // establish a known active unit so that texture bindings can be tracked
+    glActiveTexture(GL_TEXTURE0);
+    GFX_GL_CheckError();
+    m_Cache.active_unit = 0;
+    M_Issue();
+}
+
+void GFX_GL_State_SetValidation(const bool enable)
+{
+    if (m_Cache.validate != enable) {
+        LOG_INFO("GL state cache validation: %s", enable ? "on" : "off");
+    }
+    m_Cache.validate = enable;
+}
+
+bool GFX_GL_State_IsValidationEnabled(void)
+{
+    return m_Cache.validate;
+}
+
+const GFX_GL_STATE_STATS *GFX_GL_State_GetStats(void)
+{
+    return &m_Cache.stats;
+}
+
+void GFX_GL_State_ResetStats(void)
+{
+    m_Cache.stats.issued = 0;
+    m_Cache.stats.elided = 0;
+}
+
+void GFX_GL_State_UseProgram(const GLuint program)
+{
+    if (m_Cache.program == program) {
+        if (M_Elide()) {
+            M_ValidateInt(GL_CURRENT_PROGRAM, program, "program");
+        }
+        return;
+    }
+    glUseProgram(program);
+    GFX_GL_CheckError();
+    m_Cache.program = program;
+    M_Issue();
+}
+
+void GFX_GL_State_BindVertexArray(const GLuint array)
+{
+    if (m_Cache.vertex_array == array) {
+        if (M_Elide()) {
+            M_ValidateInt(GL_VERTEX_ARRAY_BINDING, array, "vertex array");
+        }
+        return;
+    }
+    glBindVertexArray(array);
+    GFX_GL_CheckError();
+    m_Cache.vertex_array = array;
+    // the element array binding is part of the vertex array object state
+    m_Cache.buffers[M_BUF_ELEMENT_ARRAY] = M_UNKNOWN;
+    M_Issue();
+}
+
+void GFX_GL_State_BindBuffer(const GLenum target, const GLuint buffer)
+{
+    const int32_t slot = M_GetBufferSlot(target);
+    if (slot < 0) {
+        glBindBuffer(target, buffer);
+        GFX_GL_CheckError();
+        M_Issue();
+        return;
+    }
+
+    if (m_Cache.buffers[slot] == buffer) {
+        if (M_Elide()) {
+            M_ValidateInt(m_BufferBindings[slot], buffer, "buffer");
+        }
+        return;
+    }
+    glBindBuffer(target, buffer);
+    GFX_GL_CheckError();
+    m_Cache.buffers[slot] = buffer;
+    M_Issue();
+}
+
+void GFX_GL_State_BindFramebuffer(const GLenum target, const GLuint framebuffer)
+{
+    const bool draw =
+        target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    const bool read =
+        target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    if ((!draw || m_Cache.draw_framebuffer == framebuffer)
+        && (!read || m_Cache.read_framebuffer == framebuffer)) {
+        if (M_Elide()) {
+            if (draw) {
+                M_ValidateInt(
+                    GL_DRAW_FRAMEBUFFER_BINDING, framebuffer,
+                    "draw framebuffer");
+            }
+            if (read) {
+                M_ValidateInt(
+                    GL_READ_FRAMEBUFFER_BINDING, framebuffer,
+                    "read framebuffer");
+            }
+        }
+        return;
+    }
+    glBindFramebuffer(target, framebuffer);
+    GFX_GL_CheckError();
+    if (draw) {
+        m_Cache.draw_framebuffer = framebuffer;
+    }
+    if (read) {
+        m_Cache.read_framebuffer = framebuffer;
+    }
+    M_Issue();
+}
+
+GLuint GFX_GL_State_GetDrawFramebuffer(void)
+{
+    if (m_Cache.draw_framebuffer == M_UNKNOWN) {
+        GLint framebuffer = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+        GFX_GL_CheckError();
+        m_Cache.draw_framebuffer = framebuffer;
+    }
+    return m_Cache.draw_framebuffer;
+}
+
+void GFX_GL_State_ActiveTexture(const GLuint unit)
+{
+    assert(unit < GFX_GL_STATE_MAX_TEXTURE_UNITS);
+    if (m_Cache.active_unit == unit) {
+        if (M_Elide()) {
+            M_ValidateInt(
+                GL_ACTIVE_TEXTURE, GL_TEXTURE0 + unit, "active texture");
+        }
+        return;
+    }
+    glActiveTexture(GL_TEXTURE0 + unit);
+    GFX_GL_CheckError();
+    m_Cache.active_unit = unit;
+    M_Issue();
+}
+
+void GFX_GL_State_BindTexture(const GLenum target, const GLuint texture)
+{
+    // only 2D textures are tracked - nothing else is used by the renderers
+    if (target != GL_TEXTURE_2D) {
+        glBindTexture(target, texture);
+        GFX_GL_CheckError();
+        M_Issue();
+        return;
+    }
+
+    const GLuint unit = m_Cache.active_unit;
+    if (m_Cache.textures[unit] == texture) {
+        if (M_Elide()) {
+            M_ValidateInt(GL_TEXTURE_BINDING_2D, texture, "texture");
+        }
+        return;
+    }
+    glBindTexture(target, texture);
+    GFX_GL_CheckError();
+    m_Cache.textures[unit] = texture;
+    M_Issue();
+}
+
+void GFX_GL_State_BindSampler(const GLuint unit, const GLuint sampler)
+{
+    assert(unit < GFX_GL_STATE_MAX_TEXTURE_UNITS);
+    if (m_Cache.samplers[unit] == sampler) {
+        // GL_SAMPLER_BINDING is queried for the active unit only
+        if (M_Elide() && unit == m_Cache.active_unit) {
+            M_ValidateInt(GL_SAMPLER_BINDING, sampler, "sampler");
+        }
+        return;
+    }
+    glBindSampler(unit, sampler);
+    GFX_GL_CheckError();
+    m_Cache.samplers[unit] = sampler;
+    M_Issue();
+}
+
+void GFX_GL_State_SetEnabled(const GLenum cap, const bool enable)
+{
+    const int32_t slot = M_GetCapSlot(cap);
+    if (slot >= 0 && m_Cache.caps[slot] == (int8_t)enable) {
+        if (M_Elide()) {
+            M_ValidateInt(cap, enable, "capability");
+        }
+        return;
+    }
+
+    if (enable) {
+        glEnable(cap);
+    } else {
+        glDisable(cap);
+    }
+    GFX_GL_CheckError();
+    if (slot >= 0) {
+        m_Cache.caps[slot] = enable;
+    }
+    M_Issue();
+}
+
+bool GFX_GL_State_IsEnabled(const GLenum cap)
+{
+    const int32_t slot = M_GetCapSlot(cap);
+    if (slot >= 0 && m_Cache.caps[slot] >= 0) {
+        return m_Cache.caps[slot];
+    }
+
+    const bool enabled = glIsEnabled(cap);
+    GFX_GL_CheckError();
+    if (slot >= 0) {
+        m_Cache.caps[slot] = enabled;
+    }
+    return enabled;
+}
+
+void GFX_GL_State_PolygonMode(const GLenum mode)
+{
+    if (m_Cache.polygon_mode == mode) {
+        if (M_Elide()) {
+            GLint actual[2] = { 0 };
+            glGetIntegerv(GL_POLYGON_MODE, actual);
+            GFX_GL_CheckError();
+            if ((GLenum)actual[0] != mode) {
+                LOG_ERROR(
+                    "GL state cache mismatch (polygon mode): cached %d, "
+                    "actual %d",
+                    mode, actual[0]);
+            }
+        }
+        return;
+    }
+    glPolygonMode(GL_FRONT_AND_BACK, mode);
+    GFX_GL_CheckError();
+    m_Cache.polygon_mode = mode;
+    M_Issue();
+}
+
+void GFX_GL_State_BlendFunc(const GLenum sfactor, const GLenum dfactor)
+{
+    if (m_Cache.blend_src == sfactor && m_Cache.blend_dst == dfactor) {
+        if (M_Elide()) {
+            M_ValidateInt(GL_BLEND_SRC_RGB, sfactor, "blend source");
+            M_ValidateInt(GL_BLEND_DST_RGB, dfactor, "blend destination");
+        }
+        return;
+    }
+    glBlendFunc(sfactor, dfactor);
+    GFX_GL_CheckError();
+    m_Cache.blend_src = sfactor;
+    m_Cache.blend_dst = dfactor;
+    M_Issue();
+}
+
+void GFX_GL_State_DepthFunc(const GLenum func)
+{
+    if (m_Cache.depth_func == func) {
+        if (M_Elide()) {
+            M_ValidateInt(GL_DEPTH_FUNC, func, "depth function");
+        }
+        return;
+    }
+    glDepthFunc(func);
+    GFX_GL_CheckError();
+    m_Cache.depth_func = func;
+    M_Issue();
+}
+
+void GFX_GL_State_DepthMask(const GLboolean flag)
+{
+    if (m_Cache.depth_mask == flag) {
+        if (M_Elide()) {
+            M_ValidateInt(GL_DEPTH_WRITEMASK, flag, "depth mask");
+        }
+        return;
+    }
+    glDepthMask(flag);
+    GFX_GL_CheckError();
+    m_Cache.depth_mask = flag;
+    M_Issue();
+}
+
+void GFX_GL_State_LineWidth(const GLfloat width)
+{
+    if (m_Cache.line_width == width) {
+        if (M_Elide()) {
+            GLfloat actual = 0.0f;
+            glGetFloatv(GL_LINE_WIDTH, &actual);
+            GFX_GL_CheckError();
+            if (actual != width) {
+                LOG_ERROR(
+                    "GL state cache mismatch (line width): cached %f, "
+                    "actual %f",
+                    width, actual);
+            }
+        }
+        return;
+    }
+    glLineWidth(width);
+    GFX_GL_CheckError();
+    m_Cache.line_width = width;
+    M_Issue();
+}
+
+void GFX_GL_State_Viewport(
+    const GLint x, const GLint y, const GLsizei width, const GLsizei height)
+{
+    if (m_Cache.viewport_known && m_Cache.viewport[0] == x
+        && m_Cache.viewport[1] == y && m_Cache.viewport[2] == width
+        && m_Cache.viewport[3] == height) {
+        if (M_Elide()) {
+            GLint actual[4];
+            glGetIntegerv(GL_VIEWPORT, actual);
+            GFX_GL_CheckError();
+            for (int32_t i = 0; i < 4; i++) {
+                if (actual[i] != m_Cache.viewport[i]) {
+                    LOG_ERROR("GL state cache mismatch (viewport)");
+                    break;
+                }
+            }
+        }
+        return;
+    }
+    glViewport(x, y, width, height);
+    GFX_GL_CheckError();
+    m_Cache.viewport_known = true;
+    m_Cache.viewport[0] = x;
+    m_Cache.viewport[1] = y;
+    m_Cache.viewport[2] = width;
+    m_Cache.viewport[3] = height;
+    M_Issue();
+}
+
+void GFX_GL_State_GetViewport(GLint viewport[4])
+{
+    if (!m_Cache.viewport_known) {
+        glGetIntegerv(GL_VIEWPORT, m_Cache.viewport);
+        GFX_GL_CheckError();
+        m_Cache.viewport_known = true;
+    }
+    for (int32_t i = 0; i < 4; i++) {
+        viewport[i] = m_Cache.viewport[i];
+    }
+}
+
+void GFX_GL_State_ForgetProgram(const GLuint program)
+{
+    if (m_Cache.program == program) {
+        // a deleted program stays in use until another one is bound
+        m_Cache.program = M_UNKNOWN;
+    }
+}
+
+void GFX_GL_State_ForgetVertexArray(const GLuint array)
+{
+    if (m_Cache.vertex_array == array) {
+        m_Cache.vertex_array = 0;
+        m_Cache.buffers[M_BUF_ELEMENT_ARRAY] = M_UNKNOWN;
+    }
+}
+
+void GFX_GL_State_ForgetBuffer(const GLuint buffer)
+{
+    for (int32_t i = 0; i < M_BUF_NUMBER_OF; i++) {
+        if (m_Cache.buffers[i] == buffer) {
+            m_Cache.buffers[i] = 0;
+        }
+    }
+}
+
+void GFX_GL_State_ForgetFramebuffer(const GLuint framebuffer)
+{
+    if (m_Cache.draw_framebuffer == framebuffer) {
+        m_Cache.draw_framebuffer = 0;
+    }
+    if (m_Cache.read_framebuffer == framebuffer) {
+        m_Cache.read_framebuffer = 0;
+    }
+}
+
+void GFX_GL_State_ForgetTexture(const GLuint texture)
+{
+    for (int32_t i = 0; i < GFX_GL_STATE_MAX_TEXTURE_UNITS; i++) {
+        if (m_Cache.textures[i] == texture) {
+            m_Cache.textures[i] = 0;
+        }
+    }
+}
+
+void GFX_GL_State_ForgetSampler(const GLuint sampler)
+{
+    for (int32_t i = 0; i < GFX_GL_STATE_MAX_TEXTURE_UNITS; i++) {
+        if (m_Cache.samplers[i] == sampler) {
+            m_Cache.samplers[i] = 0;
+        }
+    }
+}
@@ -1,5 +1,6 @@
 #include "gfx/gl/texture.h"
 
+#include "gfx/gl/state.h"
 #include "gfx/gl/utils.h"
 #include "memory.h"
 #include "utils.h"
@@ -32,6 +33,7 @@ void GFX_GL_Texture_Init(GFX_GL_TEXTURE *texture, GLenum target)
 void GFX_GL_Texture_Close(GFX_GL_TEXTURE *texture)
 {
     assert(texture != NULL);
+    GFX_GL_State_ForgetTexture(texture->id);
     glDeleteTextures(1, &texture->id);
     GFX_GL_CheckError();
 }
@@ -39,8 +41,7 @@ void GFX_GL_Texture_Close(GFX_GL_TEXTURE *texture)
 void GFX_GL_Texture_Bind(GFX_GL_TEXTURE *texture)
 {
     assert(texture != NULL);
-    glBindTexture(texture->target, texture->id);
-    GFX_GL_CheckError();
+    GFX_GL_State_BindTexture(texture->target, texture->id);
 }
 
 void GFX_GL_Texture_Load(
@@ -69,8 +70,7 @@ void GFX_GL_Texture_LoadFromBackBuffer(GFX_GL_TEXTURE *const texture)
     GFX_GL_Texture_Bind(texture);
 
     GLint viewport[4];
-    glGetIntegerv(GL_VIEWPORT, viewport);
-    GFX_GL_CheckError();
+    GFX_GL_State_GetViewport(viewport);
 
     const GLint vp_x = viewport[0];
     const GLint vp_y = viewport[1];
@@ -0,0 +1,349 @@
+#include "gfx/gl/texture_batch.h"
+
+#include "gfx/gl/buffer.h"
+#include "gfx/gl/state.h"
+#include "gfx/gl/utils.h"
+#include "log.h"
+#include "memory.h"
+#include "utils.h"
+
+#include <SDL2/SDL_cpuinfo.h>
+#include <SDL2/SDL_mutex.h>
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_timer.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define M_MAX_WORKERS 8
+#define M_BPP 4
+
+typedef struct {
+    GFX_GL_TEXTURE *texture;
+    const uint8_t *data;
+    int32_t width;
+    int32_t height;
+    int32_t levels;
+
+    // levels 1 and up, tightly packed one after another
+    uint8_t *mips;
+    size_t mips_size;
+    bool is_ready;
+    uint64_t mip_ticks;
+} M_JOB;
+
+struct GFX_GL_TEXTURE_BATCH {
+    M_JOB *jobs;
+    int32_t job_count;
+    int32_t job_capacity;
+
+    SDL_mutex *mutex;
+    SDL_cond *cond;
+    int32_t next_job;
+};
+
+static int32_t M_GetLevelCount(int32_t width, int32_t height);
+static size_t M_GetLevelSize(int32_t width, int32_t height, int32_t level);
+static void M_Downsample(
+    const uint8_t *src, int32_t src_width, int32_t src_height, uint8_t *dst);
+static void M_GenerateMips(M_JOB *job);
+static int M_WorkerThread(void *arg);
+static void M_AllocateStorage(const M_JOB *job, bool has_storage);
+static void M_UploadJob(
+    const M_JOB *job, GFX_GL_BUFFER *buffer, bool has_storage);
+
+static int32_t M_GetLevelCount(int32_t width, int32_t height)
+{
+    int32_t levels = 1;
+    while (width > 1 || height > 1) {
+        width = MAX(1, width / 2);
+        height = MAX(1, height / 2);
+        levels++;
+    }
+    return levels;
+}
+
+static size_t M_GetLevelSize(
+    const int32_t width, const int32_t height, const int32_t level)
+{
+    return (size_t)MAX(1, width >> level) * MAX(1, height >> level) * M_BPP;
+}
+
+static void M_Downsample(
+    const uint8_t *const src, const int32_t src_width,
+    const int32_t src_height, uint8_t *const dst)
+{
+    const int32_t dst_width = MAX(1, src_width / 2);
+    const int32_t dst_height = MAX(1, src_height / 2);
+
+    for (int32_t y = 0; y < dst_height; y++) {
+        const int32_t y0 = MIN(y * 2, src_height - 1);
+        const int32_t y1 = MIN(y * 2 + 1, src_height - 1);
+        for (int32_t x = 0; x < dst_width; x++) {
+            const int32_t x0 = MIN(x * 2, src_width - 1);
+            const int32_t x1 = MIN(x * 2 + 1, src_width - 1);
+            const uint8_t *const texels[4] = {
+                &src[(y0 * src_width + x0) * M_BPP],
+                &src[(y0 * src_width + x1) * M_BPP],
+                &src[(y1 * src_width + x0) * M_BPP],
+                &src[(y1 * src_width + x1) * M_BPP],
+            };
+
+            // weigh colors by alpha so that fully transparent texels, which
+            // tend to be black, do not bleed into the edges of sprites
+            uint32_t alpha = 0;
+            uint32_t color[3] = { 0, 0, 0 };
+            for (int32_t i = 0; i < 4; i++) {
+                alpha += texels[i][3];
+                for (int32_t c = 0; c < 3; c++) {
+                    color[c] += texels[i][c] * texels[i][3];
+                }
+            }
+
+            uint8_t *const out = &dst[(y * dst_width + x) * M_BPP];
+            for (int32_t c = 0; c < 3; c++) {
+                if (alpha != 0) {
+                    out[c] = (color[c] + alpha / 2) / alpha;
+                } else {
+                    out[c] = (texels[0][c] + texels[1][c] + texels[2][c]
+                              + texels[3][c] + 2)
+                        / 4;
+                }
+            }
+            out[3] = (alpha + 2) / 4;
+        }
+    }
+}
+
+static void M_GenerateMips(M_JOB *const job)
+{
+    const uint64_t start = SDL_GetPerformanceCounter();
+
+    job->mips_size = 0;
+    for (int32_t level = 1; level < job->levels; level++) {
+        job->mips_size += M_GetLevelSize(job->width, job->height, level);
+    }
+    job->mips = job->mips_size ? Memory_Alloc(job->mips_size) : NULL;
+
+    const uint8_t *src = job->data;
+    uint8_t *dst = job->mips;
+    for (int32_t level = 1; level < job->levels; level++) {
+        M_Downsample(
+            src, MAX(1, job->width >> (level - 1)),
+            MAX(1, job->height >> (level - 1)), dst);
+        src = dst;
+        dst += M_GetLevelSize(job->width, job->height, level);
+    }
+
+    job->mip_ticks = SDL_GetPerformanceCounter() - start;
+}
+
+static int M_WorkerThread(void *const arg)
+{
+    GFX_GL_TEXTURE_BATCH *const batch = arg;
+
+    while (true) {
+        SDL_LockMutex(batch->mutex);
+        const int32_t idx = batch->next_job++;
+        SDL_UnlockMutex(batch->mutex);
+        if (idx >= batch->job_count) {
+            break;
+        }
+
+        M_JOB *const job = &batch->jobs[idx];
+        M_GenerateMips(job);
+
+        SDL_LockMutex(batch->mutex);
+        job->is_ready = true;
+        SDL_CondBroadcast(batch->cond);
+        SDL_UnlockMutex(batch->mutex);
+    }
+
+    return 0;
+}
+
+static void M_AllocateStorage(const M_JOB *const job, const bool has_storage)
+{
+    if (has_storage) {
+        glTexStorage2D(
+            GL_TEXTURE_2D, job->levels, GL_RGBA8, job->width, job->height);
+        GFX_GL_CheckError();
+        return;
+    }
+
+    for (int32_t level = 0; level < job->levels; level++) {
+        glTexImage2D(
+            GL_TEXTURE_2D, level, GL_RGBA, MAX(1, job->width >> level),
+            MAX(1, job->height >> level), 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, job->levels - 1);
+    GFX_GL_CheckError();
+}
+
+static void M_UploadJob(
+    const M_JOB *const job, GFX_GL_BUFFER *const buffer,
+    const bool has_storage)
+{
+    GFX_GL_Texture_Bind(job->texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    M_AllocateStorage(job, has_storage);
+
+    const size_t base_size = M_GetLevelSize(job->width, job->height, 0);
+    const size_t total_size = base_size + job->mips_size;
+
+    // orphan the buffer so that the previous texture's transfer can still
+    // be in flight
+    GFX_GL_Buffer_Bind(buffer);
+    GFX_GL_Buffer_Data(buffer, total_size, NULL, GL_STREAM_DRAW);
+    uint8_t *const dst = GFX_GL_Buffer_Map(buffer, GL_WRITE_ONLY);
+    const bool is_mapped = dst != NULL;
+    if (is_mapped) {
+        memcpy(dst, job->data, base_size);
+        if (job->mips_size) {
+            memcpy(dst + base_size, job->mips, job->mips_size);
+        }
+        GFX_GL_Buffer_Unmap(buffer);
+    } else {
+        GFX_GL_State_BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    size_t offset = 0;
+    for (int32_t level = 0; level < job->levels; level++) {
+        const uint8_t *src = NULL;
+        if (is_mapped) {
+            src = (const uint8_t *)(uintptr_t)offset;
+        } else if (level == 0) {
+            src = job->data;
+        } else {
+            src = job->mips + offset - base_size;
+        }
+        glTexSubImage2D(
+            GL_TEXTURE_2D, level, 0, 0, MAX(1, job->width >> level),
+            MAX(1, job->height >> level), GL_RGBA, GL_UNSIGNED_BYTE, src);
+        offset += M_GetLevelSize(job->width, job->height, level);
+    }
+    GFX_GL_CheckError();
+
+    GFX_GL_State_BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+GFX_GL_TEXTURE_BATCH *GFX_GL_TextureBatch_Create(void)
+{
+    return Memory_Alloc(sizeof(GFX_GL_TEXTURE_BATCH));
+}
+
+void GFX_GL_TextureBatch_Add(
+    GFX_GL_TEXTURE_BATCH *const batch, GFX_GL_TEXTURE *const texture,
+    const void *const data, const int32_t width, const int32_t height)
+{
+    assert(batch != NULL);
+    assert(texture != NULL);
+    assert(data != NULL);
+    assert(width > 0 && height > 0);
+
+    if (batch->job_count == batch->job_capacity) {
+        batch->job_capacity = MAX(batch->job_capacity * 2, 32);
+        batch->jobs =
+            Memory_Realloc(batch->jobs, batch->job_capacity * sizeof(M_JOB));
+    }
+
+    M_JOB *const job = &batch->jobs[batch->job_count++];
+    *job = (M_JOB) {
+        .texture = texture,
+        .data = data,
+        .width = width,
+        .height = height,
+        .levels = M_GetLevelCount(width, height),
+    };
+}
+
+void GFX_GL_TextureBatch_Upload(GFX_GL_TEXTURE_BATCH *batch)
+{
+    assert(batch != NULL);
+    if (batch->job_count == 0) {
+        Memory_FreePointer(&batch);
+        return;
+    }
+
+    const uint64_t start = SDL_GetPerformanceCounter();
+    const bool has_storage =
+        GFX_GL_IsExtensionSupported("GL_ARB_texture_storage");
+
+    batch->mutex = SDL_CreateMutex();
+    batch->cond = SDL_CreateCond();
+    batch->next_job = 0;
+
+    int32_t worker_count = 0;
+    SDL_Thread *workers[M_MAX_WORKERS];
+    if (batch->mutex != NULL && batch->cond != NULL && batch->job_count > 1) {
+        const int32_t wanted =
+            MIN(MIN(SDL_GetCPUCount() - 1, M_MAX_WORKERS), batch->job_count);
+        for (int32_t i = 0; i < wanted; i++) {
+            workers[worker_count] =
+                SDL_CreateThread(M_WorkerThread, "texture_batch", batch);
+            if (workers[worker_count] != NULL) {
+                worker_count++;
+            }
+        }
+    }
+
+    GFX_GL_BUFFER buffer;
+    GFX_GL_Buffer_Init(&buffer, GL_PIXEL_UNPACK_BUFFER);
+
+    uint64_t wait_ticks = 0;
+    uint64_t upload_ticks = 0;
+    for (int32_t i = 0; i < batch->job_count; i++) {
+        M_JOB *const job = &batch->jobs[i];
+
+        const uint64_t wait_start = SDL_GetPerformanceCounter();
+        if (worker_count == 0) {
+            M_GenerateMips(job);
+        } else {
+            SDL_LockMutex(batch->mutex);
+            while (!job->is_ready) {
+                SDL_CondWait(batch->cond, batch->mutex);
+            }
+            SDL_UnlockMutex(batch->mutex);
+        }
+
+        // uploads go out in submission order, whatever order the workers
+        // finish in
+        const uint64_t upload_start = SDL_GetPerformanceCounter();
+        M_UploadJob(job, &buffer, has_storage);
+        Memory_FreePointer(&job->mips);
+        const uint64_t upload_end = SDL_GetPerformanceCounter();
+
+        wait_ticks += upload_start - wait_start;
+        upload_ticks += upload_end - upload_start;
+    }
+
+    for (int32_t i = 0; i < worker_count; i++) {
+        SDL_WaitThread(workers[i], NULL);
+    }
+    GFX_GL_Buffer_Close(&buffer);
+
+    uint64_t mip_ticks = 0;
+    for (int32_t i = 0; i < batch->job_count; i++) {
+        mip_ticks += batch->jobs[i].mip_ticks;
+    }
+
+    const double freq = SDL_GetPerformanceFrequency() / 1000.0;
+    LOG_INFO(
+        "Uploaded %d textures in %.2f ms (mipmaps: %.2f ms CPU on %d "
+        "threads, waiting: %.2f ms, upload: %.2f ms, storage: %s)",
+        batch->job_count, (SDL_GetPerformanceCounter() - start) / freq,
+        mip_ticks / freq, MAX(worker_count, 1), wait_ticks / freq,
+        upload_ticks / freq, has_storage ? "immutable" : "mutable");
+
+    if (batch->cond != NULL) {
+        SDL_DestroyCond(batch->cond);
+    }
+    if (batch->mutex != NULL) {
+        SDL_DestroyMutex(batch->mutex);
+    }
+    Memory_FreePointer(&batch->jobs);
+    Memory_FreePointer(&batch);
+}
@@ -2,6 +2,8 @@
 
 #include "gfx/gl/gl_core_3_3.h"
 
+#include <string.h>
+
 const char *GFX_GL_GetErrorString(GLenum err)
 {
     switch (err) {
@@ -25,3 +27,21 @@ const char *GFX_GL_GetErrorString(GLenum err)
         return "UNKNOWN";
     }
 }
+
+bool GFX_GL_IsExtensionSupported(const char *const name)
+{
+    int number_of_extensions;
+
+    glGetIntegerv(GL_NUM_EXTENSIONS, &number_of_extensions);
+    GFX_GL_CheckError();
+
+    for (int i = 0; i < number_of_extensions; i++) {
+        const char *gl_ext = (const char *)glGetStringi(GL_EXTENSIONS, i);
+        GFX_GL_CheckError();
+
+        if (gl_ext && !strcmp(gl_ext, name)) {
+            return true;
+        }
+    }
+    return false;
+}
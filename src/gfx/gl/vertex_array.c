@@ -1,5 +1,6 @@
 #include "gfx/gl/vertex_array.h"
 
+#include "gfx/gl/state.h"
 #include "gfx/gl/utils.h"
 
 #include <assert.h>
@@ -15,6 +16,7 @@ void GFX_GL_VertexArray_Init(GFX_GL_VERTEX_ARRAY *array)
 void GFX_GL_VertexArray_Close(GFX_GL_VERTEX_ARRAY *array)
 {
     assert(array);
+    GFX_GL_State_ForgetVertexArray(array->id);
     glDeleteVertexArrays(1, &array->id);
     GFX_GL_CheckError();
 }
@@ -22,8 +24,7 @@ void GFX_GL_VertexArray_Close(GFX_GL_VERTEX_ARRAY *array)
 void GFX_GL_VertexArray_Bind(GFX_GL_VERTEX_ARRAY *array)
 {
     assert(array);
-    glBindVertexArray(array->id);
-    GFX_GL_CheckError();
+    GFX_GL_State_BindVertexArray(array->id);
 }
 
 void GFX_GL_VertexArray_Attribute(
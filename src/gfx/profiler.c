@@ -0,0 +1,310 @@
+#include "gfx/profiler.h"
+
+#include "gfx/common.h"
+#include "gfx/gl/gl_core_3_3.h"
+#include "gfx/gl/utils.h"
+#include "log.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+// number of frames the GPU may lag behind before results are discarded
+#define M_FRAMES 4
+#define M_MAX_SCOPES 32
+#define M_FRAME_END_QUERY (M_MAX_SCOPES * 2)
+#define M_QUERIES_PER_FRAME (M_MAX_SCOPES * 2 + 1)
+#define M_SMOOTHING 0.1
+
+typedef struct {
+    GLuint queries[M_QUERIES_PER_FRAME];
+    GFX_PROFILER_PASS scope_passes[M_MAX_SCOPES];
+    int32_t scope_count;
+    bool is_pending;
+} M_FRAME;
+
+typedef struct {
+    bool is_supported;
+    bool is_enabled;
+    // sampling for other modules, without showing anything
+    bool is_required;
+    bool has_queries;
+    int32_t current;
+    int32_t open_scopes[GFX_PROFILER_PASS_NUMBER_OF];
+    M_FRAME frames[M_FRAMES];
+
+    bool has_last_frame_end;
+    GLuint64 last_frame_end;
+
+    GFX_PROFILER_STATS stats;
+} M_PROFILER;
+
+static M_PROFILER m_Profiler = { 0 };
+
+static const char *const m_PassNames[GFX_PROFILER_PASS_NUMBER_OF] = {
+    [GFX_PROFILER_PASS_3D] = "3D",
+    [GFX_PROFILER_PASS_2D_UPLOAD] = "2D upload",
+    [GFX_PROFILER_PASS_2D] = "2D",
+    [GFX_PROFILER_PASS_FBO_BLIT] = "FBO blit",
+    [GFX_PROFILER_PASS_ENV_MAP] = "Env map",
+};
+
+static void M_CreateQueries(void);
+static void M_DeleteQueries(void);
+static void M_ClearFrames(void);
+static bool M_IsSampling(void);
+static void M_SetSampling(bool enable);
+static double M_Smooth(double average, double value);
+static bool M_ResolveFrame(M_FRAME *frame);
+
+static void M_CreateQueries(void)
+{
+    if (m_Profiler.has_queries) {
+        return;
+    }
+    for (int32_t i = 0; i < M_FRAMES; i++) {
+        glGenQueries(M_QUERIES_PER_FRAME, m_Profiler.frames[i].queries);
+        GFX_GL_CheckError();
+    }
+    m_Profiler.has_queries = true;
+}
+
+static void M_DeleteQueries(void)
+{
+    if (!m_Profiler.has_queries) {
+        return;
+    }
+    for (int32_t i = 0; i < M_FRAMES; i++) {
+        glDeleteQueries(M_QUERIES_PER_FRAME, m_Profiler.frames[i].queries);
+        GFX_GL_CheckError();
+    }
+    m_Profiler.has_queries = false;
+}
+
+static void M_ClearFrames(void)
+{
+    for (int32_t i = 0; i < M_FRAMES; i++) {
+        m_Profiler.frames[i].scope_count = 0;
+        m_Profiler.frames[i].is_pending = false;
+    }
+    for (int32_t i = 0; i < GFX_PROFILER_PASS_NUMBER_OF; i++) {
+        m_Profiler.open_scopes[i] = -1;
+    }
+    m_Profiler.current = 0;
+    m_Profiler.has_last_frame_end = false;
+}
+
+static bool M_IsSampling(void)
+{
+    return m_Profiler.is_enabled || m_Profiler.is_required;
+}
+
+static void M_SetSampling(const bool enable)
+{
+    M_ClearFrames();
+    m_Profiler.stats = (GFX_PROFILER_STATS) { 0 };
+    if (enable) {
+        M_CreateQueries();
+    } else {
+        M_DeleteQueries();
+    }
+}
+
+static double M_Smooth(const double average, const double value)
+{
+    return average + (value - average) * M_SMOOTHING;
+}
+
+static bool M_ResolveFrame(M_FRAME *const frame)
+{
+    // timestamps complete in submission order, so once the frame end query
+    // is available all the scopes preceding it are as well
+    GLint available = 0;
+    glGetQueryObjectiv(
+        frame->queries[M_FRAME_END_QUERY], GL_QUERY_RESULT_AVAILABLE,
+        &available);
+    GFX_GL_CheckError();
+    if (!available) {
+        return false;
+    }
+
+    double pass_ms[GFX_PROFILER_PASS_NUMBER_OF] = { 0 };
+    int32_t pass_count[GFX_PROFILER_PASS_NUMBER_OF] = { 0 };
+    for (int32_t i = 0; i < frame->scope_count; i++) {
+        GLuint64 begin = 0;
+        GLuint64 end = 0;
+        glGetQueryObjectui64v(frame->queries[i * 2], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(
+            frame->queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+        GFX_GL_CheckError();
+
+        const GFX_PROFILER_PASS pass = frame->scope_passes[i];
+        if (end > begin) {
+            pass_ms[pass] += (end - begin) / 1000000.0;
+        }
+        pass_count[pass]++;
+    }
+
+    GLuint64 frame_end = 0;
+    glGetQueryObjectui64v(
+        frame->queries[M_FRAME_END_QUERY], GL_QUERY_RESULT, &frame_end);
+    GFX_GL_CheckError();
+
+    GFX_PROFILER_STATS *const stats = &m_Profiler.stats;
+    stats->work_ms = 0.0;
+    for (int32_t i = 0; i < GFX_PROFILER_PASS_NUMBER_OF; i++) {
+        // the environment map copy is already part of the 3D pass
+        if (i != GFX_PROFILER_PASS_ENV_MAP) {
+            stats->work_ms += pass_ms[i];
+        }
+        GFX_PROFILER_PASS_STATS *const pass_stats = &stats->passes[i];
+        pass_stats->last_ms = pass_ms[i];
+        pass_stats->average_ms = M_Smooth(pass_stats->average_ms, pass_ms[i]);
+        pass_stats->count = pass_count[i];
+    }
+
+    if (m_Profiler.has_last_frame_end
+        && frame_end > m_Profiler.last_frame_end) {
+        stats->frame_ms = (frame_end - m_Profiler.last_frame_end) / 1000000.0;
+        stats->frame_average_ms =
+            M_Smooth(stats->frame_average_ms, stats->frame_ms);
+    }
+    m_Profiler.last_frame_end = frame_end;
+    m_Profiler.has_last_frame_end = true;
+    return true;
+}
+
+void GFX_Profiler_Init(void)
+{
+    m_Profiler.is_supported = GFX_GL_DEFAULT_BACKEND == GFX_GL_33C
+        || GFX_GL_IsExtensionSupported("GL_ARB_timer_query");
+    LOG_INFO(
+        "GPU timer queries supported: %s",
+        m_Profiler.is_supported ? "yes" : "no");
+
+    M_ClearFrames();
+    if (!m_Profiler.is_supported) {
+        m_Profiler.is_enabled = false;
+        m_Profiler.is_required = false;
+    } else if (M_IsSampling()) {
+        M_CreateQueries();
+    }
+}
+
+void GFX_Profiler_Shutdown(void)
+{
+    M_DeleteQueries();
+    M_ClearFrames();
+}
+
+bool GFX_Profiler_IsSupported(void)
+{
+    return m_Profiler.is_supported;
+}
+
+bool GFX_Profiler_IsEnabled(void)
+{
+    return m_Profiler.is_enabled;
+}
+
+void GFX_Profiler_SetEnabled(const bool enable)
+{
+    if (enable == m_Profiler.is_enabled) {
+        return;
+    }
+    if (enable && !m_Profiler.is_supported) {
+        LOG_ERROR("GPU timer queries are not supported");
+        return;
+    }
+
+    if (!m_Profiler.is_required) {
+        M_SetSampling(enable);
+    }
+    m_Profiler.is_enabled = enable;
+}
+
+void GFX_Profiler_SetRequired(const bool require)
+{
+    if (require == m_Profiler.is_required
+        || (require && !m_Profiler.is_supported)) {
+        return;
+    }
+    if (!m_Profiler.is_enabled) {
+        M_SetSampling(require);
+    }
+    m_Profiler.is_required = require;
+}
+
+void GFX_Profiler_BeginPass(const GFX_PROFILER_PASS pass)
+{
+    assert(pass >= 0 && pass < GFX_PROFILER_PASS_NUMBER_OF);
+    if (!M_IsSampling() || m_Profiler.open_scopes[pass] >= 0) {
+        return;
+    }
+
+    M_FRAME *const frame = &m_Profiler.frames[m_Profiler.current];
+    if (frame->scope_count >= M_MAX_SCOPES) {
+        return;
+    }
+
+    const int32_t scope = frame->scope_count++;
+    frame->scope_passes[scope] = pass;
+    glQueryCounter(frame->queries[scope * 2], GL_TIMESTAMP);
+    GFX_GL_CheckError();
+    m_Profiler.open_scopes[pass] = scope;
+}
+
+void GFX_Profiler_EndPass(const GFX_PROFILER_PASS pass)
+{
+    assert(pass >= 0 && pass < GFX_PROFILER_PASS_NUMBER_OF);
+    if (!M_IsSampling()) {
+        return;
+    }
+
+    const int32_t scope = m_Profiler.open_scopes[pass];
+    if (scope < 0) {
+        return;
+    }
+
+    M_FRAME *const frame = &m_Profiler.frames[m_Profiler.current];
+    glQueryCounter(frame->queries[scope * 2 + 1], GL_TIMESTAMP);
+    GFX_GL_CheckError();
+    m_Profiler.open_scopes[pass] = -1;
+}
+
+void GFX_Profiler_EndFrame(void)
+{
+    if (!M_IsSampling()) {
+        return;
+    }
+
+    // passes must not straddle frames
+    for (int32_t i = 0; i < GFX_PROFILER_PASS_NUMBER_OF; i++) {
+        GFX_Profiler_EndPass(i);
+    }
+
+    M_FRAME *frame = &m_Profiler.frames[m_Profiler.current];
+    glQueryCounter(frame->queries[M_FRAME_END_QUERY], GL_TIMESTAMP);
+    GFX_GL_CheckError();
+    frame->is_pending = true;
+
+    m_Profiler.current = (m_Profiler.current + 1) % M_FRAMES;
+    frame = &m_Profiler.frames[m_Profiler.current];
+    if (frame->is_pending && !M_ResolveFrame(frame)) {
+        // the GPU is more than M_FRAMES behind; drop rather than stall
+        m_Profiler.stats.dropped_frames++;
+        m_Profiler.has_last_frame_end = false;
+    }
+    frame->scope_count = 0;
+    frame->is_pending = false;
+}
+
+const GFX_PROFILER_STATS *GFX_Profiler_GetStats(void)
+{
+    return &m_Profiler.stats;
+}
+
+const char *GFX_Profiler_GetPassName(const GFX_PROFILER_PASS pass)
+{
+    assert(pass >= 0 && pass < GFX_PROFILER_PASS_NUMBER_OF);
+    return m_PassNames[pass];
+}
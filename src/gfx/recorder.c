@@ -0,0 +1,225 @@
+#include "gfx/recorder.h"
+
+#include "engine/image.h"
+#include "engine/video_encoder.h"
+#include "gfx/screenshot.h"
+#include "log.h"
+#include "memory.h"
+
+#include <SDL2/SDL_error.h>
+#include <SDL2/SDL_mutex.h>
+#include <SDL2/SDL_thread.h>
+#include <assert.h>
+#include <stddef.h>
+
+// maximum number of read back frames waiting for the encoder
+#define M_QUEUE_SIZE 8
+
+typedef struct {
+    bool is_recording;
+    uint32_t session;
+    char *path;
+    int32_t frame_interval;
+    int32_t fps;
+    int32_t frame_counter;
+
+    SDL_Thread *thread;
+    SDL_mutex *mutex;
+    SDL_cond *cond;
+    bool is_quitting;
+    IMAGE *queue[M_QUEUE_SIZE];
+    int32_t queue_head;
+    int32_t queue_count;
+
+    GFX_RECORDER_STATS stats;
+} M_RECORDER;
+
+static M_RECORDER m_Recorder = { 0 };
+
+static void M_OnFrameCaptured(IMAGE *image, void *user_data);
+static int M_EncoderThread(void *arg);
+static void M_DestroySync(void);
+
+static void M_OnFrameCaptured(IMAGE *const image, void *const user_data)
+{
+    // readbacks started by a previous recording may still trickle in
+    const uint32_t session = (uint32_t)(uintptr_t)user_data;
+    if (!m_Recorder.is_recording || session != m_Recorder.session) {
+        Image_Free(image);
+        return;
+    }
+
+    SDL_LockMutex(m_Recorder.mutex);
+    if (m_Recorder.queue_count == M_QUEUE_SIZE) {
+        m_Recorder.stats.dropped++;
+        SDL_UnlockMutex(m_Recorder.mutex);
+        Image_Free(image);
+        return;
+    }
+    const int32_t idx =
+        (m_Recorder.queue_head + m_Recorder.queue_count) % M_QUEUE_SIZE;
+    m_Recorder.queue[idx] = image;
+    m_Recorder.queue_count++;
+    SDL_CondSignal(m_Recorder.cond);
+    SDL_UnlockMutex(m_Recorder.mutex);
+}
+
+static int M_EncoderThread(void *const arg)
+{
+    VIDEO_ENCODER *encoder = NULL;
+    bool is_failed = false;
+
+    SDL_LockMutex(m_Recorder.mutex);
+    while (true) {
+        while (m_Recorder.queue_count == 0 && !m_Recorder.is_quitting) {
+            SDL_CondWait(m_Recorder.cond, m_Recorder.mutex);
+        }
+        if (m_Recorder.queue_count == 0) {
+            break;
+        }
+
+        IMAGE *image = m_Recorder.queue[m_Recorder.queue_head];
+        m_Recorder.queue_head = (m_Recorder.queue_head + 1) % M_QUEUE_SIZE;
+        m_Recorder.queue_count--;
+        SDL_UnlockMutex(m_Recorder.mutex);
+
+        // the video size is decided by the first frame
+        if (encoder == NULL && !is_failed) {
+            encoder = VideoEncoder_Open(
+                m_Recorder.path, image->width, image->height, m_Recorder.fps);
+            is_failed = encoder == NULL;
+        }
+        const bool is_written =
+            encoder != NULL && VideoEncoder_WriteFrame(encoder, image);
+        Image_Free(image);
+
+        SDL_LockMutex(m_Recorder.mutex);
+        if (is_written) {
+            m_Recorder.stats.encoded++;
+        } else {
+            m_Recorder.stats.dropped++;
+        }
+    }
+    SDL_UnlockMutex(m_Recorder.mutex);
+
+    VideoEncoder_Close(encoder);
+    return 0;
+}
+
+static void M_DestroySync(void)
+{
+    if (m_Recorder.cond != NULL) {
+        SDL_DestroyCond(m_Recorder.cond);
+        m_Recorder.cond = NULL;
+    }
+    if (m_Recorder.mutex != NULL) {
+        SDL_DestroyMutex(m_Recorder.mutex);
+        m_Recorder.mutex = NULL;
+    }
+}
+
+bool GFX_Recorder_Start(
+    const char *const path, const int32_t frame_interval, const int32_t fps)
+{
+    assert(path != NULL);
+    if (m_Recorder.is_recording) {
+        LOG_ERROR("Already recording to %s", m_Recorder.path);
+        return false;
+    }
+    if (frame_interval <= 0 || fps <= 0) {
+        LOG_ERROR("Invalid recording rate: %d, %d", frame_interval, fps);
+        return false;
+    }
+
+    m_Recorder.path = Memory_DupStr(path);
+    m_Recorder.frame_interval = frame_interval;
+    m_Recorder.fps = fps;
+    m_Recorder.frame_counter = 0;
+    m_Recorder.is_quitting = false;
+    m_Recorder.queue_head = 0;
+    m_Recorder.queue_count = 0;
+    m_Recorder.stats = (GFX_RECORDER_STATS) { 0 };
+
+    m_Recorder.mutex = SDL_CreateMutex();
+    m_Recorder.cond = SDL_CreateCond();
+    if (m_Recorder.mutex != NULL && m_Recorder.cond != NULL) {
+        m_Recorder.thread = SDL_CreateThread(M_EncoderThread, "recorder", NULL);
+    }
+    if (m_Recorder.thread == NULL) {
+        LOG_ERROR("Failed to start recorder thread: %s", SDL_GetError());
+        M_DestroySync();
+        Memory_FreePointer(&m_Recorder.path);
+        return false;
+    }
+
+    LOG_INFO(
+        "Recording to %s (frame interval: %d, fps: %d)", path, frame_interval,
+        fps);
+    m_Recorder.is_recording = true;
+    return true;
+}
+
+void GFX_Recorder_Stop(void)
+{
+    if (!m_Recorder.is_recording) {
+        return;
+    }
+
+    // collect the frames still being read back so the video ends where the
+    // recording was stopped
+    GFX_Screenshot_Update(true);
+    m_Recorder.is_recording = false;
+    m_Recorder.session++;
+
+    SDL_LockMutex(m_Recorder.mutex);
+    m_Recorder.is_quitting = true;
+    SDL_CondSignal(m_Recorder.cond);
+    SDL_UnlockMutex(m_Recorder.mutex);
+    SDL_WaitThread(m_Recorder.thread, NULL);
+    m_Recorder.thread = NULL;
+    M_DestroySync();
+
+    LOG_INFO(
+        "Recording finished: %d frames captured, %d encoded, %d dropped",
+        m_Recorder.stats.captured, m_Recorder.stats.encoded,
+        m_Recorder.stats.dropped);
+    Memory_FreePointer(&m_Recorder.path);
+}
+
+bool GFX_Recorder_IsRecording(void)
+{
+    return m_Recorder.is_recording;
+}
+
+GFX_RECORDER_STATS GFX_Recorder_GetStats(void)
+{
+    if (m_Recorder.mutex == NULL) {
+        return m_Recorder.stats;
+    }
+    SDL_LockMutex(m_Recorder.mutex);
+    const GFX_RECORDER_STATS stats = m_Recorder.stats;
+    SDL_UnlockMutex(m_Recorder.mutex);
+    return stats;
+}
+
+void GFX_Recorder_CaptureFrame(void)
+{
+    if (!m_Recorder.is_recording) {
+        return;
+    }
+    if (m_Recorder.frame_counter++ % m_Recorder.frame_interval != 0) {
+        return;
+    }
+
+    void *const user_data = (void *)(uintptr_t)m_Recorder.session;
+    const bool is_captured =
+        GFX_Screenshot_CaptureAsync(M_OnFrameCaptured, user_data);
+
+    SDL_LockMutex(m_Recorder.mutex);
+    if (is_captured) {
+        m_Recorder.stats.captured++;
+    } else {
+        m_Recorder.stats.dropped++;
+    }
+    SDL_UnlockMutex(m_Recorder.mutex);
+}
@@ -6,9 +6,12 @@
 #include "gfx/gl/gl_core_3_3.h"
 #include "gfx/gl/program.h"
 #include "gfx/gl/sampler.h"
+#include "gfx/gl/state.h"
 #include "gfx/gl/texture.h"
 #include "gfx/gl/utils.h"
 #include "gfx/gl/vertex_array.h"
+#include "gfx/profiler.h"
+#include "gfx/recorder.h"
 #include "gfx/screenshot.h"
 #include "log.h"
 #include "memory.h"
@@ -38,15 +41,18 @@ static void M_Shutdown(GFX_RENDERER *renderer);
 static void M_Reset(GFX_RENDERER *renderer);
 
 static void M_Render(GFX_RENDERER *renderer);
+static void M_Blit(GFX_RENDERER *renderer, GLenum filter);
 static void M_Bind(const GFX_RENDERER *renderer);
 static void M_Unbind(const GFX_RENDERER *renderer);
 
 static void M_SwapBuffers(GFX_RENDERER *renderer)
 {
     if (GFX_Context_GetScheduledScreenshotPath()) {
-        GFX_Screenshot_CaptureToFile(GFX_Context_GetScheduledScreenshotPath());
+        GFX_Screenshot_CaptureToFileAsync(
+            GFX_Context_GetScheduledScreenshotPath());
         GFX_Context_ClearScheduledScreenshotPath();
     }
+    GFX_Recorder_CaptureFrame();
 
     GFX_Context_SwitchToWindowViewportAR();
     M_Render(renderer);
@@ -109,8 +115,7 @@ static void M_Init(GFX_RENDERER *const renderer, const GFX_CONFIG *const config)
     glGenFramebuffers(1, &priv->fbo);
     GFX_GL_CheckError();
 
-    glBindFramebuffer(GL_FRAMEBUFFER, priv->fbo);
-    GFX_GL_CheckError();
+    GFX_GL_State_BindFramebuffer(GL_FRAMEBUFFER, priv->fbo);
 
     GFX_GL_Texture_Load(
         &priv->texture, NULL, fbo_width, fbo_height, GL_RGB, GL_RGB);
@@ -155,6 +160,7 @@ static void M_Shutdown(GFX_RENDERER *renderer)
         return;
     }
 
+    GFX_GL_State_ForgetFramebuffer(priv->fbo);
     glDeleteFramebuffers(1, &priv->fbo);
     priv->fbo = 0;
     GFX_GL_VertexArray_Close(&priv->vertex_array);
@@ -185,9 +191,15 @@ static void M_Render(GFX_RENDERER *renderer)
         ? GL_LINEAR
         : GL_NEAREST;
 
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    GFX_GL_CheckError();
+    if (GFX_Context_GetRenderWidth() != GFX_Context_GetDisplayWidth()
+        || GFX_Context_GetRenderHeight() != GFX_Context_GetDisplayHeight()) {
+        M_Blit(renderer, filter);
+        return;
+    }
+
+    GFX_Profiler_BeginPass(GFX_PROFILER_PASS_FBO_BLIT);
+    GFX_GL_State_PolygonMode(GL_FILL);
+    GFX_GL_State_BindFramebuffer(GL_FRAMEBUFFER, 0);
 
     GFX_GL_Program_Bind(&priv->program);
     GFX_GL_Buffer_Bind(&priv->buffer);
@@ -198,30 +210,42 @@ static void M_Render(GFX_RENDERER *renderer)
     GFX_GL_Sampler_Parameteri(&priv->sampler, GL_TEXTURE_MAG_FILTER, filter);
     GFX_GL_Sampler_Parameteri(&priv->sampler, GL_TEXTURE_MIN_FILTER, filter);
 
-    GLboolean blend = glIsEnabled(GL_BLEND);
-    if (blend) {
-        glDisable(GL_BLEND);
-    }
-
-    GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
-    if (depth_test) {
-        glDisable(GL_DEPTH_TEST);
-    }
+    const bool blend = GFX_GL_State_IsEnabled(GL_BLEND);
+    const bool depth_test = GFX_GL_State_IsEnabled(GL_DEPTH_TEST);
+    GFX_GL_State_SetEnabled(GL_BLEND, false);
+    GFX_GL_State_SetEnabled(GL_DEPTH_TEST, false);
 
     glDrawArrays(GL_TRIANGLES, 0, 6);
     GFX_GL_CheckError();
 
-    if (blend) {
-        glEnable(GL_BLEND);
-    }
+    GFX_GL_State_SetEnabled(GL_BLEND, blend);
+    GFX_GL_State_SetEnabled(GL_DEPTH_TEST, depth_test);
+    GFX_Profiler_EndPass(GFX_PROFILER_PASS_FBO_BLIT);
 
-    if (depth_test) {
-        glEnable(GL_DEPTH_TEST);
-    }
-    GFX_GL_CheckError();
+    GFX_GL_State_BindFramebuffer(GL_FRAMEBUFFER, priv->fbo);
+}
 
-    glBindFramebuffer(GL_FRAMEBUFFER, priv->fbo);
+static void M_Blit(GFX_RENDERER *const renderer, const GLenum filter)
+{
+    // The framebuffer is always allocated at the full display size and a
+    // scaled frame occupies only its bottom left corner, so that changing the
+    // scale never reallocates anything. The quad shader samples the whole
+    // texture, so the scaled region is stretched with a blit instead.
+    M_CONTEXT *const priv = renderer->priv;
+    GLint viewport[4];
+    GFX_GL_State_GetViewport(viewport);
+
+    GFX_Profiler_BeginPass(GFX_PROFILER_PASS_FBO_BLIT);
+    GFX_GL_State_BindFramebuffer(GL_READ_FRAMEBUFFER, priv->fbo);
+    GFX_GL_State_BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(
+        0, 0, GFX_Context_GetRenderWidth(), GFX_Context_GetRenderHeight(),
+        viewport[0], viewport[1], viewport[0] + viewport[2],
+        viewport[1] + viewport[3], GL_COLOR_BUFFER_BIT, filter);
     GFX_GL_CheckError();
+    GFX_Profiler_EndPass(GFX_PROFILER_PASS_FBO_BLIT);
+
+    GFX_GL_State_BindFramebuffer(GL_FRAMEBUFFER, priv->fbo);
 }
 
 static void M_Bind(const GFX_RENDERER *renderer)
@@ -229,12 +253,12 @@ static void M_Bind(const GFX_RENDERER *renderer)
     assert(renderer != NULL);
     M_CONTEXT *priv = renderer->priv;
     assert(priv != NULL);
-    glBindFramebuffer(GL_FRAMEBUFFER, priv->fbo);
+    GFX_GL_State_BindFramebuffer(GL_FRAMEBUFFER, priv->fbo);
 }
 
 static void M_Unbind(const GFX_RENDERER *renderer)
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GFX_GL_State_BindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 GFX_RENDERER g_GFX_Renderer_FBO = {
@@ -2,6 +2,7 @@
 
 #include "gfx/context.h"
 #include "gfx/gl/utils.h"
+#include "gfx/recorder.h"
 #include "gfx/screenshot.h"
 
 #include <SDL2/SDL_video.h>
@@ -15,9 +16,11 @@ static void M_SwapBuffers(GFX_RENDERER *renderer)
 
     GFX_Context_SwitchToWindowViewportAR();
     if (GFX_Context_GetScheduledScreenshotPath()) {
-        GFX_Screenshot_CaptureToFile(GFX_Context_GetScheduledScreenshotPath());
+        GFX_Screenshot_CaptureToFileAsync(
+            GFX_Context_GetScheduledScreenshotPath());
         GFX_Context_ClearScheduledScreenshotPath();
     }
+    GFX_Recorder_CaptureFrame();
 
     SDL_GL_SwapWindow(GFX_Context_GetWindowHandle());
 
@@ -1,12 +1,232 @@
 #include "gfx/screenshot.h"
 
 #include "engine/image.h"
+#include "gfx/context.h"
+#include "gfx/gl/buffer.h"
+#include "gfx/gl/state.h"
 #include "gfx/gl/utils.h"
+#include "log.h"
 #include "memory.h"
 
+#include <SDL2/SDL_error.h>
+#include <SDL2/SDL_mutex.h>
+#include <SDL2/SDL_thread.h>
 #include <assert.h>
 #include <string.h>
 
+// number of readbacks that may be in flight at once (burst captures)
+#define M_SLOTS 4
+// without fences, a slot is mapped after this many frames
+#define M_MIN_FRAME_AGE 2
+
+typedef struct {
+    bool is_busy;
+    bool has_buffer;
+    GFX_GL_BUFFER buffer;
+    GLsizeiptr buffer_size;
+    GLsync fence;
+    uint32_t frame_num;
+    uint32_t sequence;
+    int32_t width;
+    int32_t height;
+    GFX_SCREENSHOT_CALLBACK callback;
+    void *user_data;
+} M_SLOT;
+
+typedef struct M_JOB {
+    IMAGE *image;
+    char *path;
+    struct M_JOB *next;
+} M_JOB;
+
+typedef struct {
+    SDL_Thread *thread;
+    SDL_mutex *mutex;
+    SDL_cond *cond;
+    M_JOB *head;
+    M_JOB *tail;
+    bool is_quitting;
+} M_WORKER;
+
+static M_SLOT m_Slots[M_SLOTS] = { 0 };
+static uint32_t m_FrameNum = 0;
+static uint32_t m_Sequence = 0;
+static M_WORKER m_Worker = { 0 };
+
+static void M_GetCaptureRect(GLint *x, GLint *y, GLint *width, GLint *height);
+static bool M_IsSlotReady(const M_SLOT *slot);
+static void M_CompleteSlot(M_SLOT *slot);
+static int M_WorkerThread(void *arg);
+static bool M_StartWorker(void);
+static void M_StopWorker(void);
+static void M_QueueJob(IMAGE *image, const char *path);
+static void M_SaveImageCallback(IMAGE *image, void *user_data);
+
+static void M_GetCaptureRect(
+    GLint *const x, GLint *const y, GLint *const width, GLint *const height)
+{
+    GLint viewport[4];
+    GFX_GL_State_GetViewport(viewport);
+    *x = viewport[0];
+    *y = viewport[1];
+    *width = viewport[2];
+    *height = viewport[3];
+}
+
+static bool M_IsSlotReady(const M_SLOT *const slot)
+{
+    if (slot->fence == NULL) {
+        return m_FrameNum - slot->frame_num >= M_MIN_FRAME_AGE;
+    }
+
+    const GLenum result = glClientWaitSync(slot->fence, 0, 0);
+    GFX_GL_CheckError();
+    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+static void M_CompleteSlot(M_SLOT *const slot)
+{
+    assert(slot->is_busy);
+
+    if (slot->fence != NULL) {
+        glDeleteSync(slot->fence);
+        slot->fence = NULL;
+    }
+
+    IMAGE *image = NULL;
+    GFX_GL_Buffer_Bind(&slot->buffer);
+    const uint8_t *const src = GFX_GL_Buffer_Map(&slot->buffer, GL_READ_ONLY);
+    if (src != NULL) {
+        // GL rows are bottom-up; reversing them while copying out of the
+        // mapped buffer makes the flip free
+        image = Image_Create(slot->width, slot->height);
+        const size_t pitch = slot->width * sizeof(IMAGE_PIXEL);
+        uint8_t *const dst = (uint8_t *)image->data;
+        for (int32_t y = 0; y < slot->height; y++) {
+            memcpy(
+                &dst[y * pitch], &src[(slot->height - 1 - y) * pitch], pitch);
+        }
+        GFX_GL_Buffer_Unmap(&slot->buffer);
+    } else {
+        LOG_ERROR("Failed to map screenshot buffer");
+    }
+    GFX_GL_State_BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // release the slot before the callback so it can schedule another capture
+    const GFX_SCREENSHOT_CALLBACK callback = slot->callback;
+    void *const user_data = slot->user_data;
+    slot->is_busy = false;
+    slot->callback = NULL;
+    slot->user_data = NULL;
+
+    if (image != NULL) {
+        callback(image, user_data);
+    }
+}
+
+static int M_WorkerThread(void *const arg)
+{
+    SDL_LockMutex(m_Worker.mutex);
+    while (true) {
+        while (m_Worker.head == NULL && !m_Worker.is_quitting) {
+            SDL_CondWait(m_Worker.cond, m_Worker.mutex);
+        }
+        if (m_Worker.head == NULL) {
+            break;
+        }
+
+        M_JOB *job = m_Worker.head;
+        m_Worker.head = job->next;
+        if (m_Worker.head == NULL) {
+            m_Worker.tail = NULL;
+        }
+        SDL_UnlockMutex(m_Worker.mutex);
+
+        if (!Image_SaveToFile(job->image, job->path)) {
+            LOG_ERROR("Failed to save screenshot: %s", job->path);
+        }
+        Image_Free(job->image);
+        Memory_FreePointer(&job->path);
+        Memory_FreePointer(&job);
+
+        SDL_LockMutex(m_Worker.mutex);
+    }
+    SDL_UnlockMutex(m_Worker.mutex);
+    return 0;
+}
+
+static bool M_StartWorker(void)
+{
+    if (m_Worker.thread != NULL) {
+        return true;
+    }
+
+    m_Worker.mutex = SDL_CreateMutex();
+    m_Worker.cond = SDL_CreateCond();
+    m_Worker.is_quitting = false;
+    if (m_Worker.mutex != NULL && m_Worker.cond != NULL) {
+        m_Worker.thread = SDL_CreateThread(M_WorkerThread, "screenshot", NULL);
+    }
+
+    if (m_Worker.thread == NULL) {
+        LOG_ERROR("Failed to start screenshot thread: %s", SDL_GetError());
+        M_StopWorker();
+        return false;
+    }
+    return true;
+}
+
+static void M_StopWorker(void)
+{
+    if (m_Worker.thread != NULL) {
+        SDL_LockMutex(m_Worker.mutex);
+        m_Worker.is_quitting = true;
+        SDL_CondSignal(m_Worker.cond);
+        SDL_UnlockMutex(m_Worker.mutex);
+        SDL_WaitThread(m_Worker.thread, NULL);
+        m_Worker.thread = NULL;
+    }
+    if (m_Worker.cond != NULL) {
+        SDL_DestroyCond(m_Worker.cond);
+        m_Worker.cond = NULL;
+    }
+    if (m_Worker.mutex != NULL) {
+        SDL_DestroyMutex(m_Worker.mutex);
+        m_Worker.mutex = NULL;
+    }
+}
+
+static void M_QueueJob(IMAGE *const image, const char *const path)
+{
+    if (!M_StartWorker()) {
+        Image_SaveToFile(image, path);
+        Image_Free(image);
+        return;
+    }
+
+    M_JOB *const job = Memory_Alloc(sizeof(M_JOB));
+    job->image = image;
+    job->path = Memory_DupStr(path);
+    job->next = NULL;
+
+    SDL_LockMutex(m_Worker.mutex);
+    if (m_Worker.tail != NULL) {
+        m_Worker.tail->next = job;
+    } else {
+        m_Worker.head = job;
+    }
+    m_Worker.tail = job;
+    SDL_CondSignal(m_Worker.cond);
+    SDL_UnlockMutex(m_Worker.mutex);
+}
+
+static void M_SaveImageCallback(IMAGE *const image, void *const user_data)
+{
+    char *path = user_data;
+    M_QueueJob(image, path);
+    Memory_FreePointer(&path);
+}
+
 bool GFX_Screenshot_CaptureToFile(const char *path)
 {
     bool ret = false;
@@ -38,14 +258,9 @@ void GFX_Screenshot_CaptureToBuffer(
     assert(out_width);
     assert(out_height);
 
-    GLint viewport[4];
-    glGetIntegerv(GL_VIEWPORT, viewport);
-    GFX_GL_CheckError();
-
-    GLint x = viewport[0];
-    GLint y = viewport[1];
-    *out_width = viewport[2];
-    *out_height = viewport[3];
+    GLint x;
+    GLint y;
+    M_GetCaptureRect(&x, &y, out_width, out_height);
 
     if (!out_buffer) {
         return;
@@ -74,3 +289,130 @@ void GFX_Screenshot_CaptureToBuffer(
         Memory_FreePointer(&scanline);
     }
 }
+
+bool GFX_Screenshot_CaptureAsync(
+    const GFX_SCREENSHOT_CALLBACK callback, void *const user_data)
+{
+    assert(callback != NULL);
+
+    M_SLOT *slot = NULL;
+    for (int32_t i = 0; i < M_SLOTS; i++) {
+        if (!m_Slots[i].is_busy) {
+            slot = &m_Slots[i];
+            break;
+        }
+    }
+    if (slot == NULL) {
+        return false;
+    }
+
+    GLint x;
+    GLint y;
+    GLint width;
+    GLint height;
+    M_GetCaptureRect(&x, &y, &width, &height);
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+
+    if (!slot->has_buffer) {
+        GFX_GL_Buffer_Init(&slot->buffer, GL_PIXEL_PACK_BUFFER);
+        slot->has_buffer = true;
+        slot->buffer_size = 0;
+    }
+
+    GFX_GL_Buffer_Bind(&slot->buffer);
+    const GLsizeiptr size = width * height * sizeof(IMAGE_PIXEL);
+    if (size > slot->buffer_size) {
+        GFX_GL_Buffer_Data(&slot->buffer, size, NULL, GL_STREAM_READ);
+        slot->buffer_size = size;
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    GFX_GL_CheckError();
+    // with a pack buffer bound, the last argument is an offset into it
+    glReadPixels(x, y, width, height, GL_RGB, GL_UNSIGNED_BYTE, 0);
+    GFX_GL_CheckError();
+    GFX_GL_State_BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot->fence = GFX_Context_IsFenceSupported()
+        ? glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)
+        : NULL;
+    GFX_GL_CheckError();
+
+    slot->is_busy = true;
+    slot->frame_num = m_FrameNum;
+    slot->sequence = m_Sequence++;
+    slot->width = width;
+    slot->height = height;
+    slot->callback = callback;
+    slot->user_data = user_data;
+    return true;
+}
+
+bool GFX_Screenshot_CaptureToFileAsync(const char *const path)
+{
+    assert(path != NULL);
+
+    char *const path_copy = Memory_DupStr(path);
+    if (GFX_Screenshot_CaptureAsync(M_SaveImageCallback, path_copy)) {
+        return true;
+    }
+
+    // all slots busy - read back synchronously, but still encode off-thread
+    LOG_DEBUG("No free screenshot slot, reading back synchronously");
+    GLint width;
+    GLint height;
+    GFX_Screenshot_CaptureToBuffer(
+        NULL, &width, &height, 3, GL_RGB, GL_UNSIGNED_BYTE, true);
+    if (width <= 0 || height <= 0) {
+        Memory_Free(path_copy);
+        return false;
+    }
+
+    IMAGE *const image = Image_Create(width, height);
+    GFX_Screenshot_CaptureToBuffer(
+        (uint8_t *)image->data, &width, &height, 3, GL_RGB, GL_UNSIGNED_BYTE,
+        true);
+    M_SaveImageCallback(image, path_copy);
+    return true;
+}
+
+void GFX_Screenshot_Update(const bool wait)
+{
+    m_FrameNum++;
+
+    // complete in submission order so that burst captures stay ordered
+    while (true) {
+        M_SLOT *oldest = NULL;
+        for (int32_t i = 0; i < M_SLOTS; i++) {
+            M_SLOT *const slot = &m_Slots[i];
+            if (slot->is_busy
+                && (oldest == NULL
+                    || (int32_t)(slot->sequence - oldest->sequence) < 0)) {
+                oldest = slot;
+            }
+        }
+
+        if (oldest == NULL || (!wait && !M_IsSlotReady(oldest))) {
+            break;
+        }
+        M_CompleteSlot(oldest);
+    }
+}
+
+void GFX_Screenshot_Shutdown(void)
+{
+    GFX_Screenshot_Update(true);
+
+    for (int32_t i = 0; i < M_SLOTS; i++) {
+        M_SLOT *const slot = &m_Slots[i];
+        if (slot->has_buffer) {
+            GFX_GL_Buffer_Close(&slot->buffer);
+            slot->has_buffer = false;
+            slot->buffer_size = 0;
+        }
+    }
+
+    M_StopWorker();
+}
@@ -2,6 +2,7 @@
 
 #include "log.h"
 #include "memory.h"
+#include "reader.h"
 
 #include <assert.h>
 #include <stdbool.h>
@@ -53,6 +54,13 @@ static void M_HandleObject(M_STATE *state, JSON_OBJECT *object);
 static void M_HandleObjectValue(M_STATE *state, JSON_VALUE *value);
 static void M_HandleValue(M_STATE *state, JSON_VALUE *value, uint8_t marker);
 
+static size_t M_GetLimit(const JSON_READER *reader);
+static bool M_CheckSpace(JSON_READER *reader, size_t offset, size_t size);
+static bool M_ReadInt32(JSON_READER *reader, int32_t *value);
+static JSON_TOKEN M_ReadDocument(JSON_READER *reader, bool is_array);
+static JSON_TOKEN M_ReadValue(JSON_READER *reader, uint8_t marker);
+static JSON_TOKEN M_ReadElement(JSON_READER *reader);
+
 static bool M_GetObjectKeySize(M_STATE *state)
 {
     assert(state);
@@ -357,6 +365,8 @@ static void M_HandleInt32Value(M_STATE *state, JSON_VALUE *value)
     sprintf(state->data, "%d", num);
     number->number_size = strlen(number->number);
     state->data += number->number_size + 1;
+    number->type = JSON_NUMBER_TYPE_INT;
+    number->int_value = num;
 
     value->type = JSON_TYPE_NUMBER;
     value->payload = number;
@@ -389,6 +399,11 @@ static void M_HandleDoubleValue(M_STATE *state, JSON_VALUE *value)
         number->number[number->number_size] = '\0';
     }
 
+    // the text is only for display; keep the exact value for reading and
+    // writing back
+    number->type = JSON_NUMBER_TYPE_DOUBLE;
+    number->double_value = num;
+
     value->type = JSON_TYPE_NUMBER;
     value->payload = number;
 }
@@ -475,6 +490,9 @@ static void M_HandleArray(M_STATE *state, JSON_ARRAY *array)
     }
     array->ref_count = 1;
     array->length = count;
+    array->elements = NULL;
+    array->elements_capacity = 0;
+    array->arena = NULL;
     assert(state->offset + sizeof(char) <= state->size);
     assert(!state->src[state->offset]);
     state->offset++;
@@ -553,6 +571,8 @@ static void M_HandleObject(M_STATE *state, JSON_OBJECT *object)
     }
     object->ref_count = 1;
     object->length = count;
+    object->index = NULL;
+    object->arena = NULL;
     assert(state->offset + sizeof(char) <= state->size);
     assert(!state->src[state->offset]);
     state->offset++;
@@ -689,3 +709,202 @@ const char *BSON_GetErrorDescription(BSON_PARSE_ERROR error)
         return "unknown";
     }
 }
+
+static size_t M_GetLimit(const JSON_READER *const reader)
+{
+    // everything inside a document comes before its terminator
+    if (reader->depth == 0) {
+        return reader->size;
+    }
+    return reader->scopes[reader->depth - 1].end - sizeof(char);
+}
+
+static bool M_CheckSpace(
+    JSON_READER *const reader, const size_t offset, const size_t size)
+{
+    if (offset + size <= M_GetLimit(reader)) {
+        return true;
+    }
+    // running past the enclosing document rather than the buffer means the
+    // declared sizes are inconsistent
+    reader->error = offset + size > reader->size
+        ? BSON_PARSE_ERROR_PREMATURE_END_OF_BUFFER
+        : BSON_PARSE_ERROR_INVALID_VALUE;
+    return false;
+}
+
+static bool M_ReadInt32(JSON_READER *const reader, int32_t *const value)
+{
+    if (!M_CheckSpace(reader, reader->offset, sizeof(int32_t))) {
+        return false;
+    }
+    memcpy(value, &reader->src[reader->offset], sizeof(int32_t));
+    reader->offset += sizeof(int32_t);
+    return true;
+}
+
+static JSON_TOKEN M_ReadDocument(JSON_READER *const reader, const bool is_array)
+{
+    const size_t start_offset = reader->offset;
+    int32_t size;
+    if (!M_ReadInt32(reader, &size)) {
+        return JSON_TOKEN_ERROR;
+    }
+    // the smallest document is its size and the null terminator
+    if (size < (int32_t)(sizeof(int32_t) + sizeof(char))) {
+        reader->error = BSON_PARSE_ERROR_INVALID_VALUE;
+        return JSON_TOKEN_ERROR;
+    }
+    if (!M_CheckSpace(reader, start_offset, size)) {
+        return JSON_TOKEN_ERROR;
+    }
+
+    JSON_READER_SCOPE *const scope = JSON_ReaderPushScope(reader, is_array);
+    scope->end = start_offset + size;
+    return is_array ? JSON_TOKEN_BEGIN_ARRAY : JSON_TOKEN_BEGIN_OBJECT;
+}
+
+static JSON_TOKEN M_ReadValue(JSON_READER *const reader, const uint8_t marker)
+{
+    JSON_NUMBER *const number = &reader->number;
+
+    switch (marker) {
+    case 0x01:
+        if (!M_CheckSpace(reader, reader->offset, sizeof(double))) {
+            return JSON_TOKEN_ERROR;
+        }
+        number->number = NULL;
+        number->number_size = 0;
+        number->type = JSON_NUMBER_TYPE_DOUBLE;
+        memcpy(
+            &number->double_value, &reader->src[reader->offset],
+            sizeof(double));
+        reader->offset += sizeof(double);
+        return JSON_TOKEN_NUMBER;
+
+    case 0x02: {
+        int32_t size;
+        if (!M_ReadInt32(reader, &size)) {
+            return JSON_TOKEN_ERROR;
+        }
+        if (size < 1) {
+            reader->error = BSON_PARSE_ERROR_PREMATURE_END_OF_BUFFER;
+            return JSON_TOKEN_ERROR;
+        }
+        if (!M_CheckSpace(reader, reader->offset, size)) {
+            return JSON_TOKEN_ERROR;
+        }
+        if (reader->src[reader->offset + size - 1] != '\0') {
+            reader->error = BSON_PARSE_ERROR_INVALID_VALUE;
+            return JSON_TOKEN_ERROR;
+        }
+        // strings are null terminated in place and need no copy
+        reader->string.string = (char *)&reader->src[reader->offset];
+        reader->string.string_size = size - 1;
+        reader->offset += size;
+        return JSON_TOKEN_STRING;
+    }
+
+    case 0x03:
+        return M_ReadDocument(reader, false);
+
+    case 0x04:
+        return M_ReadDocument(reader, true);
+
+    case 0x0A:
+        return JSON_TOKEN_NULL;
+
+    case 0x08:
+        if (!M_CheckSpace(reader, reader->offset, sizeof(uint8_t))) {
+            return JSON_TOKEN_ERROR;
+        }
+        switch (reader->src[reader->offset++]) {
+        case 0x00:
+            return JSON_TOKEN_FALSE;
+        case 0x01:
+            return JSON_TOKEN_TRUE;
+        default:
+            reader->error = BSON_PARSE_ERROR_INVALID_VALUE;
+            return JSON_TOKEN_ERROR;
+        }
+
+    case 0x10: {
+        int32_t value;
+        if (!M_ReadInt32(reader, &value)) {
+            return JSON_TOKEN_ERROR;
+        }
+        number->number = NULL;
+        number->number_size = 0;
+        number->type = JSON_NUMBER_TYPE_INT;
+        number->int_value = value;
+        return JSON_TOKEN_NUMBER;
+    }
+
+    default:
+        reader->error = BSON_PARSE_ERROR_INVALID_VALUE;
+        return JSON_TOKEN_ERROR;
+    }
+}
+
+static JSON_TOKEN M_ReadElement(JSON_READER *const reader)
+{
+    const JSON_READER_SCOPE *const scope = &reader->scopes[reader->depth - 1];
+    const bool is_array = scope->is_array;
+
+    // values never run past the limit, so this is the terminator
+    const size_t limit = M_GetLimit(reader);
+    if (reader->offset >= limit) {
+        if (reader->src[reader->offset] != '\0') {
+            reader->error = BSON_PARSE_ERROR_INVALID_VALUE;
+            return JSON_TOKEN_ERROR;
+        }
+        reader->offset++;
+        reader->depth--;
+        return is_array ? JSON_TOKEN_END_ARRAY : JSON_TOKEN_END_OBJECT;
+    }
+
+    const uint8_t marker = reader->src[reader->offset++];
+    const char *const key = &reader->src[reader->offset];
+    const char *const key_end = memchr(key, '\0', limit - reader->offset);
+    if (key_end == NULL) {
+        reader->error = BSON_PARSE_ERROR_INVALID_VALUE;
+        return JSON_TOKEN_ERROR;
+    }
+    reader->offset += key_end - key + 1;
+
+    // BSON arrays always use keys, but they carry no information
+    if (is_array) {
+        return M_ReadValue(reader, marker);
+    }
+
+    reader->string.string = (char *)key;
+    reader->string.string_size = key_end - key;
+    reader->marker = marker;
+    reader->expect_value = true;
+    return JSON_TOKEN_KEY;
+}
+
+JSON_TOKEN BSON_ParseNextToken(JSON_READER *const reader)
+{
+    if (reader->expect_value) {
+        reader->expect_value = false;
+        return M_ReadValue(reader, reader->marker);
+    }
+
+    if (reader->depth > 0) {
+        return M_ReadElement(reader);
+    }
+
+    if (!reader->is_started) {
+        // assume the root element to be an object
+        reader->is_started = true;
+        return M_ReadDocument(reader, false);
+    }
+
+    if (reader->offset != reader->size) {
+        reader->error = BSON_PARSE_ERROR_UNEXPECTED_TRAILING_BYTES;
+        return JSON_TOKEN_ERROR;
+    }
+    reader->is_done = true;
+    return JSON_TOKEN_NONE;
+}
@@ -0,0 +1,339 @@
+#include "bson_view.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define M_BSON_DOUBLE 0x01
+#define M_BSON_STRING 0x02
+#define M_BSON_OBJECT 0x03
+#define M_BSON_ARRAY 0x04
+#define M_BSON_BOOL 0x08
+#define M_BSON_NULL 0x0A
+#define M_BSON_INT32 0x10
+
+// the smallest document: its length followed by the terminator
+#define M_MIN_DOCUMENT_SIZE 5
+
+static bool M_ReadInt32(
+    const BSON_VIEW *view, size_t offset, size_t end, int32_t *value);
+static bool M_ReadValue(
+    const BSON_VIEW *view, size_t offset, size_t end,
+    BSON_VIEW_ELEMENT *element);
+static bool M_GetNumber(const BSON_VIEW_ELEMENT *element, JSON_NUMBER *number);
+static bool M_GetDocument(
+    const BSON_VIEW_ELEMENT *element, uint8_t marker, BSON_VIEW *out_view);
+
+static bool M_ReadInt32(
+    const BSON_VIEW *const view, const size_t offset, const size_t end,
+    int32_t *const value)
+{
+    if (offset + sizeof(int32_t) > end) {
+        return false;
+    }
+    memcpy(value, &view->src[offset], sizeof(int32_t));
+    return true;
+}
+
+static bool M_ReadValue(
+    const BSON_VIEW *const view, const size_t offset, const size_t end,
+    BSON_VIEW_ELEMENT *const element)
+{
+    int32_t size;
+    element->data = &view->src[offset];
+
+    switch (element->marker) {
+    case M_BSON_DOUBLE:
+        element->type = JSON_TYPE_NUMBER;
+        element->size = sizeof(double);
+        break;
+
+    case M_BSON_INT32:
+        element->type = JSON_TYPE_NUMBER;
+        element->size = sizeof(int32_t);
+        break;
+
+    case M_BSON_STRING:
+        if (!M_ReadInt32(view, offset, end, &size) || size < 1
+            || offset + sizeof(int32_t) + size > end
+            || view->src[offset + sizeof(int32_t) + size - 1] != '\0') {
+            return false;
+        }
+        element->type = JSON_TYPE_STRING;
+        element->data = &view->src[offset + sizeof(int32_t)];
+        element->size = size - 1;
+        element->next_offset = offset + sizeof(int32_t) + size;
+        return true;
+
+    case M_BSON_OBJECT:
+    case M_BSON_ARRAY:
+        if (!M_ReadInt32(view, offset, end, &size)
+            || size < M_MIN_DOCUMENT_SIZE || offset + size > end
+            || view->src[offset + size - 1] != '\0') {
+            return false;
+        }
+        element->type = element->marker == M_BSON_OBJECT ? JSON_TYPE_OBJECT
+                                                         : JSON_TYPE_ARRAY;
+        element->size = size;
+        break;
+
+    case M_BSON_BOOL:
+        if (offset + sizeof(uint8_t) > end) {
+            return false;
+        }
+        switch (view->src[offset]) {
+        case 0x00:
+            element->type = JSON_TYPE_FALSE;
+            break;
+        case 0x01:
+            element->type = JSON_TYPE_TRUE;
+            break;
+        default:
+            return false;
+        }
+        element->size = sizeof(uint8_t);
+        break;
+
+    case M_BSON_NULL:
+        element->type = JSON_TYPE_NULL;
+        element->size = 0;
+        break;
+
+    default:
+        return false;
+    }
+
+    if (offset + element->size > end) {
+        return false;
+    }
+    element->next_offset = offset + element->size;
+    return true;
+}
+
+static bool M_GetNumber(
+    const BSON_VIEW_ELEMENT *const element, JSON_NUMBER *const number)
+{
+    if (element->type != JSON_TYPE_NUMBER) {
+        return false;
+    }
+
+    // a binary number on the stack, so the DOM conversions can be reused
+    memset(number, 0, sizeof(JSON_NUMBER));
+    if (element->marker == M_BSON_INT32) {
+        int32_t value;
+        memcpy(&value, element->data, sizeof(int32_t));
+        number->type = JSON_NUMBER_TYPE_INT;
+        number->int_value = value;
+    } else {
+        number->type = JSON_NUMBER_TYPE_DOUBLE;
+        memcpy(&number->double_value, element->data, sizeof(double));
+    }
+    return true;
+}
+
+static bool M_GetDocument(
+    const BSON_VIEW_ELEMENT *const element, const uint8_t marker,
+    BSON_VIEW *const out_view)
+{
+    if (element->marker != marker) {
+        return false;
+    }
+    // the size was checked when the element was read
+    out_view->src = element->data;
+    out_view->size = element->size;
+    return true;
+}
+
+bool BSON_ViewInit(
+    BSON_VIEW *const view, const void *const src, const size_t src_size)
+{
+    view->src = src;
+    view->size = src_size;
+
+    int32_t size;
+    if (src == NULL || !M_ReadInt32(view, 0, src_size, &size)
+        || size < M_MIN_DOCUMENT_SIZE || (size_t)size > src_size
+        || view->src[size - 1] != '\0') {
+        view->src = NULL;
+        view->size = 0;
+        return false;
+    }
+
+    view->size = size;
+    return true;
+}
+
+bool BSON_ViewNext(
+    const BSON_VIEW *const view, BSON_VIEW_ELEMENT *const element)
+{
+    if (view->src == NULL) {
+        return false;
+    }
+
+    // elements sit between the length and the terminator
+    const size_t end = view->size - 1;
+    size_t offset =
+        element->next_offset ? element->next_offset : sizeof(int32_t);
+    if (offset >= end) {
+        return false;
+    }
+
+    element->marker = view->src[offset++];
+    const char *const key_end =
+        memchr(&view->src[offset], '\0', end - offset);
+    if (key_end == NULL) {
+        return false;
+    }
+    element->key = &view->src[offset];
+    offset = key_end - view->src + 1;
+
+    return M_ReadValue(view, offset, end, element);
+}
+
+bool BSON_ViewFind(
+    const BSON_VIEW *const view, const char *const key,
+    BSON_VIEW_ELEMENT *const element)
+{
+    BSON_VIEW_ELEMENT current = { 0 };
+    while (BSON_ViewNext(view, &current)) {
+        if (!strcmp(current.key, key)) {
+            *element = current;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BSON_ViewAt(
+    const BSON_VIEW *const view, size_t idx, BSON_VIEW_ELEMENT *const element)
+{
+    BSON_VIEW_ELEMENT current = { 0 };
+    while (BSON_ViewNext(view, &current)) {
+        if (idx-- == 0) {
+            *element = current;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t BSON_ViewCount(const BSON_VIEW *const view)
+{
+    size_t count = 0;
+    BSON_VIEW_ELEMENT current = { 0 };
+    while (BSON_ViewNext(view, &current)) {
+        count++;
+    }
+    return count;
+}
+
+int BSON_ViewElementGetBool(const BSON_VIEW_ELEMENT *const element, const int d)
+{
+    if (element->type == JSON_TYPE_TRUE) {
+        return 1;
+    } else if (element->type == JSON_TYPE_FALSE) {
+        return 0;
+    }
+    return d;
+}
+
+int BSON_ViewElementGetInt(const BSON_VIEW_ELEMENT *const element, const int d)
+{
+    JSON_NUMBER number;
+    return M_GetNumber(element, &number) ? JSON_NumberGetInt(&number) : d;
+}
+
+int64_t BSON_ViewElementGetInt64(
+    const BSON_VIEW_ELEMENT *const element, const int64_t d)
+{
+    JSON_NUMBER number;
+    return M_GetNumber(element, &number) ? JSON_NumberGetInt64(&number) : d;
+}
+
+double BSON_ViewElementGetDouble(
+    const BSON_VIEW_ELEMENT *const element, const double d)
+{
+    JSON_NUMBER number;
+    return M_GetNumber(element, &number) ? JSON_NumberGetDouble(&number) : d;
+}
+
+const char *BSON_ViewElementGetString(
+    const BSON_VIEW_ELEMENT *const element, const char *const d)
+{
+    // strings are null terminated in place
+    return element->type == JSON_TYPE_STRING ? element->data : d;
+}
+
+bool BSON_ViewElementGetObject(
+    const BSON_VIEW_ELEMENT *const element, BSON_VIEW *const out_view)
+{
+    return M_GetDocument(element, M_BSON_OBJECT, out_view);
+}
+
+bool BSON_ViewElementGetArray(
+    const BSON_VIEW_ELEMENT *const element, BSON_VIEW *const out_view)
+{
+    return M_GetDocument(element, M_BSON_ARRAY, out_view);
+}
+
+int BSON_ViewGetBool(
+    const BSON_VIEW *const view, const char *const key, const int d)
+{
+    BSON_VIEW_ELEMENT element;
+    return BSON_ViewFind(view, key, &element)
+        ? BSON_ViewElementGetBool(&element, d)
+        : d;
+}
+
+int BSON_ViewGetInt(
+    const BSON_VIEW *const view, const char *const key, const int d)
+{
+    BSON_VIEW_ELEMENT element;
+    return BSON_ViewFind(view, key, &element)
+        ? BSON_ViewElementGetInt(&element, d)
+        : d;
+}
+
+int64_t BSON_ViewGetInt64(
+    const BSON_VIEW *const view, const char *const key, const int64_t d)
+{
+    BSON_VIEW_ELEMENT element;
+    return BSON_ViewFind(view, key, &element)
+        ? BSON_ViewElementGetInt64(&element, d)
+        : d;
+}
+
+double BSON_ViewGetDouble(
+    const BSON_VIEW *const view, const char *const key, const double d)
+{
+    BSON_VIEW_ELEMENT element;
+    return BSON_ViewFind(view, key, &element)
+        ? BSON_ViewElementGetDouble(&element, d)
+        : d;
+}
+
+const char *BSON_ViewGetString(
+    const BSON_VIEW *const view, const char *const key, const char *const d)
+{
+    BSON_VIEW_ELEMENT element;
+    return BSON_ViewFind(view, key, &element)
+        ? BSON_ViewElementGetString(&element, d)
+        : d;
+}
+
+bool BSON_ViewGetObject(
+    const BSON_VIEW *const view, const char *const key,
+    BSON_VIEW *const out_view)
+{
+    BSON_VIEW_ELEMENT element;
+    return BSON_ViewFind(view, key, &element)
+        && BSON_ViewElementGetObject(&element, out_view);
+}
+
+bool BSON_ViewGetArray(
+    const BSON_VIEW *const view, const char *const key,
+    BSON_VIEW *const out_view)
+{
+    BSON_VIEW_ELEMENT element;
+    return BSON_ViewFind(view, key, &element)
+        && BSON_ViewElementGetArray(&element, out_view);
+}
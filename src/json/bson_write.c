@@ -5,6 +5,7 @@
 
 #include <assert.h>
 #include <float.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -131,6 +132,19 @@ static bool M_GetNumberWrappedSize(
     assert(size);
     assert(key);
 
+    switch (number->type) {
+    case JSON_NUMBER_TYPE_INT:
+        return M_GetInt32WrappedSize(size, key);
+    case JSON_NUMBER_TYPE_DOUBLE:
+        // BSON does not support NaN.
+        if (isnan(number->double_value)) {
+            return M_GetInt32WrappedSize(size, key);
+        }
+        return M_GetDoubleWrappedSize(size, key);
+    case JSON_NUMBER_TYPE_TEXT:
+        break;
+    }
+
     char *str = number->number;
     assert(str);
 
@@ -359,6 +373,22 @@ static char *M_WriteNumberWrapped(
     assert(data);
     assert(key);
     assert(number);
+
+    switch (number->type) {
+    case JSON_NUMBER_TYPE_INT:
+        return M_WriteInt32Wrapped(data, key, (int32_t)number->int_value);
+    case JSON_NUMBER_TYPE_DOUBLE:
+        // BSON does not support Infinity and NaN.
+        if (isnan(number->double_value)) {
+            return M_WriteInt32Wrapped(data, key, 0);
+        } else if (isinf(number->double_value)) {
+            return M_WriteDoubleWrapped(data, key, DBL_MAX);
+        }
+        return M_WriteDoubleWrapped(data, key, number->double_value);
+    case JSON_NUMBER_TYPE_TEXT:
+        break;
+    }
+
     char *str = number->number;
 
     // hexadecimal numbers
@@ -0,0 +1,88 @@
+#include "json.h"
+
+#include "memory.h"
+#include "utils.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define M_ALIGNMENT 16
+#define M_MIN_BLOCK_SIZE (64 * 1024)
+#define M_MAX_BLOCK_SIZE (1024 * 1024)
+
+typedef struct M_BLOCK {
+    struct M_BLOCK *prev;
+    size_t size;
+    size_t used;
+    char *data;
+} M_BLOCK;
+
+struct JSON_ARENA {
+    M_BLOCK *block;
+    size_t next_block_size;
+    JSON_ARENA_STATS stats;
+};
+
+static M_BLOCK *M_BlockNew(size_t size);
+
+static M_BLOCK *M_BlockNew(const size_t size)
+{
+    // the block memory is zeroed once, so allocations need not be
+    M_BLOCK *const block = Memory_Alloc(sizeof(M_BLOCK) + size + M_ALIGNMENT);
+    const uintptr_t data = (uintptr_t)(block + 1);
+    block->data =
+        (char *)((data + M_ALIGNMENT - 1) & ~(uintptr_t)(M_ALIGNMENT - 1));
+    block->size = size;
+    block->used = 0;
+    block->prev = NULL;
+    return block;
+}
+
+JSON_ARENA *JSON_ArenaNew(void)
+{
+    JSON_ARENA *const arena = Memory_Alloc(sizeof(JSON_ARENA));
+    arena->block = NULL;
+    arena->next_block_size = M_MIN_BLOCK_SIZE;
+    return arena;
+}
+
+void JSON_ArenaFree(JSON_ARENA *arena)
+{
+    if (!arena) {
+        return;
+    }
+    M_BLOCK *block = arena->block;
+    while (block) {
+        M_BLOCK *prev = block->prev;
+        Memory_FreePointer(&block);
+        block = prev;
+    }
+    Memory_FreePointer(&arena);
+}
+
+void *JSON_ArenaAlloc(JSON_ARENA *const arena, size_t size)
+{
+    size = (size + M_ALIGNMENT - 1) & ~(size_t)(M_ALIGNMENT - 1);
+
+    M_BLOCK *block = arena->block;
+    if (!block || block->used + size > block->size) {
+        block = M_BlockNew(MAX(arena->next_block_size, size));
+        block->prev = arena->block;
+        arena->block = block;
+        arena->next_block_size =
+            MIN(arena->next_block_size * 2, (size_t)M_MAX_BLOCK_SIZE);
+        arena->stats.blocks++;
+        arena->stats.reserved += block->size;
+    }
+
+    void *const result = &block->data[block->used];
+    block->used += size;
+    arena->stats.allocations++;
+    arena->stats.used += size;
+    return result;
+}
+
+JSON_ARENA_STATS JSON_ArenaGetStats(const JSON_ARENA *const arena)
+{
+    return arena->stats;
+}
@@ -1,12 +1,232 @@
 #include "json.h"
 
 #include "memory.h"
+#include "utils.h"
 
 #include <inttypes.h>
+#include <limits.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#define M_ELEMENTS_MIN_CAPACITY 8
+// decimal digits that fit in a 64-bit mantissa
+#define M_MAX_MANTISSA_DIGITS 19
+
+// smaller objects are cheaper to search linearly
+#define M_INDEX_MIN_LENGTH 8
+#define M_INDEX_MIN_CAPACITY 16
+
+struct JSON_OBJECT_INDEX {
+    // a power of two, at least twice the number of indexed elements
+    size_t capacity;
+    uint32_t *hashes;
+    JSON_OBJECT_ELEMENT **slots;
+};
+
+// powers of ten that are exactly representable as doubles
+static const double m_Pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static void *M_Alloc(JSON_ARENA *arena, size_t size);
+static JSON_NUMBER *M_NumberNewInt64(JSON_ARENA *arena, int64_t number);
+static JSON_NUMBER *M_NumberNewDouble(JSON_ARENA *arena, double number);
+static JSON_STRING *M_StringNew(JSON_ARENA *arena, const char *string);
+static JSON_VALUE *M_ValueNew(JSON_ARENA *arena, JSON_TYPE type, void *payload);
+static int M_NumberToInt(const JSON_NUMBER *num);
+static int64_t M_NumberToInt64(const JSON_NUMBER *num);
+static double M_NumberToDouble(const JSON_NUMBER *num);
+static void M_ArrayBuildElements(JSON_ARRAY *arr, size_t capacity);
+static uint32_t M_HashKey(const char *key);
+static bool M_IndexInsert(JSON_OBJECT_INDEX *index, JSON_OBJECT_ELEMENT *elem);
+static JSON_OBJECT_ELEMENT *M_IndexFind(
+    const JSON_OBJECT_INDEX *index, const char *key);
+static void M_ObjectDropIndex(JSON_OBJECT *obj);
+
+static void *M_Alloc(JSON_ARENA *const arena, const size_t size)
+{
+    return arena ? JSON_ArenaAlloc(arena, size) : Memory_Alloc(size);
+}
+
+static JSON_NUMBER *M_NumberNewInt64(
+    JSON_ARENA *const arena, const int64_t number)
+{
+    const size_t size = snprintf(NULL, 0, "%" PRId64, number) + 1;
+    char *const buf = M_Alloc(arena, size);
+    sprintf(buf, "%" PRId64, number);
+    JSON_NUMBER *const elem = M_Alloc(arena, sizeof(JSON_NUMBER));
+    elem->number = buf;
+    elem->number_size = size - 1;
+    elem->ref_count = arena ? 1 : 0;
+    elem->type = JSON_NUMBER_TYPE_INT;
+    elem->int_value = number;
+    return elem;
+}
+
+static JSON_NUMBER *M_NumberNewDouble(
+    JSON_ARENA *const arena, const double number)
+{
+    const size_t size = snprintf(NULL, 0, "%f", number) + 1;
+    char *const buf = M_Alloc(arena, size);
+    sprintf(buf, "%f", number);
+    JSON_NUMBER *const elem = M_Alloc(arena, sizeof(JSON_NUMBER));
+    elem->number = buf;
+    elem->number_size = size - 1;
+    elem->ref_count = arena ? 1 : 0;
+    elem->type = JSON_NUMBER_TYPE_DOUBLE;
+    elem->double_value = number;
+    return elem;
+}
+
+static JSON_STRING *M_StringNew(
+    JSON_ARENA *const arena, const char *const string)
+{
+    const size_t size = strlen(string);
+    JSON_STRING *const str = M_Alloc(arena, sizeof(JSON_STRING));
+    str->string = M_Alloc(arena, size + 1);
+    memcpy(str->string, string, size + 1);
+    str->string_size = size;
+    str->ref_count = arena ? 1 : 0;
+    return str;
+}
+
+static JSON_VALUE *M_ValueNew(
+    JSON_ARENA *const arena, const JSON_TYPE type, void *const payload)
+{
+    // nodes in an arena are never freed one by one
+    JSON_VALUE *const value = M_Alloc(arena, sizeof(JSON_VALUE));
+    value->type = type;
+    value->payload = payload;
+    value->ref_count = arena ? 1 : 0;
+    return value;
+}
+
+static int M_NumberToInt(const JSON_NUMBER *const num)
+{
+    switch (num->type) {
+    case JSON_NUMBER_TYPE_INT:
+        return (int)num->int_value;
+    case JSON_NUMBER_TYPE_DOUBLE:
+        if (num->double_value != num->double_value) {
+            return 0;
+        }
+        return (int)MAX(MIN(num->double_value, INT_MAX), INT_MIN);
+    default:
+        return atoi(num->number);
+    }
+}
+
+static int64_t M_NumberToInt64(const JSON_NUMBER *const num)
+{
+    switch (num->type) {
+    case JSON_NUMBER_TYPE_INT:
+        return num->int_value;
+    case JSON_NUMBER_TYPE_DOUBLE:
+        if (num->double_value != num->double_value) {
+            return 0;
+        } else if (num->double_value >= (double)INT64_MAX) {
+            // INT64_MAX itself rounds up to 2^63 as a double
+            return INT64_MAX;
+        }
+        return (int64_t)MAX(num->double_value, (double)INT64_MIN);
+    default:
+        return strtoll(num->number, NULL, 10);
+    }
+}
+
+static double M_NumberToDouble(const JSON_NUMBER *const num)
+{
+    switch (num->type) {
+    case JSON_NUMBER_TYPE_INT:
+        return num->int_value;
+    case JSON_NUMBER_TYPE_DOUBLE:
+        return num->double_value;
+    default:
+        return atof(num->number);
+    }
+}
+
+static void M_ArrayBuildElements(JSON_ARRAY *const arr, size_t capacity)
+{
+    capacity = MAX(capacity, (size_t)M_ELEMENTS_MIN_CAPACITY);
+    if (arr->arena) {
+        // the old vector goes away with the arena
+        arr->elements = JSON_ArenaAlloc(
+            arr->arena, sizeof(JSON_ARRAY_ELEMENT *) * capacity);
+    } else {
+        arr->elements = Memory_Realloc(
+            arr->elements, sizeof(JSON_ARRAY_ELEMENT *) * capacity);
+    }
+    arr->elements_capacity = capacity;
+
+    size_t i = 0;
+    for (JSON_ARRAY_ELEMENT *elem = arr->start; elem; elem = elem->next) {
+        arr->elements[i++] = elem;
+    }
+}
+
+static uint32_t M_HashKey(const char *key)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    while (*key) {
+        hash ^= (uint8_t)*key++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool M_IndexInsert(
+    JSON_OBJECT_INDEX *const index, JSON_OBJECT_ELEMENT *const elem)
+{
+    const uint32_t hash = M_HashKey(elem->name->string);
+    const size_t mask = index->capacity - 1;
+    size_t i = hash & mask;
+    while (index->slots[i]) {
+        // the first of duplicate keys wins, like in a linear search
+        if (index->hashes[i] == hash
+            && !strcmp(index->slots[i]->name->string, elem->name->string)) {
+            return false;
+        }
+        i = (i + 1) & mask;
+    }
+    index->hashes[i] = hash;
+    index->slots[i] = elem;
+    return true;
+}
+
+static JSON_OBJECT_ELEMENT *M_IndexFind(
+    const JSON_OBJECT_INDEX *const index, const char *const key)
+{
+    const uint32_t hash = M_HashKey(key);
+    const size_t mask = index->capacity - 1;
+    size_t i = hash & mask;
+    while (index->slots[i]) {
+        if (index->hashes[i] == hash
+            && !strcmp(index->slots[i]->name->string, key)) {
+            return index->slots[i];
+        }
+        i = (i + 1) & mask;
+    }
+    return NULL;
+}
+
+static void M_ObjectDropIndex(JSON_OBJECT *const obj)
+{
+    if (!obj->index) {
+        return;
+    } else if (obj->arena) {
+        obj->index = NULL;
+        return;
+    }
+    Memory_FreePointer(&obj->index->hashes);
+    Memory_FreePointer(&obj->index->slots);
+    Memory_FreePointer(&obj->index);
+}
+
 JSON_STRING *JSON_ValueAsString(JSON_VALUE *const value)
 {
     if (!value || value->type != JSON_TYPE_STRING) {
@@ -60,35 +280,17 @@ int JSON_ValueIsNull(const JSON_VALUE *const value)
 
 JSON_NUMBER *JSON_NumberNewInt(int number)
 {
-    size_t size = snprintf(NULL, 0, "%d", number) + 1;
-    char *buf = Memory_Alloc(size);
-    sprintf(buf, "%d", number);
-    JSON_NUMBER *elem = Memory_Alloc(sizeof(JSON_NUMBER));
-    elem->number = buf;
-    elem->number_size = strlen(buf);
-    return elem;
+    return M_NumberNewInt64(NULL, number);
 }
 
 JSON_NUMBER *JSON_NumberNewInt64(int64_t number)
 {
-    size_t size = snprintf(NULL, 0, "%" PRId64, number) + 1;
-    char *buf = Memory_Alloc(size);
-    sprintf(buf, "%" PRId64, number);
-    JSON_NUMBER *elem = Memory_Alloc(sizeof(JSON_NUMBER));
-    elem->number = buf;
-    elem->number_size = strlen(buf);
-    return elem;
+    return M_NumberNewInt64(NULL, number);
 }
 
 JSON_NUMBER *JSON_NumberNewDouble(double number)
 {
-    size_t size = snprintf(NULL, 0, "%f", number) + 1;
-    char *buf = Memory_Alloc(size);
-    sprintf(buf, "%f", number);
-    JSON_NUMBER *elem = Memory_Alloc(sizeof(JSON_NUMBER));
-    elem->number = buf;
-    elem->number_size = strlen(buf);
-    return elem;
+    return M_NumberNewDouble(NULL, number);
 }
 
 void JSON_NumberFree(JSON_NUMBER *num)
@@ -99,12 +301,103 @@ void JSON_NumberFree(JSON_NUMBER *num)
     }
 }
 
+void JSON_NumberCacheValue(JSON_NUMBER *const num)
+{
+    const char *str = num->number;
+    const bool is_negative = str[0] == '-';
+    if (str[0] == '+' || str[0] == '-') {
+        str++;
+    }
+
+    if (str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) {
+        num->type = JSON_NUMBER_TYPE_INT;
+        num->int_value = (int64_t)json_strtoumax(str, NULL, 16);
+        return;
+    }
+
+    uint64_t mantissa = 0;
+    int32_t digits = 0;
+    int32_t exponent = 0;
+    bool is_int = true;
+    bool is_truncated = false;
+    for (; *str >= '0' && *str <= '9'; str++) {
+        if (digits < M_MAX_MANTISSA_DIGITS) {
+            mantissa = mantissa * 10 + (*str - '0');
+            digits += mantissa != 0;
+        } else {
+            is_truncated = true;
+            exponent++;
+        }
+    }
+    if (*str == '.') {
+        is_int = false;
+        for (str++; *str >= '0' && *str <= '9'; str++) {
+            if (digits < M_MAX_MANTISSA_DIGITS) {
+                mantissa = mantissa * 10 + (*str - '0');
+                digits += mantissa != 0;
+                exponent--;
+            } else {
+                is_truncated = true;
+            }
+        }
+    }
+    if (*str == 'e' || *str == 'E') {
+        is_int = false;
+        str++;
+        const bool is_exponent_negative = *str == '-';
+        if (*str == '+' || *str == '-') {
+            str++;
+        }
+        int32_t value = 0;
+        for (; *str >= '0' && *str <= '9'; str++) {
+            value = MIN(value * 10 + (*str - '0'), 100000);
+        }
+        exponent += is_exponent_negative ? -value : value;
+    }
+
+    if (*str != '\0' || is_truncated) {
+        // Infinity, NaN and long mantissas are left to the C library
+    } else if (is_int && mantissa <= (uint64_t)INT64_MAX) {
+        num->type = JSON_NUMBER_TYPE_INT;
+        num->int_value = is_negative ? -(int64_t)mantissa : (int64_t)mantissa;
+        return;
+    } else if (
+        mantissa <= (UINT64_C(1) << 53) && exponent >= -22 && exponent <= 22) {
+        // both operands are exact, so the single rounding of the division or
+        // multiplication gives the correctly rounded result
+        double value = (double)mantissa;
+        if (exponent < 0) {
+            value /= m_Pow10[-exponent];
+        } else {
+            value *= m_Pow10[exponent];
+        }
+        num->type = JSON_NUMBER_TYPE_DOUBLE;
+        num->double_value = is_negative ? -value : value;
+        return;
+    }
+
+    num->type = JSON_NUMBER_TYPE_DOUBLE;
+    num->double_value = strtod(num->number, NULL);
+}
+
+int JSON_NumberGetInt(const JSON_NUMBER *const num)
+{
+    return M_NumberToInt(num);
+}
+
+int64_t JSON_NumberGetInt64(const JSON_NUMBER *const num)
+{
+    return M_NumberToInt64(num);
+}
+
+double JSON_NumberGetDouble(const JSON_NUMBER *const num)
+{
+    return M_NumberToDouble(num);
+}
+
 JSON_STRING *JSON_StringNew(const char *string)
 {
-    JSON_STRING *str = Memory_Alloc(sizeof(JSON_STRING));
-    str->string = Memory_DupStr(string);
-    str->string_size = strlen(string);
-    return str;
+    return M_StringNew(NULL, string);
 }
 
 void JSON_StringFree(JSON_STRING *str)
@@ -117,14 +410,30 @@ void JSON_StringFree(JSON_STRING *str)
 
 JSON_ARRAY *JSON_ArrayNew(void)
 {
-    JSON_ARRAY *arr = Memory_Alloc(sizeof(JSON_ARRAY));
+    return JSON_ArrayNewInArena(NULL);
+}
+
+JSON_ARRAY *JSON_ArrayNewInArena(JSON_ARENA *const arena)
+{
+    JSON_ARRAY *arr = M_Alloc(arena, sizeof(JSON_ARRAY));
     arr->start = NULL;
     arr->length = 0;
+    arr->ref_count = arena ? 1 : 0;
+    arr->elements = NULL;
+    arr->elements_capacity = 0;
+    arr->arena = arena;
     return arr;
 }
 
 void JSON_ArrayFree(JSON_ARRAY *arr)
 {
+    // the element vector is allocated separately even for parsed arrays
+    if (!arr->arena) {
+        Memory_FreePointer(&arr->elements);
+    }
+    arr->elements = NULL;
+    arr->elements_capacity = 0;
+
     JSON_ARRAY_ELEMENT *elem = arr->start;
     while (elem) {
         JSON_ARRAY_ELEMENT *next = elem->next;
@@ -146,49 +455,64 @@ void JSON_ArrayElementFree(JSON_ARRAY_ELEMENT *element)
 
 void JSON_ArrayAppend(JSON_ARRAY *arr, JSON_VALUE *value)
 {
-    JSON_ARRAY_ELEMENT *elem = Memory_Alloc(sizeof(JSON_ARRAY_ELEMENT));
+    JSON_ARRAY_ELEMENT *elem = M_Alloc(arr->arena, sizeof(JSON_ARRAY_ELEMENT));
+    elem->ref_count = arr->arena ? 1 : 0;
     elem->value = value;
     elem->next = NULL;
-    if (arr->start) {
-        JSON_ARRAY_ELEMENT *target = arr->start;
-        while (target->next) {
-            target = target->next;
-        }
-        target->next = elem;
+
+    // the vector doubles as a tail pointer, keeping appends constant time
+    if (!arr->elements || arr->length == arr->elements_capacity) {
+        M_ArrayBuildElements(arr, arr->length * 2);
+    }
+    if (arr->length) {
+        arr->elements[arr->length - 1]->next = elem;
     } else {
         arr->start = elem;
     }
-    arr->length++;
+    arr->elements[arr->length++] = elem;
 }
 
 void JSON_ArrayApendBool(JSON_ARRAY *arr, int b)
 {
-    JSON_ArrayAppend(arr, JSON_ValueFromBool(b));
+    JSON_ArrayAppend(
+        arr,
+        M_ValueNew(arr->arena, b ? JSON_TYPE_TRUE : JSON_TYPE_FALSE, NULL));
 }
 
 void JSON_ArrayAppendInt(JSON_ARRAY *arr, int number)
 {
-    JSON_ArrayAppend(arr, JSON_ValueFromNumber(JSON_NumberNewInt(number)));
+    JSON_ArrayAppend(
+        arr,
+        M_ValueNew(
+            arr->arena, JSON_TYPE_NUMBER,
+            M_NumberNewInt64(arr->arena, number)));
 }
 
 void JSON_ArrayAppendDouble(JSON_ARRAY *arr, double number)
 {
-    JSON_ArrayAppend(arr, JSON_ValueFromNumber(JSON_NumberNewDouble(number)));
+    JSON_ArrayAppend(
+        arr,
+        M_ValueNew(
+            arr->arena, JSON_TYPE_NUMBER,
+            M_NumberNewDouble(arr->arena, number)));
 }
 
 void JSON_ArrayAppendString(JSON_ARRAY *arr, const char *string)
 {
-    JSON_ArrayAppend(arr, JSON_ValueFromString(JSON_StringNew(string)));
+    JSON_ArrayAppend(
+        arr,
+        M_ValueNew(
+            arr->arena, JSON_TYPE_STRING, M_StringNew(arr->arena, string)));
 }
 
 void JSON_ArrayAppendArray(JSON_ARRAY *arr, JSON_ARRAY *arr2)
 {
-    JSON_ArrayAppend(arr, JSON_ValueFromArray(arr2));
+    JSON_ArrayAppend(arr, M_ValueNew(arr->arena, JSON_TYPE_ARRAY, arr2));
 }
 
 void JSON_ArrayAppendObject(JSON_ARRAY *arr, JSON_OBJECT *obj)
 {
-    JSON_ArrayAppend(arr, JSON_ValueFromObject(obj));
+    JSON_ArrayAppend(arr, M_ValueNew(arr->arena, JSON_TYPE_OBJECT, obj));
 }
 
 JSON_VALUE *JSON_ArrayGetValue(JSON_ARRAY *arr, const size_t idx)
@@ -196,11 +520,10 @@ JSON_VALUE *JSON_ArrayGetValue(JSON_ARRAY *arr, const size_t idx)
     if (!arr || idx >= arr->length) {
         return NULL;
     }
-    JSON_ARRAY_ELEMENT *elem = arr->start;
-    for (size_t i = 0; i < idx; i++) {
-        elem = elem->next;
+    if (!arr->elements) {
+        M_ArrayBuildElements(arr, arr->length);
     }
-    return elem->value;
+    return arr->elements[idx]->value;
 }
 
 int JSON_ArrayGetBool(JSON_ARRAY *arr, const size_t idx, int d)
@@ -219,7 +542,7 @@ int JSON_ArrayGetInt(JSON_ARRAY *arr, const size_t idx, int d)
     JSON_VALUE *value = JSON_ArrayGetValue(arr, idx);
     JSON_NUMBER *num = JSON_ValueAsNumber(value);
     if (num) {
-        return atoi(num->number);
+        return M_NumberToInt(num);
     }
     return d;
 }
@@ -229,7 +552,7 @@ double JSON_ArrayGetDouble(JSON_ARRAY *arr, const size_t idx, double d)
     JSON_VALUE *value = JSON_ArrayGetValue(arr, idx);
     JSON_NUMBER *num = JSON_ValueAsNumber(value);
     if (num) {
-        return atof(num->number);
+        return M_NumberToDouble(num);
     }
     return d;
 }
@@ -261,14 +584,25 @@ JSON_OBJECT *JSON_ArrayGetObject(JSON_ARRAY *arr, const size_t idx)
 
 JSON_OBJECT *JSON_ObjectNew(void)
 {
-    JSON_OBJECT *obj = Memory_Alloc(sizeof(JSON_OBJECT));
+    return JSON_ObjectNewInArena(NULL);
+}
+
+JSON_OBJECT *JSON_ObjectNewInArena(JSON_ARENA *const arena)
+{
+    JSON_OBJECT *obj = M_Alloc(arena, sizeof(JSON_OBJECT));
     obj->start = NULL;
     obj->length = 0;
+    obj->ref_count = arena ? 1 : 0;
+    obj->index = NULL;
+    obj->arena = arena;
     return obj;
 }
 
 void JSON_ObjectFree(JSON_OBJECT *obj)
 {
+    // the index is allocated separately even for parsed objects
+    M_ObjectDropIndex(obj);
+
     JSON_OBJECT_ELEMENT *elem = obj->start;
     while (elem) {
         JSON_OBJECT_ELEMENT *next = elem->next;
@@ -291,8 +625,10 @@ void JSON_ObjectElementFree(JSON_OBJECT_ELEMENT *element)
 
 void JSON_ObjectAppend(JSON_OBJECT *obj, const char *key, JSON_VALUE *value)
 {
-    JSON_OBJECT_ELEMENT *elem = Memory_Alloc(sizeof(JSON_OBJECT_ELEMENT));
-    elem->name = JSON_StringNew(key);
+    JSON_OBJECT_ELEMENT *elem =
+        M_Alloc(obj->arena, sizeof(JSON_OBJECT_ELEMENT));
+    elem->ref_count = obj->arena ? 1 : 0;
+    elem->name = M_StringNew(obj->arena, key);
     elem->value = value;
     elem->next = NULL;
     if (obj->start) {
@@ -305,46 +641,65 @@ void JSON_ObjectAppend(JSON_OBJECT *obj, const char *key, JSON_VALUE *value)
         obj->start = elem;
     }
     obj->length++;
+
+    if (obj->index) {
+        if (obj->length * 2 > obj->index->capacity) {
+            JSON_ObjectBuildIndex(obj);
+        } else {
+            M_IndexInsert(obj->index, elem);
+        }
+    }
 }
 
 void JSON_ObjectAppendBool(JSON_OBJECT *obj, const char *key, int b)
 {
-    JSON_ObjectAppend(obj, key, JSON_ValueFromBool(b));
+    JSON_ObjectAppend(
+        obj, key,
+        M_ValueNew(obj->arena, b ? JSON_TYPE_TRUE : JSON_TYPE_FALSE, NULL));
 }
 
 void JSON_ObjectAppendInt(JSON_OBJECT *obj, const char *key, int number)
 {
-    JSON_ObjectAppend(
-        obj, key, JSON_ValueFromNumber(JSON_NumberNewInt(number)));
+    JSON_ObjectAppendInt64(obj, key, number);
 }
 
 void JSON_ObjectAppendInt64(JSON_OBJECT *obj, const char *key, int64_t number)
 {
     JSON_ObjectAppend(
-        obj, key, JSON_ValueFromNumber(JSON_NumberNewInt64(number)));
+        obj, key,
+        M_ValueNew(
+            obj->arena, JSON_TYPE_NUMBER,
+            M_NumberNewInt64(obj->arena, number)));
 }
 
 void JSON_ObjectAppendDouble(JSON_OBJECT *obj, const char *key, double number)
 {
     JSON_ObjectAppend(
-        obj, key, JSON_ValueFromNumber(JSON_NumberNewDouble(number)));
+        obj, key,
+        M_ValueNew(
+            obj->arena, JSON_TYPE_NUMBER,
+            M_NumberNewDouble(obj->arena, number)));
 }
 
 void JSON_ObjectAppendString(
     JSON_OBJECT *obj, const char *key, const char *string)
 {
-    JSON_ObjectAppend(obj, key, JSON_ValueFromString(JSON_StringNew(string)));
+    JSON_ObjectAppend(
+        obj, key,
+        M_ValueNew(
+            obj->arena, JSON_TYPE_STRING, M_StringNew(obj->arena, string)));
 }
 
 void JSON_ObjectAppendArray(JSON_OBJECT *obj, const char *key, JSON_ARRAY *arr)
 {
-    JSON_ObjectAppend(obj, key, JSON_ValueFromArray(arr));
+    JSON_ObjectAppend(obj, key, M_ValueNew(obj->arena, JSON_TYPE_ARRAY, arr));
 }
 
 void JSON_ObjectAppendObject(
     JSON_OBJECT *obj, const char *key, JSON_OBJECT *obj2)
 {
-    JSON_ObjectAppend(obj, key, JSON_ValueFromObject(obj2));
+    JSON_ObjectAppend(
+        obj, key, M_ValueNew(obj->arena, JSON_TYPE_OBJECT, obj2));
 }
 
 void JSON_ObjectEvictKey(JSON_OBJECT *obj, const char *key)
@@ -362,6 +717,7 @@ void JSON_ObjectEvictKey(JSON_OBJECT *obj, const char *key)
                 prev->next = elem->next;
             }
             JSON_ObjectElementFree(elem);
+            M_ObjectDropIndex(obj);
             return;
         }
         prev = elem;
@@ -369,11 +725,44 @@ void JSON_ObjectEvictKey(JSON_OBJECT *obj, const char *key)
     }
 }
 
+void JSON_ObjectBuildIndex(JSON_OBJECT *obj)
+{
+    if (!obj) {
+        return;
+    }
+    M_ObjectDropIndex(obj);
+
+    size_t capacity = M_INDEX_MIN_CAPACITY;
+    while (capacity < obj->length * 2) {
+        capacity *= 2;
+    }
+
+    obj->index = M_Alloc(obj->arena, sizeof(JSON_OBJECT_INDEX));
+    obj->index->capacity = capacity;
+    obj->index->hashes = M_Alloc(obj->arena, sizeof(uint32_t) * capacity);
+    obj->index->slots =
+        M_Alloc(obj->arena, sizeof(JSON_OBJECT_ELEMENT *) * capacity);
+
+    JSON_OBJECT_ELEMENT *elem = obj->start;
+    while (elem) {
+        M_IndexInsert(obj->index, elem);
+        elem = elem->next;
+    }
+}
+
 JSON_VALUE *JSON_ObjectGetValue(JSON_OBJECT *obj, const char *key)
 {
     if (!obj) {
         return NULL;
     }
+    if (!obj->index && obj->length >= M_INDEX_MIN_LENGTH) {
+        JSON_ObjectBuildIndex(obj);
+    }
+    if (obj->index) {
+        JSON_OBJECT_ELEMENT *const elem = M_IndexFind(obj->index, key);
+        return elem ? elem->value : NULL;
+    }
+
     JSON_OBJECT_ELEMENT *elem = obj->start;
     while (elem) {
         if (!strcmp(elem->name->string, key)) {
@@ -400,7 +789,7 @@ int JSON_ObjectGetInt(JSON_OBJECT *obj, const char *key, int d)
     JSON_VALUE *value = JSON_ObjectGetValue(obj, key);
     JSON_NUMBER *num = JSON_ValueAsNumber(value);
     if (num) {
-        return atoi(num->number);
+        return M_NumberToInt(num);
     }
     return d;
 }
@@ -410,7 +799,7 @@ int64_t JSON_ObjectGetInt64(JSON_OBJECT *obj, const char *key, int64_t d)
     JSON_VALUE *value = JSON_ObjectGetValue(obj, key);
     JSON_NUMBER *num = JSON_ValueAsNumber(value);
     if (num) {
-        return strtoll(num->number, NULL, 10);
+        return M_NumberToInt64(num);
     }
     return d;
 }
@@ -420,7 +809,7 @@ double JSON_ObjectGetDouble(JSON_OBJECT *obj, const char *key, double d)
     JSON_VALUE *value = JSON_ObjectGetValue(obj, key);
     JSON_NUMBER *num = JSON_ValueAsNumber(value);
     if (num) {
-        return atof(num->number);
+        return M_NumberToDouble(num);
     }
     return d;
 }
@@ -452,42 +841,27 @@ JSON_OBJECT *JSON_ObjectGetObject(JSON_OBJECT *obj, const char *key)
 
 JSON_VALUE *JSON_ValueFromBool(int b)
 {
-    JSON_VALUE *value = Memory_Alloc(sizeof(JSON_VALUE));
-    value->type = b ? JSON_TYPE_TRUE : JSON_TYPE_FALSE;
-    value->payload = NULL;
-    return value;
+    return M_ValueNew(NULL, b ? JSON_TYPE_TRUE : JSON_TYPE_FALSE, NULL);
 }
 
 JSON_VALUE *JSON_ValueFromNumber(JSON_NUMBER *num)
 {
-    JSON_VALUE *value = Memory_Alloc(sizeof(JSON_VALUE));
-    value->type = JSON_TYPE_NUMBER;
-    value->payload = num;
-    return value;
+    return M_ValueNew(NULL, JSON_TYPE_NUMBER, num);
 }
 
 JSON_VALUE *JSON_ValueFromString(JSON_STRING *str)
 {
-    JSON_VALUE *value = Memory_Alloc(sizeof(JSON_VALUE));
-    value->type = JSON_TYPE_STRING;
-    value->payload = str;
-    return value;
+    return M_ValueNew(NULL, JSON_TYPE_STRING, str);
 }
 
 JSON_VALUE *JSON_ValueFromArray(JSON_ARRAY *arr)
 {
-    JSON_VALUE *value = Memory_Alloc(sizeof(JSON_VALUE));
-    value->type = JSON_TYPE_ARRAY;
-    value->payload = arr;
-    return value;
+    return M_ValueNew(NULL, JSON_TYPE_ARRAY, arr);
 }
 
 JSON_VALUE *JSON_ValueFromObject(JSON_OBJECT *obj)
 {
-    JSON_VALUE *value = Memory_Alloc(sizeof(JSON_VALUE));
-    value->type = JSON_TYPE_OBJECT;
-    value->payload = obj;
-    return value;
+    return M_ValueNew(NULL, JSON_TYPE_OBJECT, obj);
 }
 
 void JSON_ValueFree(JSON_VALUE *value)
@@ -495,26 +869,29 @@ void JSON_ValueFree(JSON_VALUE *value)
     if (!value) {
         return;
     }
-    if (!value->ref_count) {
-        switch (value->type) {
-        case JSON_TYPE_NUMBER:
-            JSON_NumberFree((JSON_NUMBER *)value->payload);
-            break;
-        case JSON_TYPE_STRING:
-            JSON_StringFree((JSON_STRING *)value->payload);
-            break;
-        case JSON_TYPE_ARRAY:
-            JSON_ArrayFree((JSON_ARRAY *)value->payload);
-            break;
-        case JSON_TYPE_OBJECT:
-            JSON_ObjectFree((JSON_OBJECT *)value->payload);
-            break;
-        case JSON_TYPE_TRUE:
-        case JSON_TYPE_NULL:
-        case JSON_TYPE_FALSE:
-            break;
-        }
 
+    // walk the values of parsed documents too, as their objects may own
+    // separately allocated indices; each payload checks its own ref count
+    switch (value->type) {
+    case JSON_TYPE_NUMBER:
+        JSON_NumberFree((JSON_NUMBER *)value->payload);
+        break;
+    case JSON_TYPE_STRING:
+        JSON_StringFree((JSON_STRING *)value->payload);
+        break;
+    case JSON_TYPE_ARRAY:
+        JSON_ArrayFree((JSON_ARRAY *)value->payload);
+        break;
+    case JSON_TYPE_OBJECT:
+        JSON_ObjectFree((JSON_OBJECT *)value->payload);
+        break;
+    case JSON_TYPE_TRUE:
+    case JSON_TYPE_NULL:
+    case JSON_TYPE_FALSE:
+        break;
+    }
+
+    if (!value->ref_count) {
         Memory_Free(value);
     }
 }
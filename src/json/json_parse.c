@@ -1,6 +1,17 @@
 #include "json.h"
 
 #include "memory.h"
+#include "reader.h"
+
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+    #include <emmintrin.h>
+    #define M_USE_SSE2
+#elif defined(__GNUC__) && defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define M_USE_NEON
+#endif
 
 typedef struct {
     const char *src;
@@ -20,6 +31,16 @@ static int M_HexDigit(const char c);
 static int M_HexValue(
     const char *c, const unsigned long size, unsigned long *result);
 
+#if defined(M_USE_SSE2)
+static size_t M_FirstMatch(__m128i matches);
+#elif defined(M_USE_NEON)
+static size_t M_FirstMatch(uint8x16_t matches);
+#endif
+static size_t M_ScanBlanks(const char *src, size_t offset, size_t size);
+static size_t M_ScanStringRun(
+    const char *src, size_t offset, size_t size, char quote);
+static size_t M_ScanDigits(const char *src, size_t offset, size_t size);
+
 static int M_SkipWhitespace(M_STATE *state);
 static int M_SkipCStyleComments(M_STATE *state);
 static int M_SkipAllSkippables(M_STATE *state);
@@ -41,6 +62,16 @@ static void M_HandleObject(
 static void M_HandleArray(M_STATE *state, JSON_ARRAY *array);
 static void M_HandleNumber(M_STATE *state, JSON_NUMBER *number);
 
+static JSON_TOKEN M_ReadValue(JSON_READER *reader, M_STATE *state);
+static JSON_TOKEN M_ReadString(
+    JSON_READER *reader, M_STATE *state, int is_key);
+static JSON_TOKEN M_ReadNumber(JSON_READER *reader, M_STATE *state);
+static JSON_TOKEN M_ReadContainer(
+    JSON_READER *reader, M_STATE *state, int is_array);
+static JSON_TOKEN M_ReadObjectNext(JSON_READER *reader, M_STATE *state);
+static JSON_TOKEN M_ReadArrayNext(JSON_READER *reader, M_STATE *state);
+static JSON_TOKEN M_ReadNext(JSON_READER *reader, M_STATE *state);
+
 static int M_HexDigit(const char c)
 {
     if ('0' <= c && c <= '9') {
@@ -77,6 +108,154 @@ static int M_HexValue(
     return 1;
 }
 
+/* The scanners below return the offset of the first byte at or after offset
+ * that ends the run, or size. They look at 16 bytes at a time where SSE2 or
+ * NEON is available and finish the tail byte by byte. */
+#if defined(M_USE_SSE2)
+static size_t M_FirstMatch(const __m128i matches)
+{
+    const int mask = _mm_movemask_epi8(matches);
+    return mask != 0 ? (size_t)__builtin_ctz(mask) : 16;
+}
+#elif defined(M_USE_NEON)
+static size_t M_FirstMatch(const uint8x16_t matches)
+{
+    /* narrow every byte of the mask to 4 bits. */
+    const uint64_t mask = vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0);
+    return mask != 0 ? (size_t)__builtin_ctzll(mask) >> 2 : 16;
+}
+#endif
+
+static size_t M_ScanBlanks(
+    const char *const src, size_t offset, const size_t size)
+{
+    /* newlines end the run too, as the caller needs to count them. */
+#if defined(M_USE_SSE2)
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i cr = _mm_set1_epi8('\r');
+    while (offset + 16 <= size) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i *)&src[offset]);
+        const __m128i blanks = _mm_or_si128(
+            _mm_or_si128(
+                _mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+            _mm_cmpeq_epi8(chunk, cr));
+        const size_t idx =
+            M_FirstMatch(_mm_xor_si128(blanks, _mm_set1_epi8(-1)));
+        offset += idx;
+        if (idx != 16) {
+            return offset;
+        }
+    }
+#elif defined(M_USE_NEON)
+    const uint8x16_t space = vdupq_n_u8(' ');
+    const uint8x16_t tab = vdupq_n_u8('\t');
+    const uint8x16_t cr = vdupq_n_u8('\r');
+    while (offset + 16 <= size) {
+        const uint8x16_t chunk = vld1q_u8((const uint8_t *)&src[offset]);
+        const uint8x16_t blanks = vorrq_u8(
+            vorrq_u8(vceqq_u8(chunk, space), vceqq_u8(chunk, tab)),
+            vceqq_u8(chunk, cr));
+        const size_t idx = M_FirstMatch(vmvnq_u8(blanks));
+        offset += idx;
+        if (idx != 16) {
+            return offset;
+        }
+    }
+#endif
+    while (offset < size
+           && (' ' == src[offset] || '\t' == src[offset]
+               || '\r' == src[offset])) {
+        offset++;
+    }
+    return offset;
+}
+
+static size_t M_ScanStringRun(
+    const char *const src, size_t offset, const size_t size, const char quote)
+{
+    /* stop at anything that needs a closer look: the closing quote, escapes
+     * and control characters. */
+#if defined(M_USE_SSE2)
+    const __m128i quotes = _mm_set1_epi8(quote);
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i max_control = _mm_set1_epi8(0x1f);
+    while (offset + 16 <= size) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i *)&src[offset]);
+        const __m128i control = _mm_cmpeq_epi8(
+            _mm_max_epu8(chunk, max_control), max_control);
+        const __m128i stops = _mm_or_si128(
+            _mm_or_si128(
+                _mm_cmpeq_epi8(chunk, quotes),
+                _mm_cmpeq_epi8(chunk, backslash)),
+            control);
+        const size_t idx = M_FirstMatch(stops);
+        offset += idx;
+        if (idx != 16) {
+            return offset;
+        }
+    }
+#elif defined(M_USE_NEON)
+    const uint8x16_t quotes = vdupq_n_u8((uint8_t)quote);
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t min_printable = vdupq_n_u8(0x20);
+    while (offset + 16 <= size) {
+        const uint8x16_t chunk = vld1q_u8((const uint8_t *)&src[offset]);
+        const uint8x16_t stops = vorrq_u8(
+            vorrq_u8(vceqq_u8(chunk, quotes), vceqq_u8(chunk, backslash)),
+            vcltq_u8(chunk, min_printable));
+        const size_t idx = M_FirstMatch(stops);
+        offset += idx;
+        if (idx != 16) {
+            return offset;
+        }
+    }
+#endif
+    while (offset < size && quote != src[offset] && '\\' != src[offset]
+           && (unsigned char)src[offset] >= 0x20) {
+        offset++;
+    }
+    return offset;
+}
+
+static size_t M_ScanDigits(
+    const char *const src, size_t offset, const size_t size)
+{
+#if defined(M_USE_SSE2)
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+    while (offset + 16 <= size) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i *)&src[offset]);
+        const __m128i value = _mm_sub_epi8(chunk, zero);
+        const __m128i digits =
+            _mm_cmpeq_epi8(_mm_min_epu8(value, nine), value);
+        const size_t idx =
+            M_FirstMatch(_mm_xor_si128(digits, _mm_set1_epi8(-1)));
+        offset += idx;
+        if (idx != 16) {
+            return offset;
+        }
+    }
+#elif defined(M_USE_NEON)
+    const uint8x16_t zero = vdupq_n_u8('0');
+    const uint8x16_t nine = vdupq_n_u8(9);
+    while (offset + 16 <= size) {
+        const uint8x16_t chunk = vld1q_u8((const uint8_t *)&src[offset]);
+        const uint8x16_t digits = vcleq_u8(vsubq_u8(chunk, zero), nine);
+        const size_t idx = M_FirstMatch(vmvnq_u8(digits));
+        offset += idx;
+        if (idx != 16) {
+            return offset;
+        }
+    }
+#endif
+    while (offset < size && '0' <= src[offset] && src[offset] <= '9') {
+        offset++;
+    }
+    return offset;
+}
+
 static int M_SkipWhitespace(M_STATE *state)
 {
     size_t offset = state->offset;
@@ -104,7 +283,9 @@ static int M_SkipWhitespace(M_STATE *state)
         case ' ':
         case '\r':
         case '\t':
-            break;
+            /* skip indentation and other runs of blanks in bulk. */
+            offset = M_ScanBlanks(src, offset + 1, size);
+            continue;
         case '\n':
             state->line_no++;
             state->line_offset = offset;
@@ -264,6 +445,14 @@ static int M_GetStringSize(M_STATE *state, size_t is_key)
     offset++;
 
     while ((offset < size) && (quote_to_use != src[offset])) {
+        /* plain characters need no checks, so count them in bulk. */
+        const size_t run_end = M_ScanStringRun(src, offset, size, quote_to_use);
+        if (run_end != offset) {
+            data_size += run_end - offset;
+            offset = run_end;
+            continue;
+        }
+
         /* add space for the character. */
         data_size++;
 
@@ -804,8 +993,8 @@ static int M_GetNumberSize(M_STATE *state)
         }
 
         /* the main digits of our number next. */
-        while ((offset < size) && ('0' <= src[offset] && src[offset] <= '9')) {
-            offset++;
+        if ((offset < size) && ('0' <= src[offset] && src[offset] <= '9')) {
+            offset = M_ScanDigits(src, offset, size);
 
             /* we need to record whether we had any leading digits for checks
              * later.
@@ -829,10 +1018,7 @@ static int M_GetNumberSize(M_STATE *state)
             }
 
             /* a decimal point can be followed by more digits of course! */
-            while ((offset < size)
-                   && ('0' <= src[offset] && src[offset] <= '9')) {
-                offset++;
-            }
+            offset = M_ScanDigits(src, offset, size);
         }
 
         if ((offset < size) && ('e' == src[offset] || 'E' == src[offset])) {
@@ -853,10 +1039,7 @@ static int M_GetNumberSize(M_STATE *state)
             }
 
             /* consume exponent digits. */
-            do {
-                offset++;
-            } while ((offset < size)
-                     && ('0' <= src[offset] && src[offset] <= '9'));
+            offset = M_ScanDigits(src, offset + 1, size);
         }
     }
 
@@ -1127,8 +1310,15 @@ static void M_HandleString(M_STATE *state, JSON_STRING *string)
                 break;
             }
         } else {
-            /* copy the character. */
-            data[bytes_written++] = src[offset++];
+            /* copy plain characters in bulk. */
+            size_t run_end =
+                M_ScanStringRun(src, offset, state->size, quote_to_use);
+            if (run_end == offset) {
+                run_end++;
+            }
+            memcpy(&data[bytes_written], &src[offset], run_end - offset);
+            bytes_written += run_end - offset;
+            offset = run_end;
         }
     }
 
@@ -1325,6 +1515,12 @@ static void M_HandleObject(
 
     object->ref_count = 1;
     object->length = elements;
+    object->index = NULL;
+    object->arena = NULL;
+
+    if (JSON_PARSE_FLAGS_INDEX_OBJECTS & flags_bitset) {
+        JSON_ObjectBuildIndex(object);
+    }
 }
 
 static void M_HandleArray(M_STATE *state, JSON_ARRAY *array)
@@ -1415,6 +1611,9 @@ static void M_HandleArray(M_STATE *state, JSON_ARRAY *array)
 
     array->ref_count = 1;
     array->length = elements;
+    array->elements = NULL;
+    array->elements_capacity = 0;
+    array->arena = NULL;
 }
 
 static void M_HandleNumber(M_STATE *state, JSON_NUMBER *number)
@@ -1428,6 +1627,7 @@ static void M_HandleNumber(M_STATE *state, JSON_NUMBER *number)
 
     number->ref_count = 1;
     number->number = data;
+    number->type = JSON_NUMBER_TYPE_TEXT;
 
     if (JSON_PARSE_FLAGS_ALLOW_HEXADECIMAL_NUMBERS & flags_bitset) {
         if (('0' == src[offset])
@@ -1446,6 +1646,15 @@ static void M_HandleNumber(M_STATE *state, JSON_NUMBER *number)
     while (offset < size) {
         int end = 0;
 
+        /* copy digit runs in bulk. */
+        const size_t digits_end = M_ScanDigits(src, offset, size);
+        if (digits_end != offset) {
+            memcpy(&data[bytes_written], &src[offset], digits_end - offset);
+            bytes_written += digits_end - offset;
+            offset = digits_end;
+            continue;
+        }
+
         switch (src[offset]) {
         case '0':
         case '1':
@@ -1507,6 +1716,10 @@ static void M_HandleNumber(M_STATE *state, JSON_NUMBER *number)
     state->data += bytes_written;
     /* update offset. */
     state->offset = offset;
+
+    if (JSON_PARSE_FLAGS_CONVERT_NUMBERS & flags_bitset) {
+        JSON_NumberCacheValue(number);
+    }
 }
 
 static void M_HandleValue(
@@ -1781,3 +1994,330 @@ const char *JSON_GetErrorDescription(JSON_PARSE_ERROR error)
         return "unknown";
     }
 }
+
+static JSON_TOKEN M_ReadValue(JSON_READER *reader, M_STATE *state)
+{
+    /* the same dispatch as M_GetValueSize. */
+    const size_t flags_bitset = state->flags_bitset;
+    const char *const src = state->src;
+    const size_t size = state->size;
+
+    if (M_SkipAllSkippables(state)) {
+        state->error = JSON_PARSE_ERROR_PREMATURE_END_OF_BUFFER;
+        return JSON_TOKEN_ERROR;
+    }
+
+    const size_t offset = state->offset;
+    switch (src[offset]) {
+    case '"':
+        return M_ReadString(reader, state, 0);
+    case '\'':
+        if (JSON_PARSE_FLAGS_ALLOW_SINGLE_QUOTED_STRINGS & flags_bitset) {
+            return M_ReadString(reader, state, 0);
+        }
+        state->error = JSON_PARSE_ERROR_INVALID_VALUE;
+        return JSON_TOKEN_ERROR;
+    case '{':
+        return M_ReadContainer(reader, state, 0);
+    case '[':
+        return M_ReadContainer(reader, state, 1);
+    case '-':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+        return M_ReadNumber(reader, state);
+    case '+':
+        if (JSON_PARSE_FLAGS_ALLOW_LEADING_PLUS_SIGN & flags_bitset) {
+            return M_ReadNumber(reader, state);
+        }
+        state->error = JSON_PARSE_ERROR_INVALID_NUMBER_FORMAT;
+        return JSON_TOKEN_ERROR;
+    case '.':
+        if (JSON_PARSE_FLAGS_ALLOW_LEADING_OR_TRAILING_DECIMAL_POINT
+            & flags_bitset) {
+            return M_ReadNumber(reader, state);
+        }
+        state->error = JSON_PARSE_ERROR_INVALID_NUMBER_FORMAT;
+        return JSON_TOKEN_ERROR;
+    default:
+        if (offset + 4 <= size && !strncmp(&src[offset], "true", 4)) {
+            state->offset += 4;
+            return JSON_TOKEN_TRUE;
+        } else if (offset + 5 <= size && !strncmp(&src[offset], "false", 5)) {
+            state->offset += 5;
+            return JSON_TOKEN_FALSE;
+        } else if (offset + 4 <= size && !strncmp(&src[offset], "null", 4)) {
+            state->offset += 4;
+            return JSON_TOKEN_NULL;
+        } else if (
+            (JSON_PARSE_FLAGS_ALLOW_INF_AND_NAN & flags_bitset)
+            && ((offset + 3 <= size && !strncmp(&src[offset], "NaN", 3))
+                || (offset + 8 <= size
+                    && !strncmp(&src[offset], "Infinity", 8)))) {
+            return M_ReadNumber(reader, state);
+        }
+        state->error = JSON_PARSE_ERROR_INVALID_VALUE;
+        return JSON_TOKEN_ERROR;
+    }
+}
+
+static JSON_TOKEN M_ReadString(
+    JSON_READER *reader, M_STATE *state, int is_key)
+{
+    /* validate and measure first, then decode into the scratch buffer. */
+    const size_t offset = state->offset;
+    state->data_size = 0;
+    if (is_key ? M_GetKeySize(state) : M_GetStringSize(state, 0)) {
+        if (is_key) {
+            state->error = JSON_PARSE_ERROR_INVALID_STRING;
+        }
+        return JSON_TOKEN_ERROR;
+    }
+
+    if (is_key && state->offset == offset) {
+        /* an empty unquoted key, which M_HandleKey would take for a quoted
+         * one if it starts at a stray quote. */
+        reader->string.string = JSON_ReaderReserve(reader, 1);
+        reader->string.string[0] = '\0';
+        reader->string.string_size = 0;
+        return JSON_TOKEN_KEY;
+    }
+
+    state->offset = offset;
+    state->data = JSON_ReaderReserve(reader, state->data_size);
+    if (is_key) {
+        M_HandleKey(state, &reader->string);
+        return JSON_TOKEN_KEY;
+    }
+    M_HandleString(state, &reader->string);
+    return JSON_TOKEN_STRING;
+}
+
+static JSON_TOKEN M_ReadNumber(JSON_READER *reader, M_STATE *state)
+{
+    const size_t offset = state->offset;
+    state->data_size = 0;
+    if (M_GetNumberSize(state)) {
+        return JSON_TOKEN_ERROR;
+    }
+
+    state->offset = offset;
+    state->data = JSON_ReaderReserve(reader, state->data_size);
+    M_HandleNumber(state, &reader->number);
+    return JSON_TOKEN_NUMBER;
+}
+
+static JSON_TOKEN M_ReadContainer(
+    JSON_READER *reader, M_STATE *state, int is_array)
+{
+    /* skip leading '{' or '['. */
+    state->offset++;
+
+    if (state->offset == state->size) {
+        state->error = JSON_PARSE_ERROR_PREMATURE_END_OF_BUFFER;
+        return JSON_TOKEN_ERROR;
+    }
+
+    JSON_ReaderPushScope(reader, is_array);
+    return is_array ? JSON_TOKEN_BEGIN_ARRAY : JSON_TOKEN_BEGIN_OBJECT;
+}
+
+static JSON_TOKEN M_ReadObjectNext(JSON_READER *reader, M_STATE *state)
+{
+    /* one step of the M_GetObjectSize loop. */
+    const size_t flags_bitset = state->flags_bitset;
+    const char *const src = state->src;
+    JSON_READER_SCOPE *const scope = &reader->scopes[reader->depth - 1];
+
+    while (1) {
+        if (scope->is_global) {
+            /* the object ends when the input stream ends. */
+            if (M_SkipAllSkippables(state)) {
+                state->error = JSON_PARSE_ERROR_NONE;
+                reader->depth--;
+                return JSON_TOKEN_END_OBJECT;
+            }
+        } else {
+            if (M_SkipAllSkippables(state)) {
+                state->error = JSON_PARSE_ERROR_PREMATURE_END_OF_BUFFER;
+                return JSON_TOKEN_ERROR;
+            }
+
+            if ('}' == src[state->offset]) {
+                /* skip trailing '}'. */
+                state->offset++;
+                reader->depth--;
+                return JSON_TOKEN_END_OBJECT;
+            }
+        }
+
+        if (!scope->allow_comma) {
+            break;
+        }
+
+        if (',' == src[state->offset]) {
+            /* skip comma. */
+            state->offset++;
+            scope->allow_comma = false;
+        } else if (JSON_PARSE_FLAGS_ALLOW_NO_COMMAS & flags_bitset) {
+            scope->allow_comma = false;
+        } else {
+            state->error = JSON_PARSE_ERROR_EXPECTED_COMMA_OR_CLOSING_BRACKET;
+            return JSON_TOKEN_ERROR;
+        }
+
+        if (!(JSON_PARSE_FLAGS_ALLOW_TRAILING_COMMA & flags_bitset)) {
+            if (M_SkipAllSkippables(state)) {
+                state->error = JSON_PARSE_ERROR_PREMATURE_END_OF_BUFFER;
+                return JSON_TOKEN_ERROR;
+            }
+            break;
+        }
+    }
+
+    if (M_ReadString(reader, state, 1) == JSON_TOKEN_ERROR) {
+        return JSON_TOKEN_ERROR;
+    }
+
+    if (M_SkipAllSkippables(state)) {
+        state->error = JSON_PARSE_ERROR_PREMATURE_END_OF_BUFFER;
+        return JSON_TOKEN_ERROR;
+    }
+
+    if (':' != src[state->offset]
+        && !((JSON_PARSE_FLAGS_ALLOW_EQUALS_IN_OBJECT & flags_bitset)
+             && '=' == src[state->offset])) {
+        state->error = JSON_PARSE_ERROR_EXPECTED_COLON;
+        return JSON_TOKEN_ERROR;
+    }
+
+    /* skip colon. */
+    state->offset++;
+
+    if (M_SkipAllSkippables(state)) {
+        state->error = JSON_PARSE_ERROR_PREMATURE_END_OF_BUFFER;
+        return JSON_TOKEN_ERROR;
+    }
+
+    scope->allow_comma = true;
+    reader->expect_value = true;
+    return JSON_TOKEN_KEY;
+}
+
+static JSON_TOKEN M_ReadArrayNext(JSON_READER *reader, M_STATE *state)
+{
+    /* one step of the M_GetArraySize loop. */
+    const size_t flags_bitset = state->flags_bitset;
+    const char *const src = state->src;
+    JSON_READER_SCOPE *const scope = &reader->scopes[reader->depth - 1];
+
+    while (1) {
+        if (M_SkipAllSkippables(state)) {
+            state->error = JSON_PARSE_ERROR_PREMATURE_END_OF_BUFFER;
+            return JSON_TOKEN_ERROR;
+        }
+
+        if (']' == src[state->offset]) {
+            /* skip trailing ']'. */
+            state->offset++;
+            reader->depth--;
+            return JSON_TOKEN_END_ARRAY;
+        }
+
+        if (!scope->allow_comma) {
+            break;
+        }
+
+        if (',' == src[state->offset]) {
+            /* skip comma. */
+            state->offset++;
+            scope->allow_comma = false;
+        } else if (!(JSON_PARSE_FLAGS_ALLOW_NO_COMMAS & flags_bitset)) {
+            state->error = JSON_PARSE_ERROR_EXPECTED_COMMA_OR_CLOSING_BRACKET;
+            return JSON_TOKEN_ERROR;
+        }
+
+        if (JSON_PARSE_FLAGS_ALLOW_TRAILING_COMMA & flags_bitset) {
+            scope->allow_comma = false;
+            continue;
+        }
+
+        if (M_SkipAllSkippables(state)) {
+            state->error = JSON_PARSE_ERROR_PREMATURE_END_OF_BUFFER;
+            return JSON_TOKEN_ERROR;
+        }
+        break;
+    }
+
+    /* the value may push a scope and move the scope array. */
+    scope->allow_comma = true;
+    return M_ReadValue(reader, state);
+}
+
+static JSON_TOKEN M_ReadNext(JSON_READER *reader, M_STATE *state)
+{
+    if (reader->expect_value) {
+        reader->expect_value = false;
+        return M_ReadValue(reader, state);
+    }
+
+    if (reader->depth > 0) {
+        if (reader->scopes[reader->depth - 1].is_array) {
+            return M_ReadArrayNext(reader, state);
+        }
+        return M_ReadObjectNext(reader, state);
+    }
+
+    if (!reader->is_started) {
+        reader->is_started = true;
+        if ((JSON_PARSE_FLAGS_ALLOW_GLOBAL_OBJECT & state->flags_bitset)
+            && (M_SkipAllSkippables(state)
+                || '{' != state->src[state->offset])) {
+            state->error = JSON_PARSE_ERROR_NONE;
+            JSON_ReaderPushScope(reader, false)->is_global = true;
+            return JSON_TOKEN_BEGIN_OBJECT;
+        }
+        return M_ReadValue(reader, state);
+    }
+
+    /* the root value is complete, only skippables may follow. */
+    M_SkipAllSkippables(state);
+    if (state->offset != state->size) {
+        state->error = JSON_PARSE_ERROR_UNEXPECTED_TRAILING_CHARACTERS;
+        return JSON_TOKEN_ERROR;
+    }
+    state->error = JSON_PARSE_ERROR_NONE;
+    reader->is_done = true;
+    return JSON_TOKEN_NONE;
+}
+
+JSON_TOKEN JSON_ParseNextToken(JSON_READER *reader)
+{
+    M_STATE state;
+    state.src = reader->src;
+    state.size = reader->size;
+    state.offset = reader->offset;
+    state.flags_bitset = reader->flags_bitset;
+    state.line_no = reader->line_no;
+    state.line_offset = reader->line_offset;
+    state.error = JSON_PARSE_ERROR_NONE;
+    state.dom = NULL;
+    state.dom_size = 0;
+    state.data = NULL;
+    state.data_size = 0;
+
+    const JSON_TOKEN token = M_ReadNext(reader, &state);
+
+    reader->offset = state.offset;
+    reader->line_no = state.line_no;
+    reader->line_offset = state.line_offset;
+    reader->error = state.error;
+    return token;
+}
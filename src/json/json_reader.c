@@ -0,0 +1,197 @@
+#include "reader.h"
+
+#include "memory.h"
+
+#include <assert.h>
+
+#define M_MIN_SCOPES 16
+#define M_MIN_BUFFER_SIZE 256
+
+static JSON_READER *M_Create(const void *src, size_t src_size, bool is_bson);
+static void M_CacheNumber(JSON_READER *reader);
+
+static JSON_READER *M_Create(
+    const void *const src, const size_t src_size, const bool is_bson)
+{
+    JSON_READER *const reader = Memory_Alloc(sizeof(JSON_READER));
+    reader->is_bson = is_bson;
+    reader->src = src;
+    reader->size = src_size;
+    reader->line_no = 1;
+    return reader;
+}
+
+static void M_CacheNumber(JSON_READER *const reader)
+{
+    // BSON numbers are binary to begin with
+    if (reader->number.type == JSON_NUMBER_TYPE_TEXT) {
+        JSON_NumberCacheValue(&reader->number);
+    }
+}
+
+JSON_READER_SCOPE *JSON_ReaderPushScope(
+    JSON_READER *const reader, const bool is_array)
+{
+    if (reader->depth == reader->scopes_capacity) {
+        reader->scopes_capacity = reader->scopes_capacity
+            ? reader->scopes_capacity * 2
+            : M_MIN_SCOPES;
+        reader->scopes = Memory_Realloc(
+            reader->scopes,
+            sizeof(JSON_READER_SCOPE) * reader->scopes_capacity);
+    }
+    JSON_READER_SCOPE *const scope = &reader->scopes[reader->depth++];
+    scope->is_array = is_array;
+    scope->is_global = false;
+    scope->allow_comma = false;
+    scope->end = 0;
+    return scope;
+}
+
+char *JSON_ReaderReserve(JSON_READER *const reader, const size_t size)
+{
+    if (size > reader->buffer_capacity) {
+        size_t capacity = reader->buffer_capacity
+            ? reader->buffer_capacity
+            : M_MIN_BUFFER_SIZE;
+        while (capacity < size) {
+            capacity *= 2;
+        }
+        // the contents are always rewritten, so there is nothing to keep
+        Memory_FreePointer(&reader->buffer);
+        reader->buffer = Memory_Alloc(capacity);
+        reader->buffer_capacity = capacity;
+    }
+    return reader->buffer;
+}
+
+JSON_READER *JSON_ReaderNew(
+    const void *const src, const size_t src_size, const size_t flags_bitset)
+{
+    assert(src != NULL);
+    JSON_READER *const reader = M_Create(src, src_size, false);
+    reader->flags_bitset = flags_bitset;
+    return reader;
+}
+
+JSON_READER *BSON_ReaderNew(const void *const src, const size_t src_size)
+{
+    assert(src != NULL);
+    return M_Create(src, src_size, true);
+}
+
+void JSON_ReaderFree(JSON_READER *reader)
+{
+    if (reader == NULL) {
+        return;
+    }
+    Memory_FreePointer(&reader->scopes);
+    Memory_FreePointer(&reader->buffer);
+    Memory_FreePointer(&reader);
+}
+
+JSON_TOKEN JSON_ReaderNext(JSON_READER *const reader)
+{
+    if (reader->token == JSON_TOKEN_ERROR) {
+        return JSON_TOKEN_ERROR;
+    } else if (reader->is_done) {
+        reader->token = JSON_TOKEN_NONE;
+        return JSON_TOKEN_NONE;
+    }
+
+    reader->token = reader->is_bson ? BSON_ParseNextToken(reader)
+                                    : JSON_ParseNextToken(reader);
+    return reader->token;
+}
+
+JSON_TOKEN JSON_ReaderGetToken(const JSON_READER *const reader)
+{
+    return reader->token;
+}
+
+bool JSON_ReaderSkip(JSON_READER *const reader)
+{
+    if (reader->token == JSON_TOKEN_KEY) {
+        JSON_ReaderNext(reader);
+    }
+    if (reader->token != JSON_TOKEN_BEGIN_OBJECT
+        && reader->token != JSON_TOKEN_BEGIN_ARRAY) {
+        return reader->token != JSON_TOKEN_ERROR;
+    }
+
+    const size_t depth = reader->depth;
+    while (reader->depth >= depth) {
+        if (JSON_ReaderNext(reader) == JSON_TOKEN_ERROR) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const char *JSON_ReaderGetString(
+    const JSON_READER *const reader, const char *const d,
+    size_t *const out_size)
+{
+    if (reader->token != JSON_TOKEN_KEY && reader->token != JSON_TOKEN_STRING) {
+        return d;
+    }
+    if (out_size != NULL) {
+        *out_size = reader->string.string_size;
+    }
+    return reader->string.string;
+}
+
+int JSON_ReaderGetBool(const JSON_READER *const reader, const int d)
+{
+    if (reader->token == JSON_TOKEN_TRUE) {
+        return 1;
+    } else if (reader->token == JSON_TOKEN_FALSE) {
+        return 0;
+    }
+    return d;
+}
+
+int JSON_ReaderGetInt(JSON_READER *const reader, const int d)
+{
+    if (reader->token != JSON_TOKEN_NUMBER) {
+        return d;
+    }
+    M_CacheNumber(reader);
+    return JSON_NumberGetInt(&reader->number);
+}
+
+int64_t JSON_ReaderGetInt64(JSON_READER *const reader, const int64_t d)
+{
+    if (reader->token != JSON_TOKEN_NUMBER) {
+        return d;
+    }
+    M_CacheNumber(reader);
+    return JSON_NumberGetInt64(&reader->number);
+}
+
+double JSON_ReaderGetDouble(JSON_READER *const reader, const double d)
+{
+    if (reader->token != JSON_TOKEN_NUMBER) {
+        return d;
+    }
+    M_CacheNumber(reader);
+    return JSON_NumberGetDouble(&reader->number);
+}
+
+void JSON_ReaderGetResult(
+    const JSON_READER *const reader, JSON_PARSE_RESULT *const result)
+{
+    assert(!reader->is_bson);
+    result->error = reader->error;
+    result->error_offset = reader->offset;
+    result->error_line_no = reader->line_no;
+    result->error_row_no = reader->offset - reader->line_offset;
+}
+
+void BSON_ReaderGetResult(
+    const JSON_READER *const reader, BSON_PARSE_RESULT *const result)
+{
+    assert(reader->is_bson);
+    result->error = reader->error;
+    result->error_offset = reader->offset;
+}
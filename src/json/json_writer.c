@@ -0,0 +1,437 @@
+#include "json_writer.h"
+
+#include "memory.h"
+
+#include <assert.h>
+#include <float.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define M_MAX_DEPTH 64
+#define M_MIN_CAPACITY 4096
+// file writers hand the buffer over once it grows past this size
+#define M_FLUSH_SIZE (64 * 1024)
+
+#define M_BSON_DOUBLE 0x01
+#define M_BSON_STRING 0x02
+#define M_BSON_OBJECT 0x03
+#define M_BSON_ARRAY 0x04
+#define M_BSON_BOOL 0x08
+#define M_BSON_NULL 0x0A
+#define M_BSON_INT32 0x10
+
+typedef struct {
+    bool is_array;
+    int32_t count;
+    // position of the BSON length field, counted from the start of output
+    size_t start;
+} M_SCOPE;
+
+struct JSON_WRITER {
+    JSON_WRITER_FORMAT format;
+    MYFILE *file;
+    size_t file_base;
+
+    char *data;
+    size_t size;
+    size_t capacity;
+    size_t flushed;
+
+    M_SCOPE scopes[M_MAX_DEPTH];
+    int32_t depth;
+    bool has_key;
+    // offset of the BSON type byte written ahead of the pending key
+    size_t marker_offset;
+    bool is_done;
+};
+
+static JSON_WRITER *M_Create(JSON_WRITER_FORMAT format, MYFILE *file);
+static size_t M_GetPosition(const JSON_WRITER *writer);
+static char *M_Reserve(JSON_WRITER *writer, size_t size);
+static void M_Write(JSON_WRITER *writer, const void *data, size_t size);
+static void M_WriteChar(JSON_WRITER *writer, char c);
+static void M_WriteNewline(JSON_WRITER *writer, int32_t indent);
+static void M_WriteJSONString(JSON_WRITER *writer, const char *str);
+static void M_WriteBSONKey(
+    JSON_WRITER *writer, uint8_t marker, const char *key);
+static void M_PatchInt32(JSON_WRITER *writer, size_t position, int32_t value);
+static void M_Flush(JSON_WRITER *writer);
+static void M_BeginValue(JSON_WRITER *writer, uint8_t marker);
+static void M_EndValue(JSON_WRITER *writer);
+static void M_BeginContainer(JSON_WRITER *writer, bool is_array);
+static void M_EndContainer(JSON_WRITER *writer, bool is_array);
+
+static JSON_WRITER *M_Create(
+    const JSON_WRITER_FORMAT format, MYFILE *const file)
+{
+    JSON_WRITER *const writer = Memory_Alloc(sizeof(JSON_WRITER));
+    writer->format = format;
+    writer->file = file;
+    writer->file_base = file ? File_Pos(file) : 0;
+    writer->capacity = M_MIN_CAPACITY;
+    writer->data = Memory_Alloc(writer->capacity);
+    return writer;
+}
+
+static size_t M_GetPosition(const JSON_WRITER *const writer)
+{
+    return writer->flushed + writer->size;
+}
+
+static char *M_Reserve(JSON_WRITER *const writer, const size_t size)
+{
+    if (writer->size + size > writer->capacity) {
+        while (writer->size + size > writer->capacity) {
+            writer->capacity *= 2;
+        }
+        writer->data = Memory_Realloc(writer->data, writer->capacity);
+    }
+    return &writer->data[writer->size];
+}
+
+static void M_Write(
+    JSON_WRITER *const writer, const void *const data, const size_t size)
+{
+    memcpy(M_Reserve(writer, size), data, size);
+    writer->size += size;
+}
+
+static void M_WriteChar(JSON_WRITER *const writer, const char c)
+{
+    *M_Reserve(writer, 1) = c;
+    writer->size++;
+}
+
+static void M_WriteNewline(JSON_WRITER *const writer, const int32_t indent)
+{
+    if (writer->format != JSON_WRITER_FORMAT_JSON_PRETTY) {
+        return;
+    }
+    char *data = M_Reserve(writer, 1 + indent * 2);
+    *data++ = '\n';
+    memset(data, ' ', indent * 2);
+    writer->size += 1 + indent * 2;
+}
+
+static void M_WriteJSONString(JSON_WRITER *const writer, const char *str)
+{
+    // every character takes at most two bytes once escaped
+    char *const start = M_Reserve(writer, strlen(str) * 2 + 2);
+    char *data = start;
+    *data++ = '"';
+    for (; *str; str++) {
+        switch (*str) {
+        case '"':
+            *data++ = '\\';
+            *data++ = '"';
+            break;
+        case '\\':
+            *data++ = '\\';
+            *data++ = '\\';
+            break;
+        case '\b':
+            *data++ = '\\';
+            *data++ = 'b';
+            break;
+        case '\f':
+            *data++ = '\\';
+            *data++ = 'f';
+            break;
+        case '\n':
+            *data++ = '\\';
+            *data++ = 'n';
+            break;
+        case '\r':
+            *data++ = '\\';
+            *data++ = 'r';
+            break;
+        case '\t':
+            *data++ = '\\';
+            *data++ = 't';
+            break;
+        default:
+            *data++ = *str;
+            break;
+        }
+    }
+    *data++ = '"';
+    writer->size += data - start;
+}
+
+static void M_WriteBSONKey(
+    JSON_WRITER *const writer, const uint8_t marker, const char *const key)
+{
+    writer->marker_offset = writer->size;
+    M_WriteChar(writer, marker);
+    M_Write(writer, key, strlen(key) + 1);
+}
+
+static void M_PatchInt32(
+    JSON_WRITER *const writer, const size_t position, const int32_t value)
+{
+    if (position >= writer->flushed) {
+        char *const data = &writer->data[position - writer->flushed];
+        memcpy(data, &value, sizeof(value));
+        return;
+    }
+
+    // already flushed; lengths are never split across a flush
+    assert(writer->file != NULL);
+    File_Seek(writer->file, writer->file_base + position, FILE_SEEK_SET);
+    File_WriteS32(writer->file, value);
+    File_Seek(writer->file, 0, FILE_SEEK_END);
+}
+
+static void M_Flush(JSON_WRITER *const writer)
+{
+    if (writer->size == 0) {
+        return;
+    }
+    File_WriteData(writer->file, writer->data, writer->size);
+    writer->flushed += writer->size;
+    writer->size = 0;
+}
+
+static void M_BeginValue(JSON_WRITER *const writer, const uint8_t marker)
+{
+    assert(!writer->is_done);
+    if (writer->depth == 0) {
+        assert(
+            writer->format != JSON_WRITER_FORMAT_BSON
+            || marker == M_BSON_OBJECT || marker == M_BSON_ARRAY);
+        return;
+    }
+
+    M_SCOPE *const scope = &writer->scopes[writer->depth - 1];
+    if (!scope->is_array) {
+        assert(writer->has_key);
+        writer->has_key = false;
+        if (writer->format == JSON_WRITER_FORMAT_BSON) {
+            writer->data[writer->marker_offset] = marker;
+        }
+        return;
+    }
+
+    if (writer->format == JSON_WRITER_FORMAT_BSON) {
+        char key[12];
+        sprintf(key, "%d", scope->count);
+        M_WriteBSONKey(writer, marker, key);
+    } else {
+        if (scope->count > 0) {
+            M_WriteChar(writer, ',');
+        }
+        M_WriteNewline(writer, writer->depth);
+    }
+    scope->count++;
+}
+
+static void M_EndValue(JSON_WRITER *const writer)
+{
+    if (writer->depth == 0) {
+        writer->is_done = true;
+    }
+    if (writer->file != NULL && writer->size >= M_FLUSH_SIZE) {
+        M_Flush(writer);
+    }
+}
+
+static void M_BeginContainer(JSON_WRITER *const writer, const bool is_array)
+{
+    M_BeginValue(writer, is_array ? M_BSON_ARRAY : M_BSON_OBJECT);
+    assert(writer->depth < M_MAX_DEPTH);
+
+    M_SCOPE *const scope = &writer->scopes[writer->depth++];
+    scope->is_array = is_array;
+    scope->count = 0;
+    scope->start = M_GetPosition(writer);
+    if (writer->format == JSON_WRITER_FORMAT_BSON) {
+        const int32_t length = 0;
+        M_Write(writer, &length, sizeof(length));
+    } else {
+        M_WriteChar(writer, is_array ? '[' : '{');
+    }
+}
+
+static void M_EndContainer(JSON_WRITER *const writer, const bool is_array)
+{
+    assert(writer->depth > 0);
+    assert(!writer->has_key);
+    const M_SCOPE *const scope = &writer->scopes[--writer->depth];
+    assert(scope->is_array == is_array);
+
+    if (writer->format == JSON_WRITER_FORMAT_BSON) {
+        M_WriteChar(writer, '\0');
+        M_PatchInt32(
+            writer, scope->start, M_GetPosition(writer) - scope->start);
+    } else {
+        if (scope->count > 0) {
+            M_WriteNewline(writer, writer->depth);
+        }
+        M_WriteChar(writer, is_array ? ']' : '}');
+    }
+    M_EndValue(writer);
+}
+
+JSON_WRITER *JSON_WriterNew(const JSON_WRITER_FORMAT format)
+{
+    return M_Create(format, NULL);
+}
+
+JSON_WRITER *JSON_WriterNewFile(
+    const JSON_WRITER_FORMAT format, MYFILE *const file)
+{
+    assert(file != NULL);
+    return M_Create(format, file);
+}
+
+void JSON_WriterBeginObject(JSON_WRITER *const writer)
+{
+    M_BeginContainer(writer, false);
+}
+
+void JSON_WriterEndObject(JSON_WRITER *const writer)
+{
+    M_EndContainer(writer, false);
+}
+
+void JSON_WriterBeginArray(JSON_WRITER *const writer)
+{
+    M_BeginContainer(writer, true);
+}
+
+void JSON_WriterEndArray(JSON_WRITER *const writer)
+{
+    M_EndContainer(writer, true);
+}
+
+void JSON_WriterKey(JSON_WRITER *const writer, const char *const key)
+{
+    assert(writer->depth > 0);
+    assert(!writer->has_key);
+    M_SCOPE *const scope = &writer->scopes[writer->depth - 1];
+    assert(!scope->is_array);
+
+    if (writer->format == JSON_WRITER_FORMAT_BSON) {
+        // the type byte is filled in once the value is known
+        M_WriteBSONKey(writer, M_BSON_NULL, key);
+    } else {
+        if (scope->count > 0) {
+            M_WriteChar(writer, ',');
+        }
+        M_WriteNewline(writer, writer->depth);
+        M_WriteJSONString(writer, key);
+        if (writer->format == JSON_WRITER_FORMAT_JSON_PRETTY) {
+            M_Write(writer, " : ", 3);
+        } else {
+            M_WriteChar(writer, ':');
+        }
+    }
+    scope->count++;
+    writer->has_key = true;
+}
+
+void JSON_WriterNull(JSON_WRITER *const writer)
+{
+    M_BeginValue(writer, M_BSON_NULL);
+    if (writer->format != JSON_WRITER_FORMAT_BSON) {
+        M_Write(writer, "null", 4);
+    }
+    M_EndValue(writer);
+}
+
+void JSON_WriterBool(JSON_WRITER *const writer, const bool value)
+{
+    M_BeginValue(writer, M_BSON_BOOL);
+    if (writer->format == JSON_WRITER_FORMAT_BSON) {
+        M_WriteChar(writer, value ? 1 : 0);
+    } else if (value) {
+        M_Write(writer, "true", 4);
+    } else {
+        M_Write(writer, "false", 5);
+    }
+    M_EndValue(writer);
+}
+
+void JSON_WriterInt(JSON_WRITER *const writer, const int32_t value)
+{
+    JSON_WriterInt64(writer, value);
+}
+
+void JSON_WriterInt64(JSON_WRITER *const writer, const int64_t value)
+{
+    M_BeginValue(writer, M_BSON_INT32);
+    if (writer->format == JSON_WRITER_FORMAT_BSON) {
+        const int32_t value32 = (int32_t)value;
+        M_Write(writer, &value32, sizeof(value32));
+    } else {
+        char buf[24];
+        M_Write(writer, buf, sprintf(buf, "%" PRId64, value));
+    }
+    M_EndValue(writer);
+}
+
+void JSON_WriterDouble(JSON_WRITER *const writer, double value)
+{
+    if (writer->format != JSON_WRITER_FORMAT_BSON) {
+        // same text as JSON_NumberNewDouble
+        M_BeginValue(writer, M_BSON_DOUBLE);
+        const int size = snprintf(NULL, 0, "%f", value);
+        char *const data = M_Reserve(writer, size + 1);
+        sprintf(data, "%f", value);
+        writer->size += size;
+        M_EndValue(writer);
+        return;
+    }
+
+    // BSON does not support Infinity and NaN; written like BSON_Write does,
+    // which maps both infinities to DBL_MAX
+    if (isnan(value)) {
+        JSON_WriterInt(writer, 0);
+        return;
+    } else if (isinf(value)) {
+        value = DBL_MAX;
+    }
+    M_BeginValue(writer, M_BSON_DOUBLE);
+    M_Write(writer, &value, sizeof(value));
+    M_EndValue(writer);
+}
+
+void JSON_WriterString(JSON_WRITER *const writer, const char *const value)
+{
+    M_BeginValue(writer, M_BSON_STRING);
+    if (writer->format == JSON_WRITER_FORMAT_BSON) {
+        const int32_t size = strlen(value) + 1;
+        M_Write(writer, &size, sizeof(size));
+        M_Write(writer, value, size);
+    } else {
+        M_WriteJSONString(writer, value);
+    }
+    M_EndValue(writer);
+}
+
+void *JSON_WriterFinish(JSON_WRITER *writer, size_t *const out_size)
+{
+    assert(writer->depth == 0);
+
+    void *result = NULL;
+    if (writer->file != NULL) {
+        M_Flush(writer);
+        if (out_size != NULL) {
+            *out_size = writer->flushed;
+        }
+        Memory_FreePointer(&writer->data);
+    } else {
+        if (writer->format != JSON_WRITER_FORMAT_BSON) {
+            *M_Reserve(writer, 1) = '\0';
+        }
+        if (out_size != NULL) {
+            *out_size = writer->size;
+        }
+        result = writer->data;
+    }
+
+    Memory_FreePointer(&writer);
+    return result;
+}
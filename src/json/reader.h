@@ -0,0 +1,51 @@
+#pragma once
+
+#include "json_reader.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    bool is_array;
+    // an object without braces, see JSON_PARSE_FLAGS_ALLOW_GLOBAL_OBJECT
+    bool is_global;
+    bool allow_comma;
+    // BSON only: offset right past the document
+    size_t end;
+} JSON_READER_SCOPE;
+
+struct JSON_READER {
+    bool is_bson;
+    const char *src;
+    size_t size;
+    size_t offset;
+    size_t flags_bitset;
+    size_t line_no;
+    size_t line_offset;
+    size_t error;
+
+    bool is_started;
+    bool is_done;
+    // a key was read and its value comes next
+    bool expect_value;
+    // BSON only: type of the value that comes next
+    uint8_t marker;
+
+    JSON_READER_SCOPE *scopes;
+    size_t depth;
+    size_t scopes_capacity;
+
+    JSON_TOKEN token;
+    JSON_STRING string;
+    JSON_NUMBER number;
+    char *buffer;
+    size_t buffer_capacity;
+};
+
+JSON_READER_SCOPE *JSON_ReaderPushScope(JSON_READER *reader, bool is_array);
+char *JSON_ReaderReserve(JSON_READER *reader, size_t size);
+
+// Implemented by json_parse.c and bson_parse.c, which own the grammars.
+JSON_TOKEN JSON_ParseNextToken(JSON_READER *reader);
+JSON_TOKEN BSON_ParseNextToken(JSON_READER *reader);